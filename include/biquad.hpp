@@ -3,8 +3,18 @@
 #include <math.h>
 #include "utility.hpp"
 namespace giml {
+    /**
+     * @brief Biquad filter with coefficient sets for common use cases.
+     * `T` may be a SIMD vector such as `giml::simd::f32x4` to filter one channel per lane
+     * with shared coefficients, or a fixed-point `giml::q31` or `giml::q15` with `q3_28` coefficients
+     * (gains up to +18 dB), see `sample_traits`
+     */
     template <typename T>
     class Biquad : public Effect<T> {
+    private:
+        using Scalar = typename sample_traits<T>::scalar;
+        using Coeff = typename sample_traits<T>::coeff;
+
     public:
         enum class BiquadUseCase {
             PassThroughDefault, //Default type until parameters are set
@@ -100,6 +110,7 @@ namespace giml {
         ~Biquad() {}
 
         void setType(BiquadUseCase type) {
+            GIML_TRACE_SCOPE("Biquad::setType");
             this->useCase = type;
             this->setParams(this->cutoffFrequency, this->Q, this->gainDB); //Recalculate coefficients
         }
@@ -109,6 +120,7 @@ namespace giml {
         }
 
         void setParams(float cutoffFrequency, float Q = 0.707, float gainDB = 0.f) {
+            GIML_TRACE_SCOPE("Biquad::setParams");
             this->cutoffFrequency = cutoffFrequency;
             this->Q = Q;
             this->gainDB = gainDB;
@@ -165,7 +177,53 @@ namespace giml {
             }
         }
 
+        /**
+         * @brief two samples of input history plus the decay of the largest pole, 
+         * from a state that resonance can raise up to `1 / (1 - |pole|)^2` times the input
+         */
+        int getTailSamples() const override {
+            Scalar pole = 0, b1 = static_cast<Scalar>(this->b1), b2 = static_cast<Scalar>(this->b2);
+            switch (useCase) {
+            case BiquadUseCase::LPF_1st:
+            case BiquadUseCase::HPF_1st:
+            case BiquadUseCase::APF_1st:
+                pole = ::fabs(b1);
+                break;
+            case BiquadUseCase::LPF_2nd:
+            case BiquadUseCase::HPF_2nd:
+            case BiquadUseCase::LPF_Butterworth:
+            case BiquadUseCase::HPF_Butterworth:
+            case BiquadUseCase::APF_2nd:
+            case BiquadUseCase::LSF:
+            case BiquadUseCase::HSF:
+            case BiquadUseCase::PEQ_constQ: {
+                // roots of z^2 + b1 z + b2
+                Scalar discriminant = b1 * b1 - 4 * b2;
+                if (discriminant < 0) { pole = ::sqrt(::fabs(b2)); } // complex pair, |p|^2 = b2
+                else { pole = (::fabs(b1) + ::sqrt(discriminant)) / 2; }
+                break;
+            }
+            default: // pass-through or not implemented (outputs 0)
+                return 0;
+            }
+            int decay = (pole < 1) ? decaySamples(pole, Scalar(1) / ((1 - pole) * (1 - pole))) : -1;
+            return (decay < 0) ? -1 : decay + 2;
+        }
+
+        void reset() override {
+            this->prevX1 = this->prevX2 = this->prevY1 = this->prevY2 = 0;
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            if (this->useCase != BiquadUseCase::PassThroughDefault) { // no coefficients yet
+                this->setParams(this->cutoffFrequency, this->Q, this->gainDB);
+            }
+            this->reset();
+        }
+
         inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("Biquad::processSample");
             T returnVal = {0};
             switch (useCase) {
             case BiquadUseCase::PassThroughDefault:
@@ -175,7 +233,7 @@ namespace giml {
             case BiquadUseCase::LPF_1st:
             case BiquadUseCase::HPF_1st:
             case BiquadUseCase::APF_1st:
-                returnVal = a0 * in + a1 * prevX1 - b1 * prevY1;
+                returnVal = T(a0 * in + a1 * prevX1 - b1 * prevY1);
                 break;
             case BiquadUseCase::LPF_2nd:
             case BiquadUseCase::HPF_2nd:
@@ -185,7 +243,7 @@ namespace giml {
             case BiquadUseCase::LSF:
             case BiquadUseCase::HSF:
             case BiquadUseCase::PEQ_constQ:
-                returnVal = a0 * in + a1 * prevX1 + a2*prevX2 - b1 * prevY1 - b2*prevY2;
+                returnVal = T(a0 * in + a1 * prevX1 + a2*prevX2 - b1 * prevY1 - b2*prevY2); // sums with the coefficients' headroom
                 break;
             /*case BiquadUseCase::BPF:
             case BiquadUseCase::BPF_Butterworth:
@@ -227,8 +285,8 @@ namespace giml {
 
         int sampleRate;
 
-        T a0=1, a1=0, a2=0,   //Numeratror coefficients (set a0 to 1 for default passthrough)
-            b1=0, b2=0;     //Denominator coefficients
+        Coeff a0=1, a1=0, a2=0,   //Numeratror coefficients (set a0 to 1 for default passthrough)
+            b1=0, b2=0;     //Denominator coefficients, read back as `Scalar` before scaling by large factors
         //Past 2 x,y values
         T prevX1 = 0, prevX2 = 0,
             prevY1 = 0, prevY2 = 0;
@@ -346,8 +404,8 @@ namespace giml {
             this->a1 = 2 * this->a0;
             this->a2 = this->a0;
 
-            this->b1 = 2 * this->a0 * (1 - CSquared);
-            this->b2 = this->a0 * (1 - M_SQRT2 * C + CSquared);
+            this->b1 = 2 * Scalar(this->a0) * (1 - CSquared);
+            this->b2 = Scalar(this->a0) * (1 - M_SQRT2 * C + CSquared);
         }
 
         void setParams__HPF_Butterworth(float cutoffFrequency) {
@@ -363,8 +421,8 @@ namespace giml {
             this->a1 = -2 * this->a0;
             this->a2 = this->a0;
 
-            this->b1 = 2 * this->a0 * (CSquared - 1);
-            this->b2 = this->a0 * (1 - M_SQRT2 * C + CSquared);
+            this->b1 = 2 * Scalar(this->a0) * (CSquared - 1);
+            this->b2 = Scalar(this->a0) * (1 - M_SQRT2 * C + CSquared);
         }
 
         void setParams__BPF_Butterworth(float cutoffFrequency, float Q) {
@@ -380,8 +438,8 @@ namespace giml {
             this->a1 = 0;
             this->a2 = -this->a0;
 
-            this->b1 = -this->a0 * C * D;
-            this->b2 = this->a0 * (C - 1);
+            this->b1 = -Scalar(this->a0) * C * D;
+            this->b2 = Scalar(this->a0) * (C - 1);
         }
 
         void setParams__BSF_Butterworth(float cutoffFrequency, float Q) {
@@ -397,8 +455,8 @@ namespace giml {
             this->a1 = 0;
             this->a2 = -this->a0;
 
-            this->b1 = -this->a0 * C * D;
-            this->b2 = this->a0 * (C - 1);
+            this->b1 = -Scalar(this->a0) * C * D;
+            this->b2 = Scalar(this->a0) * (C - 1);
         }
 
         //void setParams__LPF_LR(float cutoffFrequency) {
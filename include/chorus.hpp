@@ -8,17 +8,28 @@ namespace giml {
      * @brief This class implements a basic chorus effect
      * 
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, see `sample_traits`
      * 
      * @todo multi-layer chorus
+     * @tparam MaxSamples if non-zero, the delay line is stored inline in the object (`MaxSamples` long) 
+     * instead of on the heap, and longer maximum delays are clamped to it
      */
-    template <typename T>
+    template <typename T, size_t MaxSamples = 0>
     class Chorus : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
         int sampleRate;
-        T rate = 0.20, depth = 0.0, offset = 0.0, blend = 0.5;
-        giml::CircularBuffer<T> buffer;
-        giml::TriOsc<T> osc;
+        Scalar rate = 0.20, depth = 0.0, offset = 0.0, blend = 0.5, depthMillis = 15.0, maxDepthMillis = 50.0;
+        giml::CircularBuffer<T, T, MaxSamples> buffer;
+        giml::TriOsc<Scalar> osc; // one LFO shared by all lanes
+
+        // Reads the delay line at the LFO sample `lfo` and blends it with `in`
+        inline T modulate(const T& in, Scalar lfo) {
+            // y_n = x_{n - (offset + lfo * depth)}
+            float readIndex = this->offset + lfo * this->depth;
+            return giml::powMix<T>(in, this->buffer.readSample(readIndex), this->blend); // return mix
+        }
 
     public:
         // Constructor
@@ -31,7 +42,7 @@ namespace giml {
          * 
          * See Microsound - Curtis Roads 2004 Figure 1.1
          */
-        Chorus (int samprate, float maxDepthMillis = 50.f) : sampleRate(samprate), osc(samprate) {
+        Chorus (int samprate, float maxDepthMillis = 50.f) : sampleRate(samprate), maxDepthMillis(maxDepthMillis), osc(samprate) {
             this->osc.setFrequency(this->rate);
             this->depth = giml::millisToSamples(15.0, samprate);
             this->offset = giml::millisToSamples(20.0, samprate); 
@@ -42,25 +53,29 @@ namespace giml {
         ~Chorus() {}
 
         // Copy constructor
-        Chorus(const Chorus<T>& c) {
+        Chorus(const Chorus<T, MaxSamples>& c) : osc(c.osc) {
             this->enabled = c.enabled;
             this->sampleRate = c.sampleRate;
             this->rate = c.rate;
             this->depth = c.depth;
             this->offset = c.offset;
             this->blend = c.blend;
+            this->depthMillis = c.depthMillis;
+            this->maxDepthMillis = c.maxDepthMillis;
             this->buffer = c.buffer;
             this->osc = c.osc;
         }
 
         // Copy assignment operator 
-        Chorus<T>& operator=(const Chorus<T>& c) {
+        Chorus<T, MaxSamples>& operator=(const Chorus<T, MaxSamples>& c) {
             this->enabled = c.enabled;
             this->sampleRate = c.sampleRate;
             this->rate = c.rate;
             this->depth = c.depth;
             this->offset = c.offset;
             this->blend = c.blend;
+            this->depthMillis = c.depthMillis;
+            this->maxDepthMillis = c.maxDepthMillis;
             this->buffer = c.buffer;
             this->osc = c.osc;
             return *this;
@@ -74,21 +89,65 @@ namespace giml {
          * from current sample create pitch-shifting via the doppler effect 
          */
         inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("Chorus::processSample");
             // bypass behavior
             this->buffer.writeSample(in);
             if (!this->enabled) { return in; }
+            return this->modulate(in, this->osc.processSample());
+        }
+
+        /**
+         * @brief Writes and returns sample from delay line, with the LFO supplied by the caller
+         * (e.g. one output of a `giml::OscillatorBank`) instead of `osc`
+         * @param in current sample
+         * @param lfo LFO sample, bipolar as `giml::TriOsc` outputs
+         * @return `in` blended with past input
+         */
+        inline T processSample(const T& in, Scalar lfo) {
+            GIML_TRACE_SAMPLE_SCOPE("Chorus::processSample");
+            this->buffer.writeSample(in);
+            if (!this->enabled) { return in; }
+            return this->modulate(in, lfo);
+        }
+
+        /**
+         * @brief Processes a block in place, generating the LFO a chunk at a time with `TriOsc::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples) override {
+            GIML_TRACE_SCOPE("Chorus::processBlock");
+            if (!this->enabled) {
+                for (size_t i = 0; i < numSamples; i++) { this->buffer.writeSample(buffer[i]); }
+                return;
+            }
+            Scalar lfo[detail::lfoBlockSize];
+            for (size_t offset = 0; offset < numSamples; offset += detail::lfoBlockSize) {
+                size_t n = std::min(detail::lfoBlockSize, numSamples - offset);
+                this->osc.processBlock(lfo, n);
+                this->processBlock(buffer + offset, n, lfo);
+            }
+        }
 
-            // y_n = x_{n - (offset + osc_n * depth)}
-            float readIndex = this->offset + this->osc.processSample() * this->depth;
-            T wet = this->buffer.readSample(readIndex);
-            return giml::powMix<float>(in, wet, this->blend); // return mix
+        /**
+         * @brief Processes a block in place, with the LFO supplied by the caller instead of `osc`
+         * @param lfo LFO samples, bipolar as `giml::TriOsc` outputs
+         * @param lfoStride distance between consecutive LFO samples, e.g. `N` to read one oscillator
+         * of `giml::OscillatorBank<Scalar, N>::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples, const Scalar* lfo, size_t lfoStride = 1) {
+            GIML_TRACE_SCOPE("Chorus::processBlock");
+            for (size_t i = 0; i < numSamples; i++) {
+                T in = buffer[i];
+                this->buffer.writeSample(in);
+                if (this->enabled) { buffer[i] = this->modulate(in, lfo[i * lfoStride]); }
+            }
         }
 
         /**
          * @brief sets params rate, depth and blend
          * @todo more params
          */
-        void setParams(T rate = 0.2, T depth = 6.0, T blend = 0.5) {
+        void setParams(Scalar rate = 0.2, Scalar depth = 6.0, Scalar blend = 0.5) {
+            GIML_TRACE_SCOPE("Chorus::setParams");
             this->setRate(rate);
             this->setDepth(depth);
             this->setBlend(blend);
@@ -98,7 +157,7 @@ namespace giml {
          * @brief Set modulation rate- the frequency of the LFO.  
          * @param freq frequency in Hz 
          */
-        void setRate(T freq) { this->osc.setFrequency(freq); }
+        void setRate(Scalar freq) { this->osc.setFrequency(freq); }
 
         /**
          * @brief Set modulation depth- the delay length of 
@@ -106,7 +165,8 @@ namespace giml {
          * @param d depth in milliseconds
          * @todo test for stability
          */
-        void setDepth(T d) {
+        void setDepth(Scalar d) {
+            this->depthMillis = d;
             d = giml::millisToSamples(d, this->sampleRate);
             this->offset = d + giml::millisToSamples(5.0, this->sampleRate);
             if (d + this->offset > this->buffer.size()) {
@@ -120,8 +180,20 @@ namespace giml {
          * @brief Set blend 
          * @param b ratio of wet to dry (clamped to [0,1])
          */
-        void setBlend(T b) { this->blend = giml::clip<T>(b, 0.f, 1.f); }
+        void setBlend(Scalar b) { this->blend = giml::clip<Scalar>(b, 0.f, 1.f); }
 
+        void reset() override {
+            this->buffer.clear();
+            this->osc.setPhase(0);
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->buffer.allocate(giml::millisToSamples(this->maxDepthMillis, sampleRate));
+            this->setDepth(this->depthMillis); // `depth` and `offset` are stored in samples
+            this->osc.setSampleRate(sampleRate);
+            this->reset();
+        }
     };
 }
 #endif
\ No newline at end of file
@@ -6,41 +6,46 @@ namespace giml {
     /**
      * @brief This class implements the ideal compressor described in Reiss et al. 2011
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, 
+     * and a fixed-point `giml::q31` or `giml::q15` without floating-point math per sample, see `sample_traits`
      */
     template <typename T>
     class Compressor : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
+        using Coeff = typename sample_traits<T>::coeff;
+        using Level = typename sample_traits<T>::level;
         int sampleRate;
-        T thresh_dB = 0.f, ratio = 2.f, knee_dB = 1.f, 
-        aRelease = 0.f, aAttack = 0.f, makeupGain_dB = 0.f;
-        dBDetector<T> detector; // dB detector
+        Level thresh_dB = 0.f, ratio = 2.f, knee_dB = 1.f, makeupGain_dB = 0.f;
+        Coeff aRelease = 0.f, aAttack = 0.f;
+        Scalar attackMillis = 0.f, releaseMillis = 0.f;
+        dBDetector<Level> detector; // dB detector
 
     protected: 
         /**
-         * @brief Applies gain reduction in the log domain
+         * @brief Applies gain reduction in the log domain. 
+         * Branchless: all three regions are computed and the right one is selected per lane.
+         * With fixed-point samples levels are `q8_23`, keep `knee` below 16 dB so `kneeOffset^2` fits
          * @param xG input gain
          * @param thresh compressor threshold
          * @param ratio compressor ratio
          * @param knee compressor knee width
          * @return `yG` 
          */
-        float computeGain(float xG, float thresh, float ratio, float knee) {
-            float yG = xG;
-            // calculate yG
-            if (2.f * (xG - thresh) < -knee) { // if input < thresh - knee
-                yG = xG;
-            } 
-            else if (2.f * abs(xG - thresh) <= knee) { // if input is inside knee
-                yG = xG + 
+        Level computeGain(Level xG, Level thresh, Level ratio, Level knee) {
+            using S = sample_traits<Level>;
+            Level overshoot = 2.f * (xG - thresh);
+            Level kneeOffset = (xG - thresh) + (knee / 2.f);
+            Level inKnee = xG + 
                 (1.f / (ratio - 1.f)) *
-                pow((xG - thresh) + (knee / 2.f), 2.f) /
+                (kneeOffset * kneeOffset) /
                 (2.f * knee); // knee needs to be non-zero
-            } 
-            else if (2.f * (xG - thresh) > knee) { // if input > thresh + knee
-                yG = thresh + ((xG - thresh) / ratio);
-            }
-          return yG; 
+            Level above = thresh + ((xG - thresh) / ratio);
+
+            Level yG = S::select(overshoot > knee, above, xG); // if input > thresh + knee
+            yG = S::select(S::abs(overshoot) <= knee, inKnee, yG); // if input is inside knee
+            return S::select(overshoot < -knee, xG, yG); // if input < thresh - knee
         }
 
     public:
@@ -61,6 +66,9 @@ namespace giml {
             this->aAttack = c.aAttack;
             this->aRelease = c.aRelease;
             this->makeupGain_dB = c.makeupGain_dB;
+            this->attackMillis = c.attackMillis;
+            this->releaseMillis = c.releaseMillis;
+            this->detector = c.detector;
         }
 
         // Copy assignment operator 
@@ -73,6 +81,9 @@ namespace giml {
             this->aAttack = c.aAttack;
             this->aRelease = c.aRelease;
             this->makeupGain_dB = c.makeupGain_dB;
+            this->attackMillis = c.attackMillis;
+            this->releaseMillis = c.releaseMillis;
+            this->detector = c.detector;
             return *this;
         }
 
@@ -82,24 +93,25 @@ namespace giml {
          * @return `in` with gain reduction and makeup gain applied
          */
         inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("Compressor::processSample");
             if (!this->enabled) { return in; }
             
-            T xG = giml::aTodB(in); // xG
-            T yG = computeGain(xG, this->thresh_dB, this->ratio, this->knee_dB); // yG
-            T xL = xG - yG; // xL
-            T yL = this->detector(xL, this->aAttack, this->aRelease); // yL
-            T cdB = this->makeupGain_dB - yL; // cdB = M - yL
-
-            T gain = giml::dBtoA(cdB); // lin()
-            return (in * gain); // apply gain
+            Level xG = giml::aTodB(in); // xG
+            Level yG = computeGain(xG, this->thresh_dB, this->ratio, this->knee_dB); // yG
+            Level xL = xG - yG; // xL
+            Level yL = this->detector(xL, this->aAttack, this->aRelease); // yL
+            Level cdB = this->makeupGain_dB - yL; // cdB = M - yL
+
+            return (in * giml::dBtoA(cdB)); // apply gain, lin()
         }
 
         /**
          * @brief sets params threshold, ratio, knee, 
          * attack, release, and makeup gain
          */
-        void setParams(T thresh = 0.0, T ratio = 2.0, T makeup = 0.0,
-                       T knee = 1.0, T attack = 3.5, T release = 100.0) {
+        void setParams(Scalar thresh = 0.0, Scalar ratio = 2.0, Scalar makeup = 0.0,
+                       Scalar knee = 1.0, Scalar attack = 3.5, Scalar release = 100.0) {
+            GIML_TRACE_SCOPE("Compressor::setParams");
             this->setThresh(thresh);
             this->setRatio(ratio);
             this->setMakeupGain(makeup);
@@ -112,7 +124,7 @@ namespace giml {
          * @brief set threshold to trigger compression
          * @param threshdB threshold in dB
          */
-        void setThresh(T threshdB) {
+        void setThresh(Scalar threshdB) {
             this->thresh_dB = threshdB;
         }
 
@@ -120,8 +132,8 @@ namespace giml {
          * @brief set compression ratio
          * @param r ratio
          */
-        void setRatio(T r) {
-            r = std::max(r, T(1.0 + 1e-6)); // avoid div by zero / negative values
+        void setRatio(Scalar r) {
+            r = std::max(r, Scalar(1.0 + 1e-6)); // avoid div by zero / negative values
             this->ratio = r;
         }
 
@@ -129,7 +141,7 @@ namespace giml {
          * @brief set makeup gain
          * @param mdB gain value in dB.
          */
-        void setMakeupGain(T mdB) {
+        void setMakeupGain(Scalar mdB) {
             this->makeupGain_dB = mdB;
         }
         
@@ -137,8 +149,8 @@ namespace giml {
          * @brief set knee width
          * @param widthdB width value in dB
          */
-        void setKnee(T widthdB) {
-            widthdB = std::max(widthdB, T(1e-6)); // avoid div by zero / negative values
+        void setKnee(Scalar widthdB) {
+            widthdB = std::max(widthdB, Scalar(1e-6)); // avoid div by zero / negative values
             this->knee_dB = widthdB;
         }
 
@@ -146,7 +158,8 @@ namespace giml {
          * @brief set attack time 
          * @param attackMillis attack time in milliseconds 
          */
-        void setAttack(T attackMillis) { // calculated from Reiss et al. 2011 (Eq. 7)
+        void setAttack(Scalar attackMillis) { // calculated from Reiss et al. 2011 (Eq. 7)
+            this->attackMillis = attackMillis;
             this->aAttack = timeConstant(attackMillis, sampleRate);
         }
 
@@ -154,9 +167,28 @@ namespace giml {
          * @brief set release time 
          * @param releaseMillis release time in milliseconds 
          */
-        void setRelease(T releaseMillis) {
+        void setRelease(Scalar releaseMillis) {
+            this->releaseMillis = releaseMillis;
             this->aRelease = timeConstant(releaseMillis, sampleRate);
         }
+
+        /**
+         * @brief the detector's release and attack stages in series
+         */
+        int getTailSamples() const override {
+            int release = decaySamples(static_cast<Scalar>(this->aRelease));
+            int attack = decaySamples(static_cast<Scalar>(this->aAttack));
+            return (release < 0 || attack < 0) ? -1 : release + attack;
+        }
+
+        void reset() override { this->detector.reset(); }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->setAttack(this->attackMillis);
+            this->setRelease(this->releaseMillis);
+            this->reset();
+        }
     };
 }
 #endif
\ No newline at end of file
@@ -6,51 +6,69 @@ namespace giml {
     /**
      * @brief This class implements a basic delay with feedback effect. 
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, 
+     * and a fixed-point `giml::q31` or `giml::q15` without floating-point math per sample, see `sample_traits`
+     * @tparam StorageT type the delay line stores samples as, such as `int16_t`, `giml::half` or `giml::bfloat16`
+     * to halve its memory and bandwidth (floating-point `T` only), see `storage_codec`
+     * @tparam MaxSamples if non-zero, the delay line is stored inline in the object (`MaxSamples` long) 
+     * instead of on the heap, and longer maximum delay times are clamped to it, e.g. `Delay<float, float, 144000>`
      * @todo store delayTime in samples 
      */
-    template <typename T>
+    template <typename T, typename StorageT = T, size_t MaxSamples = 0>
     class Delay : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
+        using Coeff = typename sample_traits<T>::coeff;
         int sampleRate;
-        T feedback = 0.3, delayTime = 398.0, blend = 0.5, damping = 0.5;
+        Scalar delayTime = 398.0, damping = 0.5, maxDelayMillis = 3000.0;
+        Coeff feedback = 0.3, blend = 0.5;
+        size_t readIndex = 0; // `delayTime` in whole samples...
+        Coeff readFrac = 0.0; // ...and the fraction of the next one
         giml::OnePole<T> loPass; // loPass filter for damping
         giml::OnePole<T> dcBlock; // See Generating Sound & Organizing Time I - Wakefield and Taylor 2022 Chapter 7 pg. 204
-        giml::CircularBuffer<T> buffer; // circular buffer to store past  values
+        giml::CircularBuffer<T, StorageT, MaxSamples> buffer; // circular buffer to store past  values
 
     public:
         // Constructor
         Delay() = delete;
-        Delay(int samprate, T maxDelayMillis = 3000) : sampleRate(samprate) {
+        Delay(int samprate, Scalar maxDelayMillis = 3000) : sampleRate(samprate), maxDelayMillis(maxDelayMillis) {
             this->buffer.allocate(giml::millisToSamples(maxDelayMillis, samprate)); // max delayTime is 3 seconds
             this->loPass.setG(this->damping); // set damping 
             this->dcBlock.setCutoff(3.0, samprate);// set dcBlock at 3Hz
+            this->setDelayTime(this->delayTime);
         }
 
         // Destructor
         ~Delay() {}
 
         // Copy constructor
-        Delay(const Delay<T>& d) {
+        Delay(const Delay<T, StorageT, MaxSamples>& d) {
             this->enabled = d.enabled;
             this->sampleRate = d.sampleRate;
             this->feedback = d.feedback;
             this->delayTime = d.delayTime;
             this->blend = d.blend;
             this->damping = d.damping;
+            this->maxDelayMillis = d.maxDelayMillis;
+            this->readIndex = d.readIndex;
+            this->readFrac = d.readFrac;
             this->loPass = d.loPass;
             this->dcBlock = d.dcBlock;
             this->buffer = d.buffer;
         }
 
         // Copy assignment operator 
-        Delay<T>& operator=(const Delay<T>& d) {
+        Delay<T, StorageT, MaxSamples>& operator=(const Delay<T, StorageT, MaxSamples>& d) {
             this->enabled = d.enabled;
             this->sampleRate = d.sampleRate;
             this->feedback = d.feedback;
             this->delayTime = d.delayTime;
             this->blend = d.blend;
             this->damping = d.damping;
+            this->maxDelayMillis = d.maxDelayMillis;
+            this->readIndex = d.readIndex;
+            this->readFrac = d.readFrac;
             this->loPass = d.loPass;
             this->dcBlock = d.dcBlock;
             this->buffer = d.buffer;
@@ -63,20 +81,20 @@ namespace giml {
          * @return `in * 1-blend + y_D * blend`
          */
         inline T processSample(const T& in) {
-            // calling `millisToSamples` every sample is not performant 
-            T readIndex = millisToSamples(this->delayTime, this->sampleRate); // calculate read index
-            T y_0 = loPass.lpf(this->buffer.readSample(readIndex)); // read from buffer and loPass
+            GIML_TRACE_SAMPLE_SCOPE("Delay::processSample");
+            T y_0 = loPass.lpf(this->buffer.readSample(this->readIndex, this->readFrac)); // read from buffer and loPass
             this->buffer.writeSample(this->dcBlock.hpf(in + giml::limit<T>(y_0 * this->feedback, 0.75))); // write sample to delay buffer
 
           if (!(this->enabled)) { return in; } 
-          return giml::linMix<float>(in, y_0, this->blend); // return wet/dry mix
+          return giml::linMix<T>(in, y_0, this->blend); // return wet/dry mix
         }
 
         /**
          * @brief sets params delayTime, feedback, damping, and blend
          */
-        void setParams(T delayTime = 398.0, T feedback = 0.3, 
-                       T damping = 0.5, T blend = 0.5) {
+        void setParams(Scalar delayTime = 398.0, Scalar feedback = 0.3, 
+                       Scalar damping = 0.5, Scalar blend = 0.5) {
+            GIML_TRACE_SCOPE("Delay::setParams");
             this->setDelayTime(delayTime);
             this->setFeedback(feedback);
             this->setDamping(damping);
@@ -88,22 +106,25 @@ namespace giml {
          * @param sizeMillis delay time in milliseconds. 
          * Clamped to `samplesToMillis(bufferSize)`
          */
-        void setDelayTime(T sizeMillis) { 
-            this->delayTime = giml::clip<T>(sizeMillis, 0, samplesToMillis(buffer.size(), this->sampleRate));
+        void setDelayTime(Scalar sizeMillis) { 
+            this->delayTime = giml::clip<Scalar>(sizeMillis, 0, samplesToMillis(buffer.size(), this->sampleRate));
+            Scalar delaySamples = millisToSamples(this->delayTime, this->sampleRate);
+            this->readIndex = delaySamples;
+            this->readFrac = delaySamples - this->readIndex;
         }
 
         /**
          * @brief Set feedback gain.  
          * @param fbGain gain in linear amplitude. Be careful setting above 1!
          */
-        void setFeedback(T fbGain) { this->feedback = fbGain; }
+        void setFeedback(Scalar fbGain) { this->feedback = fbGain; }
 
         /**
          * @brief Set damping manually
          * @param a damping value. Clipped to `[0,1]`
          */
-        void setDamping(T a) { 
-            this->damping = giml::clip<T>(a, 0, 1);;
+        void setDamping(Scalar a) { 
+            this->damping = giml::clip<Scalar>(a, 0, 1);
             this->loPass.setG(this->damping);
         }
 
@@ -111,18 +132,44 @@ namespace giml {
          * @brief Set blend (linear)
          * @param gWet percentage of wet to blend in. Clipped to `[0,1]`
          */
-        void setBlend(T gWet) { this->blend = giml::clip<T>(gWet, 0, 1); }
+        void setBlend(Scalar gWet) { this->blend = giml::clip<Scalar>(gWet, 0, 1); }
+
+        /**
+         * @brief the feedback loop's trips until it decays below the threshold, 
+         * plus the damping and DC blocking filters
+         */
+        int getTailSamples() const override {
+            // every trip around the loop scales the signal by at most `|feedback|` (damping and the limiter only attenuate)
+            int trips = decaySamples(static_cast<Scalar>(this->feedback));
+            int loPassTail = this->loPass.getTailSamples(), dcBlockTail = this->dcBlock.getTailSamples();
+            if (trips < 0 || loPassTail < 0 || dcBlockTail < 0) { return -1; }
+            int delaySamples = static_cast<int>(::ceil(millisToSamples(this->delayTime, this->sampleRate)));
+            return (trips + 1) * (delaySamples + loPassTail) + dcBlockTail;
+        }
 
         /**
          * @brief Set feedback gain based on a t60 time value  
          * @param timeMillis desired decay time in milliseconds
          */
-        void setFeedback_t60(T timeMillis) {
-            T normalizedDecay = millisToSamples(timeMillis, this->sampleRate) / 
+        void setFeedback_t60(Scalar timeMillis) {
+            Scalar normalizedDecay = millisToSamples(timeMillis, this->sampleRate) / 
             millisToSamples(this->delayTime, this->sampleRate);
-            this->feedback = giml::t60<T>(static_cast<int>(::round(normalizedDecay)));
+            this->feedback = giml::t60<Scalar>(static_cast<int>(::round(normalizedDecay)));
         }
 
+        void reset() override {
+            this->buffer.clear();
+            this->loPass.reset();
+            this->dcBlock.reset();
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->buffer.allocate(giml::millisToSamples(this->maxDelayMillis, sampleRate));
+            this->dcBlock.setCutoff(3.0, sampleRate);
+            this->setDelayTime(this->delayTime);
+            this->reset();
+        }
     };
 
 } // namespace giml
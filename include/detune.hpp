@@ -7,51 +7,74 @@ namespace giml {
     /**
      * @brief This class implements a time-domain pitchshifter 
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, see `sample_traits`
      * 
      * @todo calculate an optimal `windowSize` given an arbitrary `pitchRatio`
      * @todo store windowSize as samples instead of millis
      * 
+     * @tparam MaxSamples if non-zero, the window buffer is stored inline in the object (`MaxSamples` long) 
+     * instead of on the heap, and longer maximum delays are clamped to it
      */
-    template <typename T>
+    template <typename T, size_t MaxSamples = 0>
     class Detune : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
         int sampleRate;
-        T pitchRatio = 1.0, windowSize = 1000.0, blend = 0.5; 
-        giml::CircularBuffer<T> buffer;
-        giml::Phasor<T> osc;
+        Scalar pitchRatio = 1.0, windowSize = 1000.0, blend = 0.5, windowMillis = 0.0, maxWindowMillis = 300.0; 
+        giml::CircularBuffer<T, T, MaxSamples> buffer;
+        giml::Phasor<Scalar> osc; // one LFO shared by all lanes
+        giml::QuadOsc<Scalar> windows; // `sin` and `cos` of `pi * osc`, the two read points' gains
+        size_t windowSync = 0; // samples since `windows` was last synced to `osc`
+
+        // Sets the rate of `osc`, and of `windows` at half of it: a window spans one cycle of `osc`
+        void setFrequency(Scalar freqHz) {
+            this->osc.setFrequency(freqHz);
+            this->windows.setFrequency(freqHz / 2);
+            this->windows.setPhase(this->osc.getPhase() * 0.5);
+            this->windowSync = 0;
+        }
 
     public:
         // Constructor
         Detune() = delete;
-        Detune(int samprate, float maxWindowMillis = 300.0) : sampleRate(samprate), osc(samprate) {
-            this->osc.setFrequency(1000.0 * ((1.0 - this->pitchRatio) / this->windowSize));
+        Detune(int samprate, float maxWindowMillis = 300.0) : sampleRate(samprate), maxWindowMillis(maxWindowMillis), osc(samprate), windows(samprate) {
+            this->setFrequency(1000.0 * ((1.0 - this->pitchRatio) / this->windowSize));
             this->buffer.allocate(giml::millisToSamples(maxWindowMillis, samprate));
+            this->windowMillis = giml::samplesToMillis(this->windowSize, samprate);
         }
 
         // Destructor 
         ~Detune() {}
 
         // Copy constructor
-        Detune(const Detune<T>& d) {
+        Detune(const Detune<T, MaxSamples>& d) : osc(d.osc), windows(d.windows) {
             this->enabled = d.enabled;
             this->sampleRate = d.sampleRate;
             this->pitchRatio = d.pitchRatio;
             this->windowSize = d.windowSize;
             this->blend = d.blend;
+            this->windowMillis = d.windowMillis;
+            this->maxWindowMillis = d.maxWindowMillis;
             this->buffer = d.buffer;
             this->osc = d.osc;
+            this->windows = d.windows;
+            this->windowSync = d.windowSync;
         }
 
         // Copy assignment operator 
-        Detune<T>& operator=(const Detune<T>& d) {
+        Detune<T, MaxSamples>& operator=(const Detune<T, MaxSamples>& d) {
             this->enabled = d.enabled;
             this->sampleRate = d.sampleRate;
             this->pitchRatio = d.pitchRatio;
             this->windowSize = d.windowSize;
             this->blend = d.blend;
+            this->windowMillis = d.windowMillis;
+            this->maxWindowMillis = d.maxWindowMillis;
             this->buffer = d.buffer;
             this->osc = d.osc;
+            this->windows = d.windows;
+            this->windowSync = d.windowSync;
             return *this;
         }
 
@@ -62,12 +85,13 @@ namespace giml {
          * create pitch-shifting via the doppler effect 
          */
         inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("Detune::processSample");
 
             // bypass behavior 
             this->buffer.writeSample(in); // write sample to delay buffer
             if (!this->enabled) { return in; } // return input 
 
-            T phase = this->osc.processSample(); 
+            Scalar phase = this->osc.processSample(); 
             float phase2 = phase + 0.5; // mod phase
             phase2 -= floor(phase2); // wrap mod phase
 
@@ -77,17 +101,24 @@ namespace giml {
             T output = this->buffer.readSample(readIndex); // get sample
             T output2 = this->buffer.readSample(readIndex2); // get sample 2
 
-            T windowOne = cos((phase - 0.5) * M_PI); // gain windowing
-            T windowTwo = cos((phase2 - 0.5) * M_PI);// ^
+            // gain windowing: `cos((phase - 0.5) * pi) = sin(pi * phase)`, and `cos((phase2 - 0.5) * pi) = |cos(pi * phase)|`
+            this->windows.processSample();
+            if (++this->windowSync == detail::lfoBlockSize) { // keep in step with `osc`'s float phase
+                this->windows.setPhase(phase * 0.5);
+                this->windowSync = 0;
+            }
+            Scalar windowOne = ::abs(this->windows.getSin());
+            Scalar windowTwo = ::abs(this->windows.getCos());
             
             T out = output * windowOne + output2 * windowTwo; // windowed output
-            return giml::linMix(in, out, this->blend); 
+            return giml::linMix<T>(in, out, this->blend); 
         }
 
         /**
          * @brief sets params pitchRatio, windowSize, and blend
          */
-        void setParams(T pitchRatio = 1.0, T windowSize = 22.0, T blend = 0.5) {
+        void setParams(Scalar pitchRatio = 1.0, Scalar windowSize = 22.0, Scalar blend = 0.5) {
+            GIML_TRACE_SCOPE("Detune::setParams");
             this->setWindowSize(windowSize);
             this->setPitchRatio(pitchRatio);
             this->setBlend(blend);
@@ -97,9 +128,9 @@ namespace giml {
          * @brief Set the pitch change ratio
          * @param ratio of desired pitch to input 
          */
-        void setPitchRatio(T ratio) {
+        void setPitchRatio(Scalar ratio) {
             this->pitchRatio = ratio;
-            this->osc.setFrequency(1000.0 * ((1.0 - ratio) / this->windowSize));
+            this->setFrequency(1000.0 * ((1.0 - ratio) / this->windowSize));
         }
 
         /**
@@ -107,7 +138,8 @@ namespace giml {
          * @param sizeMillis the max amount of delay in milliseconds 
          * when `osc` is at its peak
          */
-        void setWindowSize(T sizeMillis) {
+        void setWindowSize(Scalar sizeMillis) {
+            this->windowMillis = sizeMillis;
             sizeMillis = giml::millisToSamples(sizeMillis, this->sampleRate);
             if (sizeMillis > this->buffer.size()) {
                 sizeMillis = this->buffer.size();
@@ -119,8 +151,25 @@ namespace giml {
          * @brief Set blend 
          * @param b clamped to [0,1], 1.0 = 100% wet, 0.0 = 100% dry
          */
-        void setBlend(T b) { 
-            this->blend = giml::clip<T>(b, 0.0, 1.0); 
+        void setBlend(Scalar b) { 
+            this->blend = giml::clip<Scalar>(b, 0.0, 1.0); 
+        }
+
+        void reset() override {
+            this->buffer.clear();
+            this->osc.setPhase(0);
+            this->windows.setPhase(this->osc.getPhase() * 0.5);
+            this->windowSync = 0;
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->buffer.allocate(giml::millisToSamples(this->maxWindowMillis, sampleRate));
+            this->osc.setSampleRate(sampleRate);
+            this->windows.setSampleRate(sampleRate);
+            this->setWindowSize(this->windowMillis); // stored in samples
+            this->setPitchRatio(this->pitchRatio); // LFO rate depends on the window in samples
+            this->reset();
         }
     };
 }
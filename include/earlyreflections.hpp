@@ -0,0 +1,365 @@
+#ifndef GIML_EARLYREFLECTIONS_HPP
+#define GIML_EARLYREFLECTIONS_HPP
+#include "utility.hpp"
+#include "reverb.hpp"
+#include "simd.hpp"
+namespace giml {
+    /**
+     * @brief Early reflections: up to 32 sparse taps (time, gain, pan) read from one delay line.
+     * Use it standalone, or in front of a `Reverb` whose tank then diffuses the reflections.
+     *
+     * Tap sets come from the same room model as `Reverb::setRoom()`, or are set one by one with `setTap()`.
+     * With `float` samples, `processSample()` gathers every tap in SIMD vectors, and `processBlock()`
+     * adds each tap's contiguous span of the delay line to the whole block (`simd::kernels()`),
+     * so a tap costs a fraction of a `Delay` instance
+     *
+     * @tparam T floating-point (float or double)
+     */
+    template <typename T>
+    class EarlyReflections : public Effect<T> {
+    public:
+        using RoomType = typename Reverb<T>::RoomType;
+        using CustomRoom = typename Reverb<T>::CustomRoom;
+        static constexpr int maxTaps = 32;
+
+    private:
+        using V = simd::f32x4;
+        static constexpr int defaultBlockSize = 256; // room in the delay line for `processBlock()` before `prepare()`
+
+        int sampleRate;
+        float maxDelayMillis, blend = 0.5f;
+        int numTaps = 0;
+        CircularBuffer<T> buffer;
+
+        // Taps as structures of arrays, padded to a whole vector with silent 1-sample taps
+        float tapMillis[maxTaps] = {}, tapGains[maxTaps] = {}, tapPans[maxTaps] = {};
+        int32_t tapDelays[maxTaps] = {}; // in samples, at least 1
+        float wetGains[maxTaps] = {}, wetGainsL[maxTaps] = {}, wetGainsR[maxTaps] = {}; // tap gains times `blend`, panned
+        int32_t tapIndices[maxTaps] = {}; // scratch for the gather
+
+        int paddedTaps() const { return (this->numTaps + V::width - 1) / V::width * V::width; }
+        int maxDelaySamples() const { return (int)::ceil(millisToSamples(this->maxDelayMillis, this->sampleRate)); }
+
+        /**
+         * @brief Recomputes the tap delays in samples and the panned gains, with `blend` folded in
+         */
+        void updateTaps() {
+            int maxDelay = this->maxDelaySamples();
+            for (int k = 0; k < maxTaps; k++) {
+                bool active = k < this->numTaps;
+                int delay = active ? (int)::round(millisToSamples(this->tapMillis[k], this->sampleRate)) : 1;
+                this->tapDelays[k] = giml::clip<int>(delay, 1, maxDelay);
+                float gain = active ? this->tapGains[k] * this->blend : 0.f;
+                float angle = (this->tapPans[k] + 1) * float(M_PI_4); // constant power
+                this->wetGains[k] = gain;
+                this->wetGainsL[k] = gain * ::cosf(angle);
+                this->wetGainsR[k] = gain * ::sinf(angle);
+            }
+        }
+
+        /**
+         * @brief Spreads `count` taps over a room with the given volume-to-surface ratio, as an image source model would:
+         * the first reflection after one mean free path (`4V/S`), the number of reflections growing with the cube of time,
+         * each losing `absorptionCoefficient` of its energy per bounce and spreading with distance.
+         * Pans alternate sides, spread by the golden ratio. Gains are normalized to unit energy
+         */
+        void generateTaps(float volumeOverArea, float absorptionCoefficient, int count) {
+            const float speedOfSound = 1125.f; // ft/s, the room model is in feet
+            const float goldenRatio = 0.618033988749895f;
+            float firstMillis = 1000.f * 4 * volumeOverArea / speedOfSound;
+            float reflectance = 1 - giml::clip<float>(absorptionCoefficient, 0, 1);
+            this->numTaps = giml::clip<int>(count, 0, maxTaps);
+            float energy = 0.f;
+            for (int k = 0; k < this->numTaps; k++) {
+                float jitter = (k + 1) * goldenRatio - (int)((k + 1) * goldenRatio);
+                float bounces = ::cbrtf(k + 1 + jitter); // in mean free paths
+                this->tapMillis[k] = firstMillis * bounces;
+                this->tapGains[k] = ::powf(reflectance, bounces / 2) / bounces;
+                this->tapPans[k] = (k % 2) ? -jitter : jitter;
+                energy += this->tapGains[k] * this->tapGains[k];
+            }
+            if (energy > 0) {
+                float norm = 1 / ::sqrtf(energy);
+                for (int k = 0; k < this->numTaps; k++) { this->tapGains[k] *= norm; }
+            }
+            this->updateTaps();
+        }
+
+        // Gathers every tap from the delay line, before the current sample is written
+        inline void gatherTaps(V* taps) {
+            const float* data = this->buffer.data();
+            int32_t writeIndex = (int32_t)this->buffer.index(0), size = (int32_t)this->buffer.size();
+            int n = this->paddedTaps();
+            for (int k = 0; k < n; k++) {
+                int32_t i = writeIndex - this->tapDelays[k];
+                this->tapIndices[k] = (i < 0) ? i + size : i;
+            }
+            for (int k = 0; k < n; k += V::width) { taps[k / V::width] = V::gather(data, this->tapIndices + k); }
+        }
+
+        // Adds each tap's span of the delay line (the last `n` samples written, `tapDelays` ago) to `out`, times `gains`
+        inline void addTapSpans(float* out, size_t n, const float* gains, size_t start) {
+            const simd::Kernels& kernels = simd::kernels();
+            const float* data = this->buffer.data();
+            size_t size = this->buffer.size();
+            for (int k = 0; k < this->numTaps; k++) {
+                size_t first = (start >= (size_t)this->tapDelays[k]) ? start - this->tapDelays[k] : start + size - this->tapDelays[k];
+                size_t span = std::min(n, size - first); // up to the end of the delay line...
+                kernels.mulAdd(out, data + first, span, gains[k]);
+                if (span < n) { kernels.mulAdd(out + span, data, n - span, gains[k]); } // ...then from its start
+            }
+        }
+
+        // Largest block that `addTapSpans()` can read after writing it, without overwriting samples still to be read
+        size_t blockCapacity() const { return this->buffer.size() - this->maxDelaySamples(); }
+
+    public:
+        // Constructor
+        EarlyReflections() = delete;
+        /**
+         * @param maxDelayMillis latest reflection, later taps are clamped to it
+         */
+        EarlyReflections(int sampleRate, float maxDelayMillis = 500.f) : sampleRate(sampleRate), maxDelayMillis(maxDelayMillis) {
+            this->buffer.allocate(this->maxDelaySamples() + defaultBlockSize);
+            this->setRoom(30.f);
+        }
+
+        // Destructor
+        ~EarlyReflections() {}
+
+        // Copy constructor
+        EarlyReflections(const EarlyReflections<T>& e) { *this = e; }
+
+        // Copy assignment operator
+        EarlyReflections<T>& operator=(const EarlyReflections<T>& e) {
+            if (this == &e) { return *this; }
+            this->enabled = e.enabled;
+            this->sampleRate = e.sampleRate;
+            this->maxDelayMillis = e.maxDelayMillis;
+            this->blend = e.blend;
+            this->numTaps = e.numTaps;
+            this->buffer = e.buffer;
+            for (int k = 0; k < maxTaps; k++) {
+                this->tapMillis[k] = e.tapMillis[k];
+                this->tapGains[k] = e.tapGains[k];
+                this->tapPans[k] = e.tapPans[k];
+            }
+            this->updateTaps();
+            return *this;
+        }
+
+        /**
+         * @brief Sets the taps from a room and the wet/dry blend
+         * @see setRoom()
+         */
+        void setParams(float roomLength = 30.f, float absorptionCoefficient = 0.75f, RoomType roomType = RoomType::SPHERE,
+                       int numTaps = 16, float blend = 0.5f) {
+            GIML_TRACE_SCOPE("EarlyReflections::setParams");
+            this->blend = giml::clip<float>(blend, 0, 1);
+            this->setRoom(roomLength, absorptionCoefficient, roomType, numTaps);
+        }
+
+        /**
+         * @brief Generates the taps of a preset room, with the same shapes and absorption model as `Reverb`
+         * @param length side or radius of the room in feet
+         * @param absorptionCoefficient [0, 1] average absorption of the surfaces
+         * @param type preset shape
+         * @param numTaps number of reflections, up to `maxTaps`
+         */
+        void setRoom(float length, float absorptionCoefficient = 0.75f, RoomType type = RoomType::SPHERE, int numTaps = 16) {
+            GIML_TRACE_SCOPE("EarlyReflections::setRoom");
+            if (length < 0) { length = 0; }
+            absorptionCoefficient = giml::clip<float>(absorptionCoefficient, 1e-3f, 1);
+            // `roomRT60()` is `V / (2 * SA * absorption)`
+            float volumeOverArea = 2 * absorptionCoefficient * detail::roomRT60(length, absorptionCoefficient, type);
+            this->generateTaps(volumeOverArea, absorptionCoefficient, numTaps);
+        }
+
+        /**
+         * @brief Generates the taps of a custom room
+         * @param customRoom volume, surface area and absorption, see `Reverb::CustomRoom`
+         * @param numTaps number of reflections, up to `maxTaps`
+         */
+        void setRoom(CustomRoom* customRoom, int numTaps = 16) {
+            GIML_TRACE_SCOPE("EarlyReflections::setRoom");
+            this->generateTaps(customRoom->getVolume() / customRoom->getSurfaceArea(), customRoom->getAbsorptionCoefficient(), numTaps);
+        }
+
+        /**
+         * @brief Sets one tap, and extends the tap count to include it
+         * @param index tap number, `[0, maxTaps)`
+         * @param timeMillis delay in milliseconds, clamped to `[1 sample, maxDelayMillis]`
+         * @param gain linear gain
+         * @param pan -1 (left) to 1 (right), used by the stereo outputs
+         */
+        void setTap(int index, float timeMillis, float gain, float pan = 0.f) {
+            if (index < 0 || index >= maxTaps) { return; }
+            this->tapMillis[index] = timeMillis;
+            this->tapGains[index] = gain;
+            this->tapPans[index] = giml::clip<float>(pan, -1, 1);
+            if (index >= this->numTaps) { this->numTaps = index + 1; }
+            this->updateTaps();
+        }
+
+        /**
+         * @brief Keeps the first `n` taps, up to `maxTaps`
+         */
+        void setNumTaps(int n) {
+            this->numTaps = giml::clip<int>(n, 0, maxTaps);
+            this->updateTaps();
+        }
+        int getNumTaps() const { return this->numTaps; }
+
+        /**
+         * @brief Set blend (linear)
+         * @param gWet percentage of wet to blend in. Clipped to `[0,1]`
+         */
+        void setBlend(float gWet) {
+            this->blend = giml::clip<float>(gWet, 0, 1);
+            this->updateTaps();
+        }
+
+        /**
+         * @brief Writes the input to the delay line and returns it blended with the sum of the taps
+         * @param in input sample
+         * @return `in * (1-blend) + reflections * blend`
+         */
+        inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("EarlyReflections::processSample");
+            T wet = 0;
+            if (this->enabled) {
+                if constexpr (std::is_same<T, float>::value) {
+                    V taps[maxTaps / V::width];
+                    this->gatherTaps(taps);
+                    V acc = V(0.f);
+                    for (int k = 0; k < this->paddedTaps(); k += V::width) { acc = fma(taps[k / V::width], V::load(this->wetGains + k), acc); }
+                    wet = reduceAdd(acc);
+                }
+                else {
+                    for (int k = 0; k < this->numTaps; k++) { wet += this->buffer.readSample((size_t)this->tapDelays[k]) * this->wetGains[k]; }
+                }
+            }
+            this->buffer.writeSample(in);
+            if (!(this->enabled)) { return in; }
+            return in * (1 - this->blend) + wet;
+        }
+
+        /**
+         * @brief Processes one stereo frame: the mid signal feeds the delay line and every tap is panned
+         * @param inL left input
+         * @param inR right input
+         * @param outL left output
+         * @param outR right output
+         */
+        inline void processSample(const T& inL, const T& inR, T& outL, T& outR) {
+            GIML_TRACE_SAMPLE_SCOPE("EarlyReflections::processSample");
+            T wetL = 0, wetR = 0;
+            if (this->enabled) {
+                if constexpr (std::is_same<T, float>::value) {
+                    V taps[maxTaps / V::width];
+                    this->gatherTaps(taps);
+                    V accL = V(0.f), accR = V(0.f);
+                    for (int k = 0; k < this->paddedTaps(); k += V::width) {
+                        accL = fma(taps[k / V::width], V::load(this->wetGainsL + k), accL);
+                        accR = fma(taps[k / V::width], V::load(this->wetGainsR + k), accR);
+                    }
+                    wetL = reduceAdd(accL);
+                    wetR = reduceAdd(accR);
+                }
+                else {
+                    for (int k = 0; k < this->numTaps; k++) {
+                        T tap = this->buffer.readSample((size_t)this->tapDelays[k]);
+                        wetL += tap * this->wetGainsL[k];
+                        wetR += tap * this->wetGainsR[k];
+                    }
+                }
+            }
+            this->buffer.writeSample((inL + inR) * T(0.5));
+            if (!(this->enabled)) {
+                outL = inL;
+                outR = inR;
+                return;
+            }
+            outL = inL * (1 - this->blend) + wetL;
+            outR = inR * (1 - this->blend) + wetR;
+        }
+
+        /**
+         * @brief Writes the block to the delay line, then adds every tap's span of it to the block
+         * (in chunks if the block is longer than `prepare()`'s `maxBlockSize`)
+         */
+        void processBlock(T* buffer, size_t numSamples) override {
+            GIML_TRACE_SCOPE("EarlyReflections::processBlock");
+            if constexpr (std::is_same<T, float>::value) {
+                if (!(this->enabled)) {
+                    for (size_t i = 0; i < numSamples; i++) { this->buffer.writeSample(buffer[i]); }
+                    return;
+                }
+                size_t capacity = this->blockCapacity();
+                for (size_t offset = 0; offset < numSamples; offset += capacity) {
+                    size_t n = std::min(capacity, numSamples - offset);
+                    float* block = buffer + offset;
+                    size_t start = this->buffer.index(0);
+                    for (size_t i = 0; i < n; i++) { this->buffer.writeSample(block[i]); }
+                    simd::kernels().scale(block, n, 1 - this->blend);
+                    this->addTapSpans(block, n, this->wetGains, start);
+                }
+            }
+            else { Effect<T>::processBlock(buffer, numSamples); }
+        }
+
+        /**
+         * @brief Processes a block of stereo frames in place, see the stereo `processSample()`
+         * @param left left channel, overwritten with the output
+         * @param right right channel, overwritten with the output
+         * @param numSamples number of samples in each channel
+         */
+        void processBlock(T* left, T* right, size_t numSamples) {
+            GIML_TRACE_SCOPE("EarlyReflections::processBlock");
+            if constexpr (std::is_same<T, float>::value) {
+                size_t capacity = this->blockCapacity();
+                for (size_t offset = 0; offset < numSamples; offset += capacity) {
+                    size_t n = std::min(capacity, numSamples - offset);
+                    float* blockL = left + offset;
+                    float* blockR = right + offset;
+                    size_t start = this->buffer.index(0);
+                    for (size_t i = 0; i < n; i++) { this->buffer.writeSample((blockL[i] + blockR[i]) * 0.5f); }
+                    if (!(this->enabled)) { continue; }
+                    simd::kernels().scale(blockL, n, 1 - this->blend);
+                    simd::kernels().scale(blockR, n, 1 - this->blend);
+                    this->addTapSpans(blockL, n, this->wetGainsL, start);
+                    this->addTapSpans(blockR, n, this->wetGainsR, start);
+                }
+            }
+            else {
+                for (size_t i = 0; i < numSamples; i++) { this->processSample(left[i], right[i], left[i], right[i]); }
+            }
+        }
+
+        /**
+         * @brief the latest tap, there is no feedback
+         */
+        int getTailSamples() const override {
+            int tail = 0;
+            for (int k = 0; k < this->numTaps; k++) { tail = std::max(tail, (int)this->tapDelays[k]); }
+            return tail;
+        }
+
+        void reset() override { this->buffer.clear(); }
+
+        /**
+         * @brief Resizes the delay line for `maxDelayMillis` at `sampleRate` plus a block of `maxBlockSize`
+         * (reallocating only if it must grow) and recomputes the tap delays
+         */
+        void prepare(int sampleRate, size_t maxBlockSize) override {
+            GIML_TRACE_SCOPE("EarlyReflections::prepare");
+            this->sampleRate = sampleRate;
+            size_t blockSize = std::max(maxBlockSize, (size_t)defaultBlockSize);
+            this->buffer.allocate(this->maxDelaySamples() + blockSize);
+            this->updateTaps();
+            this->reset();
+        }
+    };
+
+} // namespace giml
+#endif
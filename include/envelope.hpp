@@ -12,7 +12,7 @@ namespace giml {
     class EnvelopeFilter : public Effect<T> {
     private:
         int sampleRate;
-        T qFactor, aAttack, aRelease;
+        T qFactor, aAttack, aRelease, attackMillis, releaseMillis;
         Vactrol<T> mVactrol;
         SVF<T> mFilter;
 
@@ -35,6 +35,8 @@ namespace giml {
             qFactor(e.qFactor),
             aAttack(e.aAttack),
             aRelease(e.aRelease),
+            attackMillis(e.attackMillis),
+            releaseMillis(e.releaseMillis),
             mVactrol(e.mVactrol),
             mFilter(e.mFilter)
         {}
@@ -45,12 +47,15 @@ namespace giml {
             this->qFactor = e.qFactor;
             this->aAttack = e.aAttack;
             this->aRelease = e.aRelease;
+            this->attackMillis = e.attackMillis;
+            this->releaseMillis = e.releaseMillis;
             this->mVactrol = e.mVactrol;
             this->mFilter = e.mFilter;
             return *this;
         }
 
-        inline T processSample(const float& in) override {
+        inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("EnvelopeFilter::processSample");
             if (!this->enabled) { return in; }
 
             // rectify, then smooth with vactrol
@@ -70,6 +75,7 @@ namespace giml {
         
         // Set parameters for the envelope filter
         void setParams(T qFactor = 10.0, T attackMillis = 7.76, T releaseMillis = 1105.0) {
+            GIML_TRACE_SCOPE("EnvelopeFilter::setParams");
             this->setQ(qFactor);
             this->setAttack(attackMillis);
             this->setRelease(releaseMillis);
@@ -89,6 +95,7 @@ namespace giml {
          * @param attackMillis attack time in milliseconds 
          */
         void setAttack(T attackMillis) { // calculated from Reiss et al. 2011 (Eq. 7)
+            this->attackMillis = attackMillis;
             this->aAttack = timeConstant(attackMillis, sampleRate);
         }
 
@@ -97,9 +104,33 @@ namespace giml {
          * @param releaseMillis release time in milliseconds 
          */
         void setRelease(T releaseMillis) { // // 
+            this->releaseMillis = releaseMillis;
             this->aRelease = timeConstant(releaseMillis, sampleRate);
         }
 
+        /**
+         * @brief the vactrol's tail plus the filter's ring-down, 
+         * which is longest at the lowest cutoff (185 Hz): poles at radius `exp(-pi * f / (Q * sampleRate))`
+         */
+        int getTailSamples() const override {
+            int vactrol = this->mVactrol.getTailSamples();
+            int filter = decaySamples(::exp(-M_PI * 185.0 / (this->qFactor * this->sampleRate)));
+            return (vactrol < 0 || filter < 0) ? -1 : vactrol + filter;
+        }
+
+        void reset() override {
+            this->mVactrol.reset();
+            this->mFilter.reset();
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->mVactrol.setSampleRate(sampleRate);
+            this->mFilter = SVF<T>(sampleRate);
+            this->setAttack(this->attackMillis);
+            this->setRelease(this->releaseMillis);
+            this->reset();
+        }
     };
 
 } // namespace giml
@@ -7,14 +7,17 @@ namespace giml {
     /**
      * @brief This class implements the ideal Expander described in Reiss et al. 2011
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, see `sample_traits`
      */
     template <typename T>
     class Expander : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
         int sampleRate;
-        T thresh_dB = 0.0, ratio = 4.0, knee_dB = 2.0, 
-        aRelease = 3.5, aAttack = 100.0;
+        Scalar thresh_dB = 0.0, ratio = 4.0, knee_dB = 2.0, 
+        aRelease = 0.0, aAttack = 0.0,
+        attackMillis = 3.5, releaseMillis = 100.0;
         dBDetector<T> detector; // dB detector
         bool sideChainEnabled = false;
         T sideChainLastIn = 0.0;
@@ -25,7 +28,7 @@ namespace giml {
          * Inversion of Reiss et al. 2011 compressor done by
          * https://www.mathworks.com/help/audio/ref/expander-system-object.html.
          * 
-         * All params in dB!
+         * All params in dB! Branchless: every region is computed and the right one is selected per lane
          * 
          * @param x_dB input gain in dB
          * @param thresh Expander threshold
@@ -33,28 +36,26 @@ namespace giml {
          * @param knee Expander knee width
          * @return `x_sc - x_dB` 
          */
-        T computeGain(T x_dB, T thresh, T ratio, T knee) {
-            T x_sc = x_dB; // placeholder (passthru)
-            // calculate x_sc
-            if (x_dB < thresh - (0.5 * knee)) { // if input < thresh - knee
-                x_sc = thresh + ((x_dB - thresh) * ratio);
-            } 
-            else if (abs(x_dB - thresh) <= 0.5 * knee) { // if input is inside knee
-                x_sc = x_dB + 
+        T computeGain(T x_dB, Scalar thresh, Scalar ratio, Scalar knee) {
+            using S = sample_traits<T>;
+            T below = thresh + ((x_dB - thresh) * ratio);
+            T inKnee = x_dB + 
                 (1.0 - ratio) *
                 ( (x_dB - thresh - (knee * 0.5)) * (x_dB - thresh - (knee * 0.5)) ) /
                 (2.0 * knee); // knee needs to be non-zero
-            } 
-            else if (x_dB > thresh + (0.5 * knee)) { // if input > thresh + knee
-                x_sc = x_dB;
-            }
-            return x_sc; 
+
+            // above the knee the input passes through
+            T x_sc = S::select(S::abs(x_dB - thresh) <= 0.5 * knee, inKnee, x_dB); // if input is inside knee
+            return S::select(x_dB < thresh - (0.5 * knee), below, x_sc); // if input < thresh - knee
         }
 
     public:
         // Constructor
         Expander() = delete; // Do not allow an empty constructor, they must pass in a sampleRate
-        Expander(int sampleRate) : sampleRate(sampleRate) {}
+        Expander(int sampleRate) : sampleRate(sampleRate) {
+            this->setAttack(this->attackMillis);
+            this->setRelease(this->releaseMillis);
+        }
         
         // Destructor
         ~Expander() {}
@@ -67,6 +68,8 @@ namespace giml {
             knee_dB(c.knee_dB),
             aRelease(c.aRelease),
             aAttack(c.aAttack),
+            attackMillis(c.attackMillis),
+            releaseMillis(c.releaseMillis),
             detector(c.detector), // Copy detector state
             sideChainEnabled(c.sideChainEnabled),
             sideChainLastIn(c.sideChainLastIn)
@@ -80,6 +83,8 @@ namespace giml {
             this->knee_dB = c.knee_dB;
             this->aAttack = c.aAttack;
             this->aRelease = c.aRelease;
+            this->attackMillis = c.attackMillis;
+            this->releaseMillis = c.releaseMillis;
             this->detector = c.detector; // Assign detector state
             this->sideChainEnabled = c.sideChainEnabled;
             this->sideChainLastIn = c.sideChainLastIn;
@@ -109,6 +114,7 @@ namespace giml {
          * @return `in` with gain reduction applied
          */
         inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("Expander::processSample");
             if (!this->enabled) { return in; }
             if (this->sideChainEnabled) {
                 return in * compute(this->sideChainLastIn); // apply gain reduction
@@ -120,8 +126,9 @@ namespace giml {
          * @brief sets params threshold, ratio, knee, 
          * attack, and release
          */
-        void setParams(T thresh = 0.0, T ratio = 2.0, T knee = 1.0, 
-                       T attack = 3.5, T release = 100.0) {
+        void setParams(Scalar thresh = 0.0, Scalar ratio = 2.0, Scalar knee = 1.0, 
+                       Scalar attack = 3.5, Scalar release = 100.0) {
+            GIML_TRACE_SCOPE("Expander::setParams");
             this->setThresh(thresh);
             this->setRatio(ratio);
             this->setKnee(knee);
@@ -133,7 +140,7 @@ namespace giml {
          * @brief set threshold to trigger compression
          * @param threshdB threshold in dB
          */
-        void setThresh(T threshdB) {
+        void setThresh(Scalar threshdB) {
             this->thresh_dB = threshdB;
         }
 
@@ -141,8 +148,8 @@ namespace giml {
          * @brief set compression ratio
          * @param r ratio
          */
-        void setRatio(T r) {
-            r = std::max(r, T(1.0 + 1e-6)); // avoid div by zero / negative values
+        void setRatio(Scalar r) {
+            r = std::max(r, Scalar(1.0 + 1e-6)); // avoid div by zero / negative values
             this->ratio = r;
         }
         
@@ -150,8 +157,8 @@ namespace giml {
          * @brief set knee width
          * @param widthdB width value in dB
          */
-        void setKnee(T widthdB) {
-            widthdB = std::max(widthdB, T(1e-6)); // avoid div by zero / negative values
+        void setKnee(Scalar widthdB) {
+            widthdB = std::max(widthdB, Scalar(1e-6)); // avoid div by zero / negative values
             this->knee_dB = widthdB;
         }
 
@@ -159,9 +166,10 @@ namespace giml {
          * @brief set attack time 
          * @param attackMillis attack time in milliseconds 
          */
-        void setAttack(T attackMillis) { // calculated from Reiss et al. 2011 (Eq. 7)
-            attackMillis = std::max(attackMillis, T(1e-6)); // avoid div by zero / negative values
-            T timeS = attackMillis * 0.001; // convert to seconds
+        void setAttack(Scalar attackMillis) { // calculated from Reiss et al. 2011 (Eq. 7)
+            attackMillis = std::max(attackMillis, Scalar(1e-6)); // avoid div by zero / negative values
+            this->attackMillis = attackMillis;
+            Scalar timeS = attackMillis * 0.001; // convert to seconds
             constexpr float log109 = 0.9542425094393249f;
             this->aAttack = exp(-log109 / (timeS * this->sampleRate));
         }
@@ -170,12 +178,33 @@ namespace giml {
          * @brief set release time 
          * @param releaseMillis release time in milliseconds 
          */
-        void setRelease(T releaseMillis) { // //
-            releaseMillis = std::max(releaseMillis, T(1e-6)); // avoid div by zero / negative values
-            T timeS = releaseMillis * 0.001; // convert to seconds
+        void setRelease(Scalar releaseMillis) { // //
+            releaseMillis = std::max(releaseMillis, Scalar(1e-6)); // avoid div by zero / negative values
+            this->releaseMillis = releaseMillis;
+            Scalar timeS = releaseMillis * 0.001; // convert to seconds
             constexpr float log109 = 0.9542425094393249f;
             this->aRelease = exp(-log109 / (timeS * this->sampleRate));
         }
+
+        /**
+         * @brief the detector's release and attack stages in series, plus the side-chain's one sample
+         */
+        int getTailSamples() const override {
+            int release = decaySamples(this->aRelease), attack = decaySamples(this->aAttack);
+            return (release < 0 || attack < 0) ? -1 : release + attack + 1;
+        }
+
+        void reset() override {
+            this->detector.reset();
+            this->sideChainLastIn = 0;
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->setAttack(this->attackMillis);
+            this->setRelease(this->releaseMillis);
+            this->reset();
+        }
     };
 }
 #endif
\ No newline at end of file
@@ -8,8 +8,11 @@ namespace giml {
     template <typename T>
     class OnePole {
     private:
-        T g = 0.0;
-        T y_1 = 0.0; 
+        using Scalar = typename sample_traits<T>::scalar;
+        using Coeff = typename sample_traits<T>::coeff;
+        using State = typename sample_traits<T>::state;
+        Coeff g = 0.0;
+        State y_1 = 0.0; 
 
     public:
         // Default constructor and destructor 
@@ -35,8 +38,8 @@ namespace giml {
          * @return `in * (1-a) + y_1 * a`
          */
         inline T lpf(const T& in) {
-            this->y_1 = giml::linMix(in, y_1, g);
-            return y_1;
+            this->y_1 = State(in) * (1 - this->g) + this->y_1 * this->g; // `linMix()`, `g` is already in [0, 1]
+            return T(this->y_1);
         }
 
         /**
@@ -54,8 +57,9 @@ namespace giml {
          * @param Hz cutoff frequency in Hz
          * @param sampleRate project sample rate
          */
-        void setCutoff(const T& Hz, const T& sampleRate) {
-            T freq = giml::clip<T>(::abs(Hz), 0, sampleRate / 2);
+        void setCutoff(const Scalar& Hz, const Scalar& sampleRate) {
+            GIML_TRACE_SCOPE("OnePole::setCutoff");
+            Scalar freq = giml::clip<Scalar>(::abs(Hz), 0, sampleRate / 2);
             freq *= -M_2PI / sampleRate;
             this->g = ::pow(M_E, freq);
         }
@@ -64,10 +68,17 @@ namespace giml {
          * @brief set filter coefficient manually
          * @param gVal desired coefficient. 0 = bypass, 1 = sustain
          */
-        void setG(const T& gVal) {
-            this->g = giml::clip<T>(gVal, 0, 1);
+        void setG(const Scalar& gVal) {
+            this->g = giml::clip<Scalar>(gVal, 0, 1);
         }
 
+        /**
+         * @brief number of samples for the filter state to die out, -1 if `g == 1` (sustain)
+         */
+        int getTailSamples() const { return decaySamples(static_cast<Scalar>(this->g)); }
+
+        void reset() { this->y_1 = 0; }
+
     };
 
     /**
@@ -115,6 +126,8 @@ namespace giml {
             return this->hist;
         }
 
+        void reset() { this->hist = 0; }
+
     };
 
     /**
@@ -185,6 +198,7 @@ namespace giml {
          * @param sampleRate project sample rate
          */
         inline void setParams(const T& Hz, const T& Q, const T& sampleRate) {
+            GIML_TRACE_SAMPLE_SCOPE("SVF::setParams"); // called every sample by Phaser and EnvelopeFilter
             // frequency warping 
             T freq = giml::clip<T>(::abs(Hz), 0, sampleRate / 4);
             freq *= freqFactor;
@@ -217,6 +231,101 @@ namespace giml {
         inline T notch() const { return x_n - bp / q; }
         inline T allPass() const { return x_n - 2 * (bp / q); }
 
+        /**
+         * @brief Clears the filter state, keeps the coefficients
+         */
+        void reset() {
+            this->x_n = this->hp = this->bp = this->lp = 0;
+            this->trap1.reset();
+            this->trap2.reset();
+        }
+
+    };
+
+    /**
+     * @brief Polyphase IIR halfband lowpass for 2x decimation and interpolation.
+     * Two branches of first-order allpasses run at the low rate and average to a lowpass
+     * at a quarter of the high rate: flat to 0.2, 70 dB down from 0.3 of the high rate.
+     * An instance holds the state of one direction, use one to decimate and another to interpolate.
+     * See Valenzuela & Constantinides 1983 and L. de Soras' HIIR
+     */
+    template <typename T>
+    class Halfband {
+    private:
+        static constexpr int numSections = 4; // even sections on the first branch, odd ones on the second
+        static constexpr float coeffs[numSections] = {
+            0.079866426236357507f, 0.28382934487410993f, 0.54532365107113223f, 0.83441189148073791f
+        };
+        T x_1[numSections] = {}, y_1[numSections] = {};
+
+        // first-order allpass at the low rate: `y_0 = c * (x_0 - y_1) + x_1`
+        inline T allPass(int section, const T& in) {
+            T out = coeffs[section] * (in - this->y_1[section]) + this->x_1[section];
+            this->x_1[section] = in;
+            this->y_1[section] = out;
+            return out;
+        }
+
+    public:
+        // Default constructor and destructor
+        Halfband() {}
+        ~Halfband() {}
+
+        // Copy constructor
+        Halfband(const Halfband<T>& h) {
+            for (int i = 0; i < numSections; i++) {
+                this->x_1[i] = h.x_1[i];
+                this->y_1[i] = h.y_1[i];
+            }
+        }
+
+        // Copy assignment operator
+        Halfband<T>& operator=(const Halfband<T>& h) {
+            for (int i = 0; i < numSections; i++) {
+                this->x_1[i] = h.x_1[i];
+                this->y_1[i] = h.y_1[i];
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Lowpasses and drops every other sample
+         * @param in0 older input sample at the high rate
+         * @param in1 newer input sample at the high rate
+         * @return output sample at the low rate
+         */
+        inline T decimate(const T& in0, const T& in1) {
+            T branch0 = this->allPass(2, this->allPass(0, in1));
+            T branch1 = this->allPass(3, this->allPass(1, in0));
+            return (branch0 + branch1) * T(0.5);
+        }
+
+        /**
+         * @brief Produces two samples at the high rate from one at the low rate
+         * @param in input sample at the low rate
+         * @param out0 older output sample at the high rate
+         * @param out1 newer output sample at the high rate
+         */
+        inline void interpolate(const T& in, T& out0, T& out1) {
+            out0 = this->allPass(2, this->allPass(0, in));
+            out1 = this->allPass(3, this->allPass(1, in));
+        }
+
+        /**
+         * @brief samples at the low rate for the state to die out, the two allpasses of the slower branch in series
+         */
+        static int getTailSamples() {
+            int branches[2] = { 0, 0 };
+            for (int section = 0; section < numSections; section++) {
+                branches[section % 2] += decaySamples(coeffs[section], (1 + coeffs[section]) / (1 - coeffs[section]));
+            }
+            return std::max(branches[0], branches[1]);
+        }
+
+        void reset() {
+            for (int i = 0; i < numSections; i++) { this->x_1[i] = this->y_1[i] = 0; }
+        }
+
     };
 
 } // namespace giml
@@ -0,0 +1,230 @@
+#ifndef GIML_FIXED_HPP
+#define GIML_FIXED_HPP
+#include <stdint.h>
+#include <limits>
+#include <type_traits>
+
+namespace giml {
+    /**
+     * @brief Fixed-point number with `Frac` fractional bits in the signed integer `Storage`,
+     * for targets without a fast FPU. All arithmetic saturates instead of wrapping around.
+     *
+     * Multiplying two formats yields the left operand's format, so the operand order picks the headroom:
+     * `sample * coefficient` stays a sample, while `coefficient * sample` keeps the coefficient's integer bits
+     * (e.g. to sum a biquad's products before converting back to a sample once).
+     * Converting from floating-point and integer values is implicit and rounds to nearest,
+     * converting to floating-point or to another format is explicit.
+     * See `q15`, `q31`, `q3_28` and `q8_23`
+     * @tparam Storage `int16_t` or `int32_t`
+     * @tparam Frac number of fractional bits
+     */
+    template <typename Storage, int Frac>
+    class fixed {
+        static_assert(std::is_same<Storage, int16_t>::value || std::is_same<Storage, int32_t>::value,
+                      "giml::fixed stores int16_t or int32_t");
+        static_assert(Frac > 0 && Frac < 8 * (int)sizeof(Storage), "giml::fixed needs 1 to 15 (or 31) fractional bits");
+
+        // holds the sum or product of any two values
+        using Wide = typename std::conditional<sizeof(Storage) == 2, int32_t, int64_t>::type;
+        static constexpr Storage maxRaw = std::numeric_limits<Storage>::max();
+        static constexpr Storage minRaw = std::numeric_limits<Storage>::min();
+
+        Storage value; // uninitialized like a `float`, `fixed()` is 0
+
+        static constexpr Storage saturate(int64_t x) {
+            return (x > maxRaw) ? maxRaw : ((x < minRaw) ? minRaw : static_cast<Storage>(x));
+        }
+
+        // `x * 2^-bits`, rounded to nearest
+        static constexpr int64_t shift(int64_t x, int bits) {
+            return (bits > 0) ? ((x + (int64_t(1) << (bits - 1))) >> bits) : x * (int64_t(1) << -bits);
+        }
+
+        template <typename F>
+        static constexpr Storage fromFloat(F x) {
+            F scaled = x * F(int64_t(1) << Frac); // exact, a power of two
+            if (scaled != scaled) { return 0; } // NaN
+            if (scaled >= F(maxRaw)) { return maxRaw; }
+            if (scaled <= F(minRaw)) { return minRaw; }
+            return static_cast<Storage>(scaled + ((scaled < 0) ? F(-0.5) : F(0.5)));
+        }
+
+    public:
+        static constexpr int fracBits = Frac;
+        static constexpr int intBits = 8 * sizeof(Storage) - 1 - Frac;
+
+        fixed() = default;
+
+        template <typename F, typename std::enable_if<std::is_floating_point<F>::value, int>::type = 0>
+        constexpr fixed(F x) : value(fromFloat(x)) {}
+
+        template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+        constexpr fixed(I x) : value(
+            (x > I(maxRaw >> Frac)) ? maxRaw :
+            ((std::is_signed<I>::value && x < I(minRaw >> Frac)) ? minRaw : saturate(int64_t(x) * (int64_t(1) << Frac)))) {}
+
+        /**
+         * @brief converts from another format, rounding to nearest and saturating
+         */
+        template <typename S2, int F2>
+        explicit constexpr fixed(fixed<S2, F2> x) : value(saturate(shift(x.raw(), F2 - Frac))) {}
+
+        /**
+         * @brief wraps a raw integer, `raw * 2^-Frac`
+         */
+        static constexpr fixed fromRaw(Storage raw) {
+            fixed f{};
+            f.value = raw;
+            return f;
+        }
+
+        constexpr Storage raw() const { return this->value; }
+
+        explicit constexpr operator float() const { return this->value * (1.f / float(int64_t(1) << Frac)); }
+        explicit constexpr operator double() const { return this->value * (1.0 / double(int64_t(1) << Frac)); }
+
+        // Arithmetic
+        friend constexpr fixed operator+(fixed a, fixed b) { return fromRaw(saturate(Wide(a.value) + b.value)); }
+        friend constexpr fixed operator-(fixed a, fixed b) { return fromRaw(saturate(Wide(a.value) - b.value)); }
+        friend constexpr fixed operator-(fixed a) { return fromRaw(saturate(-Wide(a.value))); }
+        friend constexpr fixed operator*(fixed a, fixed b) { return fromRaw(saturate(shift(Wide(a.value) * b.value, Frac))); }
+
+        /**
+         * @brief product of two formats, in the left operand's format
+         */
+        template <typename S2, int F2>
+        friend constexpr fixed operator*(fixed a, fixed<S2, F2> b) {
+            return fromRaw(saturate(shift(int64_t(a.value) * b.raw(), F2)));
+        }
+
+        /**
+         * @brief quotient, saturated to the largest value of the right sign when `b == 0`
+         */
+        friend constexpr fixed operator/(fixed a, fixed b) {
+            if (b.value == 0) { return fromRaw((a.value < 0) ? minRaw : maxRaw); }
+            return fromRaw(saturate((int64_t(a.value) * (int64_t(1) << Frac)) / b.value));
+        }
+
+        fixed& operator+=(fixed b) { return *this = *this + b; }
+        fixed& operator-=(fixed b) { return *this = *this - b; }
+        fixed& operator*=(fixed b) { return *this = *this * b; }
+        fixed& operator/=(fixed b) { return *this = *this / b; }
+
+        // Comparison
+        friend constexpr bool operator==(fixed a, fixed b) { return a.value == b.value; }
+        friend constexpr bool operator!=(fixed a, fixed b) { return a.value != b.value; }
+        friend constexpr bool operator<(fixed a, fixed b) { return a.value < b.value; }
+        friend constexpr bool operator<=(fixed a, fixed b) { return a.value <= b.value; }
+        friend constexpr bool operator>(fixed a, fixed b) { return a.value > b.value; }
+        friend constexpr bool operator>=(fixed a, fixed b) { return a.value >= b.value; }
+
+        // Math, found through ADL
+        friend constexpr fixed abs(fixed a) { return (a.value < 0) ? -a : a; }
+        friend constexpr fixed min(fixed a, fixed b) { return (b.value < a.value) ? b : a; }
+        friend constexpr fixed max(fixed a, fixed b) { return (a.value < b.value) ? b : a; }
+
+        /**
+         * @brief integer square root, 0 for negative inputs
+         */
+        friend constexpr fixed sqrt(fixed a) {
+            if (a.value <= 0) { return fixed(); }
+            // sqrt(raw * 2^-Frac) = sqrt(raw * 2^Frac) * 2^-Frac
+            uint64_t x = uint64_t(a.value) << Frac, root = 0, bit = uint64_t(1) << 62;
+            while (bit > x) { bit >>= 2; }
+            while (bit) {
+                if (x >= root + bit) { x -= root + bit; root = (root >> 1) + bit; }
+                else { root >>= 1; }
+                bit >>= 2;
+            }
+            return fromRaw(saturate(int64_t(root)));
+        }
+    };
+
+    using q15 = fixed<int16_t, 15>; // 16-bit samples in [-1, 1)
+    using q31 = fixed<int32_t, 31>; // 32-bit samples in [-1, 1)
+    using q3_28 = fixed<int32_t, 28>; // coefficients and gains in [-8, 8)
+    using q8_23 = fixed<int32_t, 23>; // levels in dB, [-256, 256)
+
+    namespace detail {
+        // index of the highest set bit of `x > 0`
+        inline int highestBit(uint32_t x) {
+            int n = 0;
+            if (x >= (1u << 16)) { n += 16; x >>= 16; }
+            if (x >= (1u << 8)) { n += 8; x >>= 8; }
+            if (x >= (1u << 4)) { n += 4; x >>= 4; }
+            if (x >= (1u << 2)) { n += 2; x >>= 2; }
+            if (x >= (1u << 1)) { n += 1; }
+            return n;
+        }
+
+        // Horner's scheme in Q2.30, `f` in [0, 1)
+        template <size_t N>
+        inline int64_t polyQ30(const int64_t (&c)[N], int64_t f) {
+            int64_t p = c[N - 1];
+            for (size_t k = N - 1; k > 0; k--) { p = c[k - 1] + ((p * f) >> 30); }
+            return p;
+        }
+
+        /**
+         * @brief `log2(raw * 2^-frac)` for `raw > 0`, in Q8.23.
+         * Chebyshev fit of `log2(1 + f)`, error below 4e-7
+         */
+        inline q8_23 log2Fixed(uint32_t raw, int frac) {
+            static constexpr int64_t c[] = { 396, 1549031010, -773433485, 506899467, -345702224, 202671709, -81230045, 15505210 };
+            int n = highestBit(raw);
+            int64_t mantissa = (n >= 30) ? (raw >> (n - 30)) : (int64_t(raw) << (30 - n)); // [1, 2) in Q30
+            int64_t p = polyQ30(c, mantissa - (int64_t(1) << 30));
+            return q8_23::fromRaw(int32_t((int64_t(n - frac) << 23) + ((p + 64) >> 7)));
+        }
+
+        /**
+         * @brief `2^x`, in Q3.28 (saturates from `x >= 3`).
+         * Chebyshev fit of `2^f`, relative error below 1e-8
+         */
+        inline q3_28 exp2Fixed(q8_23 x) {
+            static constexpr int64_t c[] = { 1073741827, 744260852, 257945486, 59571873, 10398316, 1330509, 234782 };
+            int32_t n = x.raw() >> 23; // floor
+            if (n >= 3) { return q3_28::fromRaw(std::numeric_limits<int32_t>::max()); }
+            if (n < -30) { return q3_28(); }
+            int64_t p = polyQ30(c, int64_t(x.raw() & ((1 << 23) - 1)) << 7); // [1, 2) in Q30
+            int shift = 2 - n; // Q30 to Q28, times 2^n
+            return q3_28::fromRaw(int32_t((shift > 0) ? ((p + (int64_t(1) << (shift - 1))) >> shift) : p));
+        }
+    } // namespace detail
+
+    /**
+     * @brief `aTodB()` for fixed-point samples, integer-only
+     * @param ampVal input value in linear amplitude
+     * @return input value in dB, floored at -120 dB like the floating-point version
+     */
+    template <typename Storage, int Frac>
+    inline q8_23 aTodB(fixed<Storage, Frac> ampVal) {
+        constexpr int64_t floorRaw = (Frac >= 20) ? int64_t(1e-6 * (int64_t(1) << Frac) + 0.5) : 1; // at least 1 LSB
+        constexpr q3_28 dBPerOctave = 6.020599913279624; // 20 * log10(2)
+        int64_t raw = ampVal.raw();
+        raw = (raw < 0) ? -raw : raw; // rectify
+        raw = (raw < floorRaw) ? floorRaw : raw;
+        return detail::log2Fixed(uint32_t(raw), Frac) * dBPerOctave;
+    }
+
+    /**
+     * @brief `dBtoA()` for fixed-point levels, integer-only
+     * @param dBVal input value in dB
+     * @return input value in amplitude, saturated at +18 dB
+     */
+    inline q3_28 dBtoA(q8_23 dBVal) {
+        constexpr q3_28 octavesPerdB = 0.16609640474436813; // log2(10) / 20
+        return detail::exp2Fixed(dBVal * octavesPerdB);
+    }
+
+    /**
+     * @brief `biSigmoid()` for fixed-point samples, computed in `q3_28` for the headroom of `x^2 + 1`
+     */
+    template <typename Storage, int Frac>
+    inline fixed<Storage, Frac> biSigmoid(fixed<Storage, Frac> in) {
+        q3_28 x(in);
+        return fixed<Storage, Frac>(x / sqrt(x * x + 1));
+    }
+} // namespace giml
+
+#endif
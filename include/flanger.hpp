@@ -8,18 +8,29 @@ namespace giml {
      * @brief This class implements a basic flanger effect. 
      * 
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, see `sample_traits`
      * 
      * @todo experiment with feedback
      * 
+     * @tparam MaxSamples if non-zero, the delay line is stored inline in the object (`MaxSamples` long) 
+     * instead of on the heap, and longer maximum delays are clamped to it
      */
-    template <typename T>
+    template <typename T, size_t MaxSamples = 0>
     class Flanger : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
         int sampleRate;
-        T rate = 0.0, depth = 0.0, blend = 0.0;
-        giml::CircularBuffer<T> buffer;
-        giml::TriOsc<T> osc;
+        Scalar rate = 0.0, depth = 0.0, blend = 0.0, depthMillis = 5.0, maxDepthMillis = 10.0;
+        giml::CircularBuffer<T, T, MaxSamples> buffer;
+        giml::TriOsc<Scalar> osc; // one LFO shared by all lanes
+
+        // Reads the delay line at the LFO sample `lfo` and blends it with `in`
+        inline T modulate(const T& in, Scalar lfo) {
+            // y[n] = x[n] + x[depth + lfo * depth]
+            float readIndex = this->depth + lfo * this->depth;
+            return giml::powMix<T>(in, this->buffer.readSample(readIndex), this->blend); // return mix
+        }
 
     public:
         // Constructor
@@ -31,7 +42,7 @@ namespace giml {
          * 
          * See Effect Design Part II - Jon Dattorro 1997 Table 7 
          */
-        Flanger (int samprate, T maxDepthMillis = 10.0) : sampleRate(samprate), osc(samprate) {
+        Flanger (int samprate, Scalar maxDepthMillis = 10.0) : sampleRate(samprate), maxDepthMillis(maxDepthMillis), osc(samprate) {
             this->buffer.allocate(giml::millisToSamples(maxDepthMillis, samprate)); // max delay is 10ms
             this->setParams();
         }
@@ -40,23 +51,27 @@ namespace giml {
         ~Flanger() {}
 
         // Copy constructor
-        Flanger(const Flanger<T>& f) {
+        Flanger(const Flanger<T, MaxSamples>& f) : osc(f.osc) {
             this->enabled = f.enabled;
             this->sampleRate = f.sampleRate;
             this->rate = f.rate;
             this->depth = f.depth;
             this->blend = f.blend;
+            this->depthMillis = f.depthMillis;
+            this->maxDepthMillis = f.maxDepthMillis;
             this->buffer = f.buffer;
             this->osc = f.osc;
         }
 
         // Copy assignment operator 
-        Flanger<T>& operator=(const Flanger<T>& f) {
+        Flanger<T, MaxSamples>& operator=(const Flanger<T, MaxSamples>& f) {
             this->enabled = f.enabled;
             this->sampleRate = f.sampleRate;
             this->rate = f.rate;
             this->depth = f.depth;
             this->blend = f.blend;
+            this->depthMillis = f.depthMillis;
+            this->maxDepthMillis = f.maxDepthMillis;
             this->buffer = f.buffer;
             this->osc = f.osc;
             return *this;
@@ -70,20 +85,64 @@ namespace giml {
          * from current sample result in time-varying comb filtering
          */
         inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("Flanger::processSample");
             // bypass behavior
             this->buffer.writeSample(in);
             if (!this->enabled) { return in; }
+            return this->modulate(in, this->osc.processSample());
+        }
+
+        /**
+         * @brief Writes and returns sample from delay line, with the LFO supplied by the caller
+         * (e.g. one output of a `giml::OscillatorBank`) instead of `osc`
+         * @param in current sample
+         * @param lfo LFO sample, bipolar as `giml::TriOsc` outputs
+         * @return `in` blended with past input
+         */
+        inline T processSample(const T& in, Scalar lfo) {
+            GIML_TRACE_SAMPLE_SCOPE("Flanger::processSample");
+            this->buffer.writeSample(in);
+            if (!this->enabled) { return in; }
+            return this->modulate(in, lfo);
+        }
+
+        /**
+         * @brief Processes a block in place, generating the LFO a chunk at a time with `TriOsc::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples) override {
+            GIML_TRACE_SCOPE("Flanger::processBlock");
+            if (!this->enabled) {
+                for (size_t i = 0; i < numSamples; i++) { this->buffer.writeSample(buffer[i]); }
+                return;
+            }
+            Scalar lfo[detail::lfoBlockSize];
+            for (size_t offset = 0; offset < numSamples; offset += detail::lfoBlockSize) {
+                size_t n = std::min(detail::lfoBlockSize, numSamples - offset);
+                this->osc.processBlock(lfo, n);
+                this->processBlock(buffer + offset, n, lfo);
+            }
+        }
 
-            // y[n] = x[n] + x[depth + osc_n * depth]
-            float readIndex = this->depth + this->osc.processSample() * this->depth;
-            T output = this->buffer.readSample(readIndex);
-            return giml::powMix<T>(in, output, this->blend); // return mix
+        /**
+         * @brief Processes a block in place, with the LFO supplied by the caller instead of `osc`
+         * @param lfo LFO samples, bipolar as `giml::TriOsc` outputs
+         * @param lfoStride distance between consecutive LFO samples, e.g. `N` to read one oscillator
+         * of `giml::OscillatorBank<Scalar, N>::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples, const Scalar* lfo, size_t lfoStride = 1) {
+            GIML_TRACE_SCOPE("Flanger::processBlock");
+            for (size_t i = 0; i < numSamples; i++) {
+                T in = buffer[i];
+                this->buffer.writeSample(in);
+                if (this->enabled) { buffer[i] = this->modulate(in, lfo[i * lfoStride]); }
+            }
         }
 
         /**
          * @brief sets params rate, depth, feedback and blend
          */
-        void setParams(T rate = 0.20, T depth = 5.0, T blend = 0.5) {
+        void setParams(Scalar rate = 0.20, Scalar depth = 5.0, Scalar blend = 0.5) {
+            GIML_TRACE_SCOPE("Flanger::setParams");
             this->setRate(rate);
             this->setDepth(depth);
             this->setBlend(blend);
@@ -93,7 +152,7 @@ namespace giml {
          * @brief Set modulation rate- the frequency of the LFO.  
          * @param freq frequency in Hz 
          */
-        void setRate(T freq) { 
+        void setRate(Scalar freq) { 
           this->osc.setFrequency(freq); 
         }
 
@@ -102,7 +161,8 @@ namespace giml {
          * @param d depth in milliseconds
          * @todo test for stability
          */
-        void setDepth(T d) {
+        void setDepth(Scalar d) {
+            this->depthMillis = d;
             d = giml::millisToSamples(d, this->sampleRate);
             if (2.0 * d > this->buffer.size()) { // clamp
                 d = giml::samplesToMillis(this->buffer.size(), this->sampleRate) * 0.5;
@@ -114,10 +174,22 @@ namespace giml {
          * @brief Set blend 
          * @param b ratio of wet to dry (clamped to [0,1])
          */
-        void setBlend(T b) { 
-            this->blend = giml::clip<T>(b, 0.f, 1.f);
+        void setBlend(Scalar b) { 
+            this->blend = giml::clip<Scalar>(b, 0.f, 1.f);
         }
 
+        void reset() override {
+            this->buffer.clear();
+            this->osc.setPhase(0);
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->buffer.allocate(giml::millisToSamples(this->maxDepthMillis, sampleRate));
+            this->setDepth(this->depthMillis); // `depth` is stored in samples
+            this->osc.setSampleRate(sampleRate);
+            this->reset();
+        }
     };
 } // namespace giml
 #endif
\ No newline at end of file
@@ -3,13 +3,18 @@
 #include "compressor.hpp"
 #include "delay.hpp"
 #include "detune.hpp"
+#include "earlyreflections.hpp"
 #include "envelope.hpp"
 #include "expander.hpp"
 #include "filter.hpp"
+#include "fixed.hpp"
 #include "flanger.hpp"
 #include "oscillator.hpp"
 #include "phaser.hpp"
 #include "reverb.hpp"
 #include "saturation.hpp"
+#include "simd.hpp"
+#include "storage.hpp"
+#include "trace.hpp"
 #include "tremolo.hpp"
 #include "utility.hpp"
\ No newline at end of file
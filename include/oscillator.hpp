@@ -1,17 +1,102 @@
 #ifndef GIML_OSCILLATOR_HPP
 #define GIML_OSCILLATOR_HPP
 #include "utility.hpp"
+#include "simd.hpp"
 namespace giml {
+    namespace detail {
+        /**
+         * @brief LFO samples that the effects' `processBlock()` generate at once, in a buffer on the stack
+         */
+        constexpr size_t lfoBlockSize = 64;
+
+        /**
+         * @brief Fixed-point phase (`2^32` is a full cycle) to `[0, 1)`, exactly: a `float` keeps the top 24 bits,
+         * so it never rounds up to 1
+         */
+        template <typename T>
+        inline T phaseToUnit(uint32_t ph) {
+            if constexpr (std::is_same<T, float>::value) { return (float)(ph >> 8) * (1.f / 16777216.f); }
+            else { return (T)ph * T(1.0 / 4294967296.0); }
+        }
+
+        /**
+         * @brief Any phase in cycles to fixed point, wrapped
+         */
+        inline uint32_t unitToPhase(double ph) {
+            ph -= ::floor(ph);
+            return (uint32_t)(uint64_t)::llround(ph * 4294967296.0); // a full cycle rounds to 2^32, which wraps to 0
+        }
+
+        /**
+         * @brief Band-limited single-cycle tables shared by every `giml::WavetableOsc`, built once on first use
+         * (about 270 kB, static). Level `l` of a shape holds its harmonics up to `(wavetableSize / 2) >> l`
+         * (1023 at level 0, a sine at the last level), each table followed by a guard sample
+         */
+        constexpr size_t wavetableBits = 11, wavetableSize = 1 << wavetableBits, wavetableLevels = wavetableBits;
+
+        struct Wavetables {
+            static constexpr size_t numShapes = 3; // saw, square, triangle
+            float data[numShapes][wavetableLevels][wavetableSize + 1];
+
+            Wavetables() {
+                double* sine = (double*)GIML_MALLOC(wavetableSize * sizeof(double)); // harmonic `h` of sample `j` is `sine[h * j % size]`
+                double* sum = (double*)GIML_MALLOC(wavetableSize * sizeof(double));
+                for (size_t j = 0; j < wavetableSize; j++) { sine[j] = ::sin(M_2PI * j / wavetableSize); }
+                for (size_t shape = 0; shape < numShapes; shape++) {
+                    for (size_t level = 0; level < wavetableLevels; level++) {
+                        size_t numHarmonics = std::min((wavetableSize / 2) >> level, wavetableSize / 2 - 1);
+                        for (size_t j = 0; j < wavetableSize; j++) { sum[j] = 0.0; }
+                        for (size_t h = 1; h <= numHarmonics; h++) {
+                            double gain = 0.0;
+                            size_t quarter = 0; // `wavetableSize / 4` for a cosine
+                            if (shape == 0) { gain = -2.0 / (M_PI * h); } // rising saw, `2 * phase - 1`
+                            else if (h % 2 == 1 && shape == 1) { gain = 4.0 / (M_PI * h); } // square, high first
+                            else if (h % 2 == 1) { gain = 8.0 / (M_PI * M_PI * h * h); quarter = wavetableSize / 4; } // triangle as `giml::TriOsc`
+                            if (gain == 0.0) { continue; }
+                            for (size_t j = 0; j < wavetableSize; j++) { sum[j] += gain * sine[(h * j + quarter) & (wavetableSize - 1)]; }
+                        }
+                        float* table = this->data[shape][level];
+                        for (size_t j = 0; j < wavetableSize; j++) { table[j] = (float)sum[j]; }
+                        table[wavetableSize] = table[0];
+                    }
+                }
+                GIML_FREE(sine);
+                GIML_FREE(sum);
+            }
+        };
+
+        inline const Wavetables& wavetables() {
+            static const Wavetables tables;
+            return tables;
+        }
+    } // namespace detail
+
     /**
      * @brief Phase Accumulator / Unipolar Saw Oscillator.
      * Can be used as a control signal and/or waveshaped into other waveforms. 
-     * Will cause aliasing if sonified 
+     * Will cause aliasing if sonified, see `giml::WavetableOsc` for audio rate
+     *
+     * `processBlock()` generates a block at once: with `float`, the phase ramp is computed in SIMD vectors
+     * (`simd::kernels()`) from a `double` phase, so it does not drift with the block length.
+     * Its samples may differ from `processSample()`'s accumulated phase in the last bits
+     *
+     * @tparam T sample type of the output
+     * @tparam PhaseT type of the phase accumulator. `T` accumulates the phase in floating point.
+     * `uint32_t` accumulates it in fixed point (`2^32` is a full cycle): the increment is exact, wrapping is the integer
+     * overflow, and the phase is converted to `T` only when read, so it never drifts and the output is bit-reproducible
+     * however long it runs and however it is split into blocks. The frequency is quantized to `sampleRate / 2^32`,
+     * and negative frequencies run the phase backwards instead of returning `1 - phase`
      */
-    template <typename T>
+    template <typename T, typename PhaseT = T>
     class Phasor {
+        static_assert(std::is_same<PhaseT, T>::value || std::is_same<PhaseT, uint32_t>::value,
+                      "Phasor accumulates the phase in T or in uint32_t");
     protected:
+        static constexpr bool integerPhase = std::is_same<PhaseT, uint32_t>::value;
         int sampleRate;
-        T phase = 0.0, frequency = 0.0, phaseIncrement = 0.0;
+        PhaseT phase = 0, phaseIncrement = 0;
+        T frequency = 0.0;
+        T outputSign = 1, outputOffset = 0; // `1 - phase` for negative frequencies, without a branch per sample
 
     public:
         // Constructor
@@ -22,51 +107,127 @@ namespace giml {
         ~Phasor() {}
 
         // Copy constructor
-        Phasor(const Phasor<T>& c) {
+        Phasor(const Phasor<T, PhaseT>& c) {
             this->sampleRate = c.sampleRate;
             this->phase = c.phase;
             this->frequency = c.frequency;
             this->phaseIncrement = c.phaseIncrement;
+            this->outputSign = c.outputSign;
+            this->outputOffset = c.outputOffset;
         }
 
         // Copy assignment operator
-        Phasor<T>& operator=(const Phasor<T>& c) {
+        Phasor<T, PhaseT>& operator=(const Phasor<T, PhaseT>& c) {
             this->sampleRate = c.sampleRate;
             this->phase = c.phase;
             this->frequency = c.frequency;
             this->phaseIncrement = c.phaseIncrement;
+            this->outputSign = c.outputSign;
+            this->outputOffset = c.outputOffset;
             return *this;
         }
 
         /**
          * @brief Increments and returns `phase` 
          * @return `phase` (after increment)
-         * @todo replace wrapping with `phase -= std::floor(phase)`
          */
-        virtual T processSample() {
-            this->phase += this->phaseIncrement; // increment phase
-            if (this->phase >= 1) { this->phase -= 1; } // if waveform zenith, wrap phase
-            if (this->frequency < 0) { // if negative frequency...
-                return 1.f - this->phase; // return reverse phasor
-            } else { return this->phase; } // return phasor
+        inline T processSample() {
+            if constexpr (integerPhase) {
+                this->phase += this->phaseIncrement; // wraps on overflow
+                return detail::phaseToUnit<T>(this->phase);
+            }
+            else {
+                this->phase += this->phaseIncrement; // increment phase
+                if (this->phase >= 1) { this->phase -= 1; } // if waveform zenith, wrap phase
+                return this->outputOffset + this->outputSign * this->phase; // phasor, or reverse phasor if negative frequency
+            }
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of the phasor, as many calls to `processSample()` would
+         * (exactly, with a `uint32_t` phase)
+         * @param out output buffer
+         * @param numSamples number of samples to generate
+         */
+        void processBlock(T* out, size_t numSamples) {
+            GIML_TRACE_SCOPE("Phasor::processBlock");
+            if constexpr (integerPhase) {
+                uint32_t phase = this->phase, increment = this->phaseIncrement;
+                for (size_t i = 0; i < numSamples; i++) { out[i] = detail::phaseToUnit<T>(phase + (uint32_t)(i + 1) * increment); }
+                this->phase = phase + (uint32_t)numSamples * increment;
+            }
+            else if constexpr (std::is_same<T, float>::value) {
+                double phase = this->phase, increment = this->phaseIncrement;
+                simd::kernels().phasor(out, numSamples, phase, increment);
+                double end = phase + numSamples * increment;
+                this->phase = (T)(end - ::floor(end));
+                if (this->frequency < 0) {
+                    for (size_t i = 0; i < numSamples; i++) { out[i] = 1 - out[i]; }
+                }
+            }
+            else {
+                for (size_t i = 0; i < numSamples; i++) { out[i] = this->processSample(); }
+            }
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of a single-cycle waveform, read from `table` at the phase of the phasor
+         * (linearly interpolated), so an arbitrary LFO shape costs a table lookup per sample.
+         * With a `uint32_t` phase, the table index and interpolation weight come straight from its bits
+         * @param out output buffer
+         * @param numSamples number of samples to generate
+         * @param table one cycle of `tableSize` samples, followed by a guard sample `table[tableSize] == table[0]`
+         * @param tableSize samples in the cycle
+         */
+        void processBlock(T* out, size_t numSamples, const float* table, size_t tableSize) {
+            GIML_TRACE_SCOPE("Phasor::processBlock");
+            if constexpr (integerPhase) {
+                uint32_t phase = this->phase, increment = this->phaseIncrement;
+                for (size_t i = 0; i < numSamples; i++) {
+                    uint64_t position = (uint64_t)(phase + (uint32_t)(i + 1) * increment) * tableSize; // index.frac in 32.32
+                    size_t index = (size_t)(position >> 32);
+                    T frac = detail::phaseToUnit<T>((uint32_t)position);
+                    out[i] = table[index] + frac * (table[index + 1] - table[index]);
+                }
+                this->phase = phase + (uint32_t)numSamples * increment;
+                return;
+            }
+            this->processBlock(out, numSamples);
+            if constexpr (std::is_same<T, float>::value) {
+                simd::kernels().wavetable(out, numSamples, table, tableSize);
+            }
+            else {
+                for (size_t i = 0; i < numSamples; i++) {
+                    T position = (out[i] - ::floor(out[i])) * tableSize;
+                    size_t index = std::min((size_t)position, tableSize - 1);
+                    T frac = position - index;
+                    out[i] = table[index] + frac * (table[index + 1] - table[index]);
+                }
+            }
         }
 
         /**
          * @brief Sets the oscillator's sample rate 
          * @param sampRate sample rate of your project
          */
-        virtual void setSampleRate(int sampRate) {
+        void setSampleRate(int sampRate) {
             this->sampleRate = sampRate;
-            this->phaseIncrement = this->frequency / static_cast<T>(this->sampleRate);
+            this->setFrequency(this->frequency);
         }
 
         /**
          * @brief Sets the oscillator's frequency
          * @param freqHz frequency in hertz (cycles per second)
          */
-        virtual void setFrequency(T freqHz) {
+        void setFrequency(T freqHz) {
             this->frequency = freqHz;
+            if constexpr (integerPhase) {
+                this->phaseIncrement = detail::unitToPhase((double)freqHz / this->sampleRate); // a negative increment wraps backwards
+                return;
+            }
             this->phaseIncrement = ::abs(this->frequency) / static_cast<T>(this->sampleRate);
+            this->outputSign = (this->frequency < 0) ? -1 : 1;
+            this->outputOffset = (this->frequency < 0) ? 1 : 0;
         }
 
         /**
@@ -74,8 +235,9 @@ namespace giml {
          * @param ph User-defined phase. 
          * Will be wrapped to the range `[0,1]` by `processSample()` 
          */
-        virtual void setPhase(T ph) { // set phase manually 
-            this->phase = ph;
+        void setPhase(T ph) { // set phase manually 
+            if constexpr (integerPhase) { this->phase = detail::unitToPhase((double)ph); }
+            else { this->phase = ph; }
         }
         
         /**
@@ -83,33 +245,34 @@ namespace giml {
          * If `frequency` is negative, returns `1 - phase`
          * @return `phase` 
          */
-        virtual T getPhase() {
-            if (this->frequency < 0) { // if negative frequency...
-                return 1 - this->phase; // return reverse phasor
-            } else { return this->phase; } // return phasor
+        T getPhase() const {
+            if constexpr (integerPhase) { return detail::phaseToUnit<T>(this->phase); }
+            else { return this->outputOffset + this->outputSign * this->phase; } // reverse phasor if negative frequency
         }
     };
 
     /**
      * @brief Bipolar Sine Oscillator that inherits from `giml::Phasor`,
-     * waveshaped with `std::sin`
+     * waveshaped with `std::sin`.
+     * With `float`, `processBlock()` evaluates a polynomial sine in SIMD vectors instead (error below 5e-7).
+     * `PhaseT = uint32_t` accumulates the phase in fixed point (see `giml::Phasor`)
      */
-    template <typename T>
-    class SinOsc : public Phasor<T> {
+    template <typename T, typename PhaseT = T>
+    class SinOsc : public Phasor<T, PhaseT> {
     public:
         // Constructor
         SinOsc() = delete;
-        SinOsc(int sampRate) : Phasor<T>(sampRate) {}
+        SinOsc(int sampRate) : Phasor<T, PhaseT>(sampRate) {}
 
         // Destructor
         ~SinOsc() {}
 
         // Copy constructor
-        SinOsc(const SinOsc<T>& s) : Phasor<T>(s) {}
+        SinOsc(const SinOsc<T, PhaseT>& s) : Phasor<T, PhaseT>(s) {}
 
         // Copy assignment operator 
-        SinOsc<T>& operator=(const SinOsc<T>& s) {
-            Phasor<T>::operator=(s);
+        SinOsc<T, PhaseT>& operator=(const SinOsc<T, PhaseT>& s) {
+            Phasor<T, PhaseT>::operator=(s);
             return *this;
         }
         
@@ -117,31 +280,48 @@ namespace giml {
          * @brief Increments and returns `phase` 
          * @return `sin(2pi * phase)` (after increment)
          */
-        T processSample() override {
-            return sin(M_2PI * Phasor<T>::processSample());
+        inline T processSample() {
+            return sin(M_2PI * Phasor<T, PhaseT>::processSample());
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of the sine
+         * @param out output buffer
+         * @param numSamples number of samples to generate
+         */
+        void processBlock(T* out, size_t numSamples) {
+            GIML_TRACE_SCOPE("SinOsc::processBlock");
+            if constexpr (std::is_same<T, float>::value) {
+                Phasor<T, PhaseT>::processBlock(out, numSamples);
+                simd::kernels().sine(out, numSamples);
+            }
+            else {
+                for (size_t i = 0; i < numSamples; i++) { out[i] = this->processSample(); }
+            }
         }
     };
 
     /**
      * @brief Bipolar Ideal Triangle Oscillator that inherits from `giml::Phasor`
-     * Best used as a control signal, will cause aliasing if sonified 
+     * Best used as a control signal, will cause aliasing if sonified (see `giml::WavetableOsc` for audio rate).
+     * `PhaseT = uint32_t` accumulates the phase in fixed point (see `giml::Phasor`)
      */
-    template <typename T>
-    class TriOsc : public Phasor<T> {
+    template <typename T, typename PhaseT = T>
+    class TriOsc : public Phasor<T, PhaseT> {
     public:
         // Constructor
         TriOsc() = delete;
-        TriOsc(int sampRate) : Phasor<T>(sampRate) {}
+        TriOsc(int sampRate) : Phasor<T, PhaseT>(sampRate) {}
 
         // Destructor
         ~TriOsc() {}
 
         // Copy constructor
-        TriOsc(const TriOsc<T>& t) : Phasor<T>(t) {}
+        TriOsc(const TriOsc<T, PhaseT>& t) : Phasor<T, PhaseT>(t) {}
 
         // Copy assignment operator 
-        TriOsc<T>& operator=(const TriOsc<T>& t) {
-            Phasor<T>::operator=(t);
+        TriOsc<T, PhaseT>& operator=(const TriOsc<T, PhaseT>& t) {
+            Phasor<T, PhaseT>::operator=(t);
             return *this;
         }
 
@@ -149,9 +329,478 @@ namespace giml {
          * @brief Increments and returns `phase` 
          * @return Waveshaped `phase` (after increment)
          */
-        T processSample() override {
-            return ::abs(Phasor<T>::processSample() * 2 - 1) * 2 - 1;
+        inline T processSample() {
+            return ::abs(Phasor<T, PhaseT>::processSample() * 2 - 1) * 2 - 1;
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of the triangle
+         * @param out output buffer
+         * @param numSamples number of samples to generate
+         */
+        void processBlock(T* out, size_t numSamples) {
+            GIML_TRACE_SCOPE("TriOsc::processBlock");
+            Phasor<T, PhaseT>::processBlock(out, numSamples);
+            for (size_t i = 0; i < numSamples; i++) { out[i] = ::abs(out[i] * 2 - 1) * 2 - 1; }
+        }
+    };
+
+    /**
+     * @brief Quadrature Sine/Cosine Oscillator: rotates the point `(cos, sin)` by the phase increment every sample
+     * (coupled-form recurrence, two multiplies and two multiply-adds), so both outputs cost less than one `std::sin`.
+     * Rounding makes the rotation drift in amplitude and phase, so the amplitude is renormalized every
+     * `renormInterval` samples and the point is resynced to an exact `double` phase every `resyncInterval` samples:
+     * with `float`, the error stays within about 1e-5 however long it runs
+     */
+    template <typename T>
+    class QuadOsc {
+    private:
+        static constexpr int renormInterval = 16, resyncInterval = 1024;
+        int sampleRate;
+        T frequency = 0.0;
+        T cosine = 1.0, sine = 0.0; // current point
+        T cosIncrement = 1.0, sinIncrement = 0.0; // rotation per sample
+        double phase = 0.0, phaseIncrement = 0.0; // in cycles, `phase` as of the last resync
+        int count = 0; // samples since the last resync
+
+        // Sets the point from the exact phase
+        void resync() {
+            this->phase -= ::floor(this->phase);
+            this->cosine = (T)::cos(M_2PI * this->phase);
+            this->sine = (T)::sin(M_2PI * this->phase);
+            this->count = 0;
+        }
+
+    public:
+        // Constructor
+        QuadOsc() = delete;
+        QuadOsc(int sampRate) : sampleRate(sampRate) {}
+
+        // Destructor
+        ~QuadOsc() {}
+
+        // Copy constructor
+        QuadOsc(const QuadOsc<T>& q) { *this = q; }
+
+        // Copy assignment operator
+        QuadOsc<T>& operator=(const QuadOsc<T>& q) {
+            this->sampleRate = q.sampleRate;
+            this->frequency = q.frequency;
+            this->cosine = q.cosine;
+            this->sine = q.sine;
+            this->cosIncrement = q.cosIncrement;
+            this->sinIncrement = q.sinIncrement;
+            this->phase = q.phase;
+            this->phaseIncrement = q.phaseIncrement;
+            this->count = q.count;
+            return *this;
+        }
+
+        /**
+         * @brief Advances the phase, see `getSin()` and `getCos()` for both outputs
+         * @return `sin(2pi * phase)` (after increment)
+         */
+        inline T processSample() {
+            T c = this->cosine * this->cosIncrement - this->sine * this->sinIncrement;
+            this->sine = this->sine * this->cosIncrement + this->cosine * this->sinIncrement;
+            this->cosine = c;
+            if ((++this->count % renormInterval) == 0) {
+                if (this->count == resyncInterval) {
+                    this->phase += resyncInterval * this->phaseIncrement;
+                    this->resync();
+                }
+                else { // one Newton step towards `cos^2 + sin^2 = 1`, no square root
+                    T gain = T(1.5) - T(0.5) * (this->cosine * this->cosine + this->sine * this->sine);
+                    this->cosine *= gain;
+                    this->sine *= gain;
+                }
+            }
+            return this->sine;
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of both outputs
+         * @param sinOut sine output buffer
+         * @param cosOut cosine output buffer
+         * @param numSamples number of samples to generate
+         */
+        void processBlock(T* sinOut, T* cosOut, size_t numSamples) {
+            GIML_TRACE_SCOPE("QuadOsc::processBlock");
+            for (size_t i = 0; i < numSamples; i++) {
+                sinOut[i] = this->processSample();
+                cosOut[i] = this->cosine;
+            }
         }
+
+        inline T getSin() const { return this->sine; }
+        inline T getCos() const { return this->cosine; }
+
+        /**
+         * @brief Sets the oscillator's sample rate 
+         * @param sampRate sample rate of your project
+         */
+        void setSampleRate(int sampRate) {
+            this->sampleRate = sampRate;
+            this->setFrequency(this->frequency);
+        }
+
+        /**
+         * @brief Sets the oscillator's frequency, keeping the current phase
+         * @param freqHz frequency in hertz (cycles per second), negative to run backwards
+         */
+        void setFrequency(T freqHz) {
+            this->phase += this->count * this->phaseIncrement;
+            this->count = 0;
+            this->frequency = freqHz;
+            this->phaseIncrement = (double)freqHz / this->sampleRate;
+            this->cosIncrement = (T)::cos(M_2PI * this->phaseIncrement);
+            this->sinIncrement = (T)::sin(M_2PI * this->phaseIncrement);
+        }
+
+        /**
+         * @brief Sets the phase, in cycles (`1` is a full turn)
+         * @param ph phase in cycles, wrapped to `[0, 1)`
+         */
+        void setPhase(double ph) {
+            this->phase = ph;
+            this->resync();
+        }
+
+        /**
+         * @brief Returns the phase in cycles without incrementing
+         */
+        double getPhase() const {
+            double ph = this->phase + this->count * this->phaseIncrement;
+            return ph - ::floor(ph);
+        }
+    };
+
+    /**
+     * @brief A bank of `N` LFOs advanced together. Phases, increments and shapes are stored as arrays (structure of arrays),
+     * so a tick updates all `N` in loops the compiler vectorizes, and the sines of a `float` bank are evaluated in SIMD
+     * vectors (`simd::kernels()`). Phases are fixed point as in `giml::Phasor<T, uint32_t>`, so the bank can also be
+     * advanced a whole control block at once with `processTick()`, exactly.
+     * Each output follows the oscillator of its shape, so it can drive the `processSample(in, lfo)` and
+     * `processBlock(buffer, numSamples, lfo, lfoStride)` overloads of `Chorus`, `Flanger`, `Tremolo` and `Phaser`
+     * instead of the oscillator each of them owns
+     * @tparam T sample type of the outputs
+     * @tparam N number of oscillators
+     */
+    template <typename T, size_t N>
+    class OscillatorBank {
+    public:
+        /**
+         * @brief Waveform of one oscillator
+         */
+        enum class Shape {
+            Saw,      // unipolar ramp in `[0, 1)`, as `giml::Phasor`
+            Triangle, // bipolar, as `giml::TriOsc`
+            Sine      // bipolar, as `giml::SinOsc::processBlock()`
+        };
+
+    private:
+        int sampleRate;
+        alignas(64) uint32_t phase[N] = {}, phaseIncrement[N] = {};
+        alignas(64) T sawGain[N] = {}, triangleGain[N] = {}, sineGain[N] = {}; // one-hot, to mix shapes without a branch per lane
+        alignas(64) T output[N] = {};
+        T frequency[N] = {};
+        Shape shape[N] = {};
+        size_t numSines = 0;
+
+        static constexpr size_t maxChunk = 1024; // samples shaped at once by `processBlock()`, on the stack
+        static constexpr size_t framesPerChunk = (N < maxChunk) ? maxChunk / N : 1;
+
+        // Shapes `numFrames` frames of ramps in place
+        void shapeFrames(T* x, size_t numFrames) const {
+            size_t n = numFrames * N;
+            alignas(64) T sine[framesPerChunk * N];
+            for (size_t j = 0; j < n; j++) { sine[j] = x[j]; }
+            if (this->numSines > 0) {
+                if constexpr (std::is_same<T, float>::value) { simd::kernels().sine(sine, n); }
+                else { for (size_t j = 0; j < n; j++) { sine[j] = ::sin(M_2PI * sine[j]); } }
+            }
+            for (size_t i = 0; i < numFrames; i++) {
+                T* frame = x + i * N;
+                const T* sines = sine + i * N;
+                for (size_t k = 0; k < N; k++) {
+                    T triangle = ::abs(frame[k] * 2 - 1) * 2 - 1;
+                    frame[k] = this->sawGain[k] * frame[k] + this->triangleGain[k] * triangle + this->sineGain[k] * sines[k];
+                }
+            }
+        }
+
+    public:
+        // Constructor
+        OscillatorBank() = delete;
+        OscillatorBank(int sampRate) : sampleRate(sampRate) {
+            for (size_t k = 0; k < N; k++) { this->setShape(k, Shape::Sine); }
+        }
+
+        // Destructor
+        ~OscillatorBank() {}
+
+        // Copy constructor
+        OscillatorBank(const OscillatorBank<T, N>& b) { *this = b; }
+
+        // Copy assignment operator
+        OscillatorBank<T, N>& operator=(const OscillatorBank<T, N>& b) {
+            this->sampleRate = b.sampleRate;
+            for (size_t k = 0; k < N; k++) {
+                this->phase[k] = b.phase[k];
+                this->phaseIncrement[k] = b.phaseIncrement[k];
+                this->sawGain[k] = b.sawGain[k];
+                this->triangleGain[k] = b.triangleGain[k];
+                this->sineGain[k] = b.sineGain[k];
+                this->output[k] = b.output[k];
+                this->frequency[k] = b.frequency[k];
+                this->shape[k] = b.shape[k];
+            }
+            this->numSines = b.numSines;
+            return *this;
+        }
+
+        /**
+         * @brief Advances every oscillator by one sample
+         * @return the `N` outputs (after increment)
+         */
+        inline const T* processSample() {
+            return this->processTick(1);
+        }
+
+        /**
+         * @brief Advances every oscillator by a control tick of `numSamples` samples, in one step
+         * @return the `N` outputs (after increment)
+         */
+        const T* processTick(size_t numSamples) {
+            for (size_t k = 0; k < N; k++) {
+                this->phase[k] += (uint32_t)numSamples * this->phaseIncrement[k];
+                this->output[k] = detail::phaseToUnit<T>(this->phase[k]);
+            }
+            this->shapeFrames(this->output, 1);
+            return this->output;
+        }
+
+        /**
+         * @brief Generates `numSamples` frames of the `N` outputs, as many calls to `processSample()` would
+         * @param out output buffer of `numSamples * N` samples, frame by frame: oscillator `k` of frame `i` is `out[i * N + k]`
+         * @param numSamples number of frames to generate
+         */
+        void processBlock(T* out, size_t numSamples) {
+            GIML_TRACE_SCOPE("OscillatorBank::processBlock");
+            for (size_t offset = 0; offset < numSamples; offset += framesPerChunk) {
+                size_t n = std::min(framesPerChunk, numSamples - offset);
+                T* chunk = out + offset * N;
+                for (size_t i = 0; i < n; i++) { // from the phases at the start of the chunk, not accumulated per frame
+                    for (size_t k = 0; k < N; k++) {
+                        chunk[i * N + k] = detail::phaseToUnit<T>(this->phase[k] + (uint32_t)(i + 1) * this->phaseIncrement[k]);
+                    }
+                }
+                for (size_t k = 0; k < N; k++) { this->phase[k] += (uint32_t)n * this->phaseIncrement[k]; }
+                this->shapeFrames(chunk, n);
+            }
+            for (size_t k = 0; k < N && numSamples > 0; k++) { this->output[k] = out[(numSamples - 1) * N + k]; }
+        }
+
+        /**
+         * @brief Returns the output of oscillator `k` as of the last tick
+         */
+        T getOutput(size_t k) const { return this->output[k]; }
+
+        /**
+         * @brief Sets the oscillators' sample rate 
+         * @param sampRate sample rate of your project
+         */
+        void setSampleRate(int sampRate) {
+            this->sampleRate = sampRate;
+            for (size_t k = 0; k < N; k++) { this->setFrequency(k, this->frequency[k]); }
+        }
+
+        /**
+         * @brief Sets the frequency of oscillator `k`, keeping its phase
+         * @param freqHz frequency in hertz (cycles per second), negative to run backwards
+         */
+        void setFrequency(size_t k, T freqHz) {
+            this->frequency[k] = freqHz;
+            this->phaseIncrement[k] = detail::unitToPhase((double)freqHz / this->sampleRate);
+        }
+
+        /**
+         * @brief Sets the waveform of oscillator `k`
+         */
+        void setShape(size_t k, Shape s) {
+            this->shape[k] = s;
+            this->sawGain[k] = (s == Shape::Saw) ? 1 : 0;
+            this->triangleGain[k] = (s == Shape::Triangle) ? 1 : 0;
+            this->sineGain[k] = (s == Shape::Sine) ? 1 : 0;
+            this->numSines = 0;
+            for (size_t j = 0; j < N; j++) { this->numSines += (this->shape[j] == Shape::Sine); }
+        }
+
+        /**
+         * @brief Sets the phase of oscillator `k`, in cycles (wrapped to `[0, 1)`)
+         */
+        void setPhase(size_t k, T ph) { this->phase[k] = detail::unitToPhase((double)ph); }
+
+        /**
+         * @brief Returns the phase of oscillator `k` in cycles without incrementing
+         */
+        T getPhase(size_t k) const { return detail::phaseToUnit<T>(this->phase[k]); }
+
+        Shape getShape(size_t k) const { return this->shape[k]; }
+    };
+
+    /**
+     * @brief Band-limited Sawtooth, Square or Triangle Oscillator, read from mipmapped tables (`detail::wavetables()`)
+     * with one table level per octave: `setFrequency()` picks the level whose harmonics all stay below Nyquist and
+     * crossfades into the next level up the octave, so the waveform is alias-free (harmonics reach between a quarter and
+     * half of the sample rate) at about the cost of two table lookups per sample. Edges overshoot by about 9%
+     * (Gibbs phenomenon). The tables are built by the first oscillator constructed, which takes a few milliseconds.
+     * The phase is a fixed-point `uint32_t`, as in `giml::Phasor<T, uint32_t>`. With `float`, `processBlock()` reads the
+     * tables in SIMD vectors (`simd::kernels()`), and its samples may differ from `processSample()` in the last bits
+     * @tparam T sample type of the output
+     */
+    template <typename T>
+    class WavetableOsc {
+    public:
+        /**
+         * @brief Waveform, bipolar
+         */
+        enum class Shape {
+            Saw,     // rising from -1 to 1
+            Square,  // 1 for the first half cycle, -1 for the second
+            Triangle // 1 at phase 0, -1 at half a cycle, as `giml::TriOsc`
+        };
+
+    private:
+        int sampleRate;
+        T frequency = 0.0, blend = 0.0;
+        Shape shape = Shape::Saw;
+        uint32_t phase = 0, phaseIncrement = 0;
+        const float* levelA = nullptr; // band-limited for `frequency`
+        const float* levelB = nullptr; // the level above, faded in by `blend` as `frequency` rises through the octave
+
+        // Picks the levels for `frequency`: the top harmonic of level `l` is at `frequency * 1024 / 2^l`
+        void selectLevels() {
+            double octave = ::log2(::fabs((double)this->frequency) * detail::wavetableSize / this->sampleRate) + 1;
+            size_t level = 0;
+            this->blend = 0;
+            if (octave > 0) { // also false for a frequency of 0
+                level = std::min((size_t)octave, detail::wavetableLevels - 1);
+                if (level < detail::wavetableLevels - 1) { this->blend = (T)(octave - level); }
+            }
+            const auto& tables = detail::wavetables().data[(size_t)this->shape];
+            this->levelA = tables[level];
+            this->levelB = tables[std::min(level + 1, detail::wavetableLevels - 1)];
+        }
+
+    public:
+        // Constructor
+        WavetableOsc() = delete;
+        WavetableOsc(int sampRate, Shape s = Shape::Saw) : sampleRate(sampRate), shape(s) {
+            this->selectLevels();
+        }
+
+        // Destructor
+        ~WavetableOsc() {}
+
+        // Copy constructor
+        WavetableOsc(const WavetableOsc<T>& w) { *this = w; }
+
+        // Copy assignment operator
+        WavetableOsc<T>& operator=(const WavetableOsc<T>& w) {
+            this->sampleRate = w.sampleRate;
+            this->frequency = w.frequency;
+            this->blend = w.blend;
+            this->shape = w.shape;
+            this->phase = w.phase;
+            this->phaseIncrement = w.phaseIncrement;
+            this->levelA = w.levelA;
+            this->levelB = w.levelB;
+            return *this;
+        }
+
+        /**
+         * @brief Increments the phase and returns the waveform
+         * @return the waveform at `phase` (after increment)
+         */
+        inline T processSample() {
+            this->phase += this->phaseIncrement; // wraps on overflow
+            uint32_t ph = this->phase;
+            if constexpr (std::is_same<T, float>::value) { ph &= ~0xffu; } // 24 bits, as `processBlock()` reads the tables
+            size_t index = ph >> (32 - detail::wavetableBits);
+            T frac = detail::phaseToUnit<T>(ph << detail::wavetableBits);
+            T a = this->levelA[index] + frac * (this->levelA[index + 1] - this->levelA[index]);
+            T b = this->levelB[index] + frac * (this->levelB[index + 1] - this->levelB[index]);
+            return a + this->blend * (b - a);
+        }
+
+        /**
+         * @brief Generates `numSamples` samples of the waveform
+         * @param out output buffer
+         * @param numSamples number of samples to generate
+         */
+        void processBlock(T* out, size_t numSamples) {
+            GIML_TRACE_SCOPE("WavetableOsc::processBlock");
+            if constexpr (std::is_same<T, float>::value) {
+                float upper[detail::lfoBlockSize];
+                for (size_t offset = 0; offset < numSamples; offset += detail::lfoBlockSize) {
+                    size_t n = std::min(detail::lfoBlockSize, numSamples - offset);
+                    float* chunk = out + offset;
+                    for (size_t i = 0; i < n; i++) {
+                        chunk[i] = upper[i] = detail::phaseToUnit<float>(this->phase + (uint32_t)(i + 1) * this->phaseIncrement);
+                    }
+                    this->phase += (uint32_t)n * this->phaseIncrement;
+                    simd::kernels().wavetable(chunk, n, this->levelA, detail::wavetableSize);
+                    if (this->blend != 0) {
+                        simd::kernels().wavetable(upper, n, this->levelB, detail::wavetableSize);
+                        for (size_t i = 0; i < n; i++) { upper[i] -= chunk[i]; }
+                        simd::kernels().mulAdd(chunk, upper, n, this->blend);
+                    }
+                }
+            }
+            else {
+                for (size_t i = 0; i < numSamples; i++) { out[i] = this->processSample(); }
+            }
+        }
+
+        /**
+         * @brief Sets the oscillator's sample rate 
+         * @param sampRate sample rate of your project
+         */
+        void setSampleRate(int sampRate) {
+            this->sampleRate = sampRate;
+            this->setFrequency(this->frequency);
+        }
+
+        /**
+         * @brief Sets the oscillator's frequency, and the table levels that keep it band-limited
+         * @param freqHz frequency in hertz (cycles per second), negative to run backwards
+         */
+        void setFrequency(T freqHz) {
+            this->frequency = freqHz;
+            this->phaseIncrement = detail::unitToPhase((double)freqHz / this->sampleRate);
+            this->selectLevels();
+        }
+
+        /**
+         * @brief Sets the waveform
+         */
+        void setShape(Shape s) {
+            this->shape = s;
+            this->selectLevels();
+        }
+
+        /**
+         * @brief Sets the phase, in cycles (wrapped to `[0, 1)`)
+         */
+        void setPhase(T ph) { this->phase = detail::unitToPhase((double)ph); }
+
+        /**
+         * @brief Returns the phase in cycles without incrementing
+         */
+        T getPhase() const { return detail::phaseToUnit<T>(this->phase); }
+
+        Shape getShape() const { return this->shape; }
     };
 }
-#endif
\ No newline at end of file
+#endif
@@ -10,23 +10,41 @@ namespace giml {
      * @brief This class implements a basic phaser effect
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
      * up to user what precision they are looking for (float is more performant)
+     * @tparam MaxStages if non-zero, the filter bank is stored inline in the object instead of on the heap, 
+     * and more `stages` are clamped to it
      * @todo depth control (variable number of stages)
      * @todo resolve zero-delay feedback
      */
-    template <typename T>
+    template <typename T, size_t MaxStages = 0>
     class Phaser : public Effect<T> {
     private:
         int sampleRate;
         size_t numStages = 0;
         T rate = 0.0, feedback = 0.0, last = 0.0;
         giml::TriOsc<T> osc;
-        giml::DynamicArray<giml::SVF<T>> filterbank;
-        giml::DynamicArray<T> centerFreqs;
+        giml::DynamicArray<giml::SVF<T>, MaxStages> filterbank;
+        giml::DynamicArray<T, MaxStages> centerFreqs;
+
+        // Sweeps the filterbank by the LFO sample `mod` and passes `last` through it
+        inline T modulate(const T& in, T mod) {
+            // pass through filterbank to create phase distortion
+            for (size_t stage = 0; stage < numStages; stage++) {
+                auto& f = this->filterbank[stage];
+                auto& Fc = this->centerFreqs[stage];
+                f.setParams(Fc + mod * (Fc * 0.5), 2.0, sampleRate); // set cutoff frequency !! CPU heavy !!
+                f.operator()(last); // update filter state
+                last = f.allPass();
+            }
+
+            last = giml::linMix<T>(in, last); // combine with input to create comb filter effect
+            return last; 
+        }
 
     public:
         // Constructor
         Phaser() = delete;
         Phaser(int samprate, size_t stages = 6) : sampleRate(samprate), numStages(stages), osc(samprate) {
+            if (MaxStages > 0 && this->numStages > MaxStages) { this->numStages = MaxStages; }
             for (size_t stage = 0; stage < numStages; stage++) {
                 filterbank.pushBack(giml::SVF<T>(samprate));
 
@@ -40,7 +58,7 @@ namespace giml {
         ~Phaser() {}
 
         // Copy constructor
-        Phaser(const Phaser<T>& p) {
+        Phaser(const Phaser<T, MaxStages>& p) : osc(p.osc) {
             this->enabled = p.enabled;
             this->sampleRate = p.sampleRate;
             this->numStages = p.numStages;
@@ -53,7 +71,7 @@ namespace giml {
         }
 
         // Copy assignment operator 
-        Phaser<T>& operator=(const Phaser<T>& p) {
+        Phaser<T, MaxStages>& operator=(const Phaser<T, MaxStages>& p) {
             this->enabled = p.enabled;
             this->sampleRate = p.sampleRate;
             this->numStages = p.numStages;
@@ -73,28 +91,45 @@ namespace giml {
          * @todo optimize SVF.setParams() call
          */
         inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("Phaser::processSample");
 
             last = giml::linMix<T>(in, last, this->feedback);
             if (!this->enabled) { return in; }
-            T mod = osc.processSample();
+            return this->modulate(in, osc.processSample());
+        }
 
-            // pass through filterbank to create phase distortion
-            for (size_t stage = 0; stage < numStages; stage++) {
-                auto& f = this->filterbank[stage];
-                auto& Fc = this->centerFreqs[stage];
-                f.setParams(Fc + mod * (Fc * 0.5), 2.0, sampleRate); // set cutoff frequency !! CPU heavy !!
-                f.operator()(last); // update filter state
-                last = f.allPass();
-            }
+        /**
+         * @brief `processSample()` with the LFO supplied by the caller (e.g. one output of a `giml::OscillatorBank`)
+         * instead of `osc`
+         * @param in current sample
+         * @param lfo LFO sample, bipolar as `giml::TriOsc` outputs
+         * @return mix of current input and last output with time-varying comb filter
+         */
+        inline T processSample(const T& in, T lfo) {
+            GIML_TRACE_SAMPLE_SCOPE("Phaser::processSample");
+            last = giml::linMix<T>(in, last, this->feedback);
+            if (!this->enabled) { return in; }
+            return this->modulate(in, lfo);
+        }
 
-            last = giml::linMix<T>(in, last); // combine with input to create comb filter effect
-            return last; 
+        using Effect<T>::processBlock;
+
+        /**
+         * @brief Processes a block in place, with the LFO supplied by the caller instead of `osc`
+         * @param lfo LFO samples, bipolar as `giml::TriOsc` outputs
+         * @param lfoStride distance between consecutive LFO samples, e.g. `N` to read one oscillator
+         * of `giml::OscillatorBank<T, N>::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples, const T* lfo, size_t lfoStride = 1) {
+            GIML_TRACE_SCOPE("Phaser::processBlock");
+            for (size_t i = 0; i < numSamples; i++) { buffer[i] = this->processSample(buffer[i], lfo[i * lfoStride]); }
         }
 
         /**
          * @brief sets rate, depth, feedback
          */
         void setParams(const T& rate = 0.5, const T& feedback = 0.85) {
+            GIML_TRACE_SCOPE("Phaser::setParams");
             this->setRate(rate);
             this->setFeedback(feedback);
         }
@@ -114,6 +149,22 @@ namespace giml {
         void setFeedback(const T& fbGain) { 
             this->feedback = giml::clip<T>(fbGain, -1, 1); 
         }
+
+        void reset() override {
+            for (auto& f : this->filterbank) { f.reset(); }
+            this->last = 0;
+            this->osc.setPhase(0);
+        }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->osc.setSampleRate(sampleRate);
+            for (size_t stage = 0; stage < this->numStages; stage++) {
+                this->filterbank[stage] = giml::SVF<T>(sampleRate);
+                this->centerFreqs[stage] = (this->sampleRate * 0.25) / (2.0 * (this->numStages - stage));
+            }
+            this->reset();
+        }
     };
 }
 #endif
\ No newline at end of file
@@ -3,17 +3,76 @@
 #include "utility.hpp"
 #include "oscillator.hpp"
 #include "biquad.hpp"
+#include "filter.hpp"
+#include <array>
+#include <utility>
 namespace giml {
+    namespace detail {
+        /**
+         * @brief Delay index of the `i`th of `n` parallel delay lines, spread over [maxDelay/1.5, maxDelay]
+         * as described in `Reverb::setTime()`. Computed per line so that `setTime()` needs no scratch array
+         */
+        inline float reverbDelayIndex(int i, int n, float maxDelay) {
+            if (i == n - 1) { return maxDelay / 1.5f; } //We know min because of the ratio restriction
+            if (i == 0) { return maxDelay; }
+            float division = M_PI_4 / (n - 1); // (pi/4)/number of intermediate comb filters we have left
+            return maxDelay * (::tanf(i * division) + 2) / 3; //maxDelay * intermediate multiplier
+        }
+
+        /**
+         * @brief RT-60 decay time of a preset room, see `Reverb::setRoom()`
+         * @param length side or radius of the room in feet
+         * @param absorptionCoefficient average absorption of the surfaces, [0, 1]
+         * @param type `Reverb::RoomType` preset shape
+         */
+        template <typename RoomType>
+        inline float roomRT60(float length, float absorptionCoefficient, RoomType type) {
+            float RT60 = 0.f;
+            switch (type) {
+                //Simplified V/SA formulas:
+            case RoomType::SPHERE: {
+                RT60 = length / (6 * absorptionCoefficient);
+                break;
+            }
+            case RoomType::CUBE: {
+                RT60 = length / (12 * absorptionCoefficient);
+                break;
+            }
+            case RoomType::SQUARE_PYRAMID: {
+                //Sand Pyramids absorb a lot more than brick walls, say 0.7-0.9 vs 0.02 for brick
+                RT60 = length / (6 * (1 + ::sqrtf(5)) * absorptionCoefficient);
+                break;
+            }
+            case RoomType::CYLINDER: {
+                RT60 = length / (8 * absorptionCoefficient);
+                break;
+            }
+            }
+            return RT60;
+        }
+    } // namespace detail
 
     /**
      * @brief Reverb Effect
      * 
      * Implements a Schroeder reverb (20 combs + 4 nested APFs)
      * 
+     * The late tank (the combs and the APFs after them) can run at a half or a quarter of the sample rate
+     * (`tankDecimation`), behind a halfband decimator and interpolator: about half (or a quarter) of the tank's CPU
+     * and memory, for a tail without content above a quarter (or an eighth) of the sample rate.
+     * The APFs before the combs stay at full rate
+     * 
+     * Constructed with `stereo = true`, the stereo `processSample()` and `processBlock()` run one tank for both channels:
+     * the combs are fed the mid signal (plus the side signal when `crossfeed < 1`), and the right output sums
+     * the same combs with every other pair negated, through its own copy of the APFs after the combs.
+     * The combs are mutually decorrelated, so are the two sums: a wide tail for the cost of the extra APFs
+     * 
      * @tparam T floating-point (float or double or long double)
+     * @tparam StorageT type the delay lines store samples as, such as `int16_t`, `giml::half` or `giml::bfloat16`
+     * to halve their memory and bandwidth, see `storage_codec`
      * 
      */
-    template <typename T>
+    template <typename T, typename StorageT = T>
     class Reverb : public Effect<T> {
     private:
         // The user-defined parameters
@@ -25,6 +84,18 @@ namespace giml {
 
         int sampleRate;
 
+        // Late tank decimation: 1 (full rate), 2 or 4
+        int tankDecimation = 1;
+        Halfband<T> decimators[2], interpolators[2]; // one halfband per octave
+        T tankIn[4] = {}, tankOut[4] = {}; // a tank sample's worth of input, and the previous one's output
+        int tankPhase = 0;
+
+        // Stereo tank: the side signal's decimators and the right output's interpolators
+        bool stereo = false;
+        float param__crossfeed = 1.f;
+        Halfband<T> sideDecimators[2], rightInterpolators[2];
+        T tankSideIn[4] = {}, tankOutRight[4] = {};
+
         // Class forward declarations (definitions down below)
         template <typename U>
         class NestedAPF;
@@ -38,89 +109,149 @@ namespace giml {
 
         // Series APF arrays (one for before the comb filters and one for after)
         int numBeforeAPFs, numAfterAPFs;
-        DynamicArray<NestedAPF<T>*> beforeAPFs, afterAPFs;
+        DynamicArray<NestedAPF<T>*> beforeAPFs, afterAPFs, rightAfterAPFs; // `rightAfterAPFs` only in stereo
         NestedAPF<T>* createNestedAPF(int sampleRate, int nestingDepth = 0) { // Uses `new`, must be properly deallocated in the Destructor
             NestedAPF<T>* pCurrentAPF = nullptr;
             for (int i = 0; i < nestingDepth + 1; i++) {
                 // Using placement `new` to force invocation of malloc instead for when we might want to go into embedded
-                NestedAPF<T>* temp = (NestedAPF<T>*)malloc(sizeof(NestedAPF<T>)); // Need to use temp or else will lead to infinite nesting
+                NestedAPF<T>* temp = (NestedAPF<T>*)GIML_MALLOC(sizeof(NestedAPF<T>)); // Need to use temp or else will lead to infinite nesting
                 NestedAPF<T>* n = new (temp) NestedAPF<T>{ sampleRate, pCurrentAPF };
                 pCurrentAPF = temp;
             }
             return pCurrentAPF;
         }
+
+        NestedAPF<T>* cloneNestedAPF(const NestedAPF<T>* pSource) { // deep copies `pSource` and everything nested inside it
+            NestedAPF<T>* temp = (NestedAPF<T>*)GIML_MALLOC(sizeof(NestedAPF<T>));
+            return new (temp) NestedAPF<T>{ *pSource };
+        }
+
+        void freeAPFs() { //APFs are allocated on heap to persist through calls
+            for (NestedAPF<T>* p : this->beforeAPFs) {
+                p->~NestedAPF<T>();
+                GIML_FREE(p);
+            }
+            for (NestedAPF<T>* p : this->afterAPFs) {
+                p->~NestedAPF<T>();
+                GIML_FREE(p);
+            }
+            for (NestedAPF<T>* p : this->rightAfterAPFs) {
+                p->~NestedAPF<T>();
+                GIML_FREE(p);
+            }
+        }
     
     public:
         //Constructor - creates all APFs/Comb Filters and puts them in place
         Reverb() = delete;
-        Reverb(int sampleRate, int numBeforeAPFs = 2, int numCombFilters = 20, int numAfterAPFs = 2, int APFNestingDepth = 2) : sampleRate(sampleRate),
+        /**
+         * @param tankDecimation 1 runs the combs and the APFs after them at `sampleRate`, 2 or 4 at `sampleRate / tankDecimation`
+         * @param stereo allocates the right output's APFs for the stereo `processSample()`
+         */
+        Reverb(int sampleRate, int numBeforeAPFs = 2, int numCombFilters = 20, int numAfterAPFs = 2, int APFNestingDepth = 2, int tankDecimation = 1, bool stereo = false) : sampleRate(sampleRate),
         numBeforeAPFs(numBeforeAPFs), numCombFilters(numCombFilters), numAfterAPFs(numAfterAPFs) {
+            this->stereo = stereo;
+            this->tankDecimation = (tankDecimation >= 4) ? 4 : ((tankDecimation >= 2) ? 2 : 1);
             for (int i = 0; i < numBeforeAPFs; i++) {
                 this->beforeAPFs.pushBack(this->createNestedAPF(sampleRate, APFNestingDepth)); //Let's try nesting depth of 1 first
             }
             
             for (int i = 0; i < numCombFilters; i++) {
                 // Since all comb filters are in parallel, they'll use the same delay line input (?)
-                this->parallelCombFilters.pushBack(CombFilter<T>(sampleRate, (i%2))); // Initialize the n comb filters
+                this->parallelCombFilters.pushBack(CombFilter<T>(sampleRate / this->tankDecimation, (i%2))); // Initialize the n comb filters
                 // Comb filters are altered in phase when feedback gains are set in `.setRoom()`
             }
 
             for (int i = 0; i < numAfterAPFs; i++) {
-                this->afterAPFs.pushBack(this->createNestedAPF(sampleRate, 2));
+                this->afterAPFs.pushBack(this->createNestedAPF(sampleRate / this->tankDecimation, 2));
+                if (stereo) { this->rightAfterAPFs.pushBack(this->createNestedAPF(sampleRate / this->tankDecimation, 2)); }
             }
             
         }
 
         // Copy constructor
-        Reverb(const Reverb<T>& r) {
+        Reverb(const Reverb<T, StorageT>& r) {
+            this->enabled = r.enabled;
             this->sampleRate = r.sampleRate;
 
             this->param__time = r.param__time;
             this->param__regen = r.param__regen;
             this->param__length = r.param__length;
             this->param__damping = r.param__damping;
+            this->param__blend = r.param__blend;
+            this->param__absorption = r.param__absorption;
+            this->param__roomType = r.param__roomType;
+            this->param__customRoom = r.param__customRoom;
 
             this->numCombFilters = r.numCombFilters;
             this->numBeforeAPFs = r.numBeforeAPFs;
             this->numAfterAPFs = r.numAfterAPFs;
 
+            this->tankDecimation = r.tankDecimation;
+            for (int i = 0; i < 2; i++) {
+                this->decimators[i] = r.decimators[i];
+                this->interpolators[i] = r.interpolators[i];
+            }
+            for (int i = 0; i < 4; i++) {
+                this->tankIn[i] = r.tankIn[i];
+                this->tankOut[i] = r.tankOut[i];
+            }
+            this->tankPhase = r.tankPhase;
+            this->copyStereoState(r);
+
             this->parallelCombFilters = r.parallelCombFilters;
-            this->beforeAPFs = r.beforeAPFs;
-            this->afterAPFs = r.afterAPFs;
+            for (NestedAPF<T>* p : r.beforeAPFs) { this->beforeAPFs.pushBack(this->cloneNestedAPF(p)); }
+            for (NestedAPF<T>* p : r.afterAPFs) { this->afterAPFs.pushBack(this->cloneNestedAPF(p)); }
+            for (NestedAPF<T>* p : r.rightAfterAPFs) { this->rightAfterAPFs.pushBack(this->cloneNestedAPF(p)); }
 
         }
 
         // Copy assignment constructor
-        Reverb<T>& operator=(const Reverb<T>& r) {
+        Reverb<T, StorageT>& operator=(const Reverb<T, StorageT>& r) {
+            if (this == &r) { return *this; }
+            this->enabled = r.enabled;
             this->sampleRate = r.sampleRate;
             
             this->param__time = r.param__time;
             this->param__regen = r.param__regen;
             this->param__length = r.param__length;
             this->param__damping = r.param__damping;
+            this->param__blend = r.param__blend;
+            this->param__absorption = r.param__absorption;
+            this->param__roomType = r.param__roomType;
+            this->param__customRoom = r.param__customRoom;
 
             this->numCombFilters = r.numCombFilters;
             this->numBeforeAPFs = r.numBeforeAPFs;
             this->numAfterAPFs = r.numAfterAPFs;
 
+            this->tankDecimation = r.tankDecimation;
+            for (int i = 0; i < 2; i++) {
+                this->decimators[i] = r.decimators[i];
+                this->interpolators[i] = r.interpolators[i];
+            }
+            for (int i = 0; i < 4; i++) {
+                this->tankIn[i] = r.tankIn[i];
+                this->tankOut[i] = r.tankOut[i];
+            }
+            this->tankPhase = r.tankPhase;
+            this->copyStereoState(r);
+
             this->parallelCombFilters = r.parallelCombFilters;
-            this->beforeAPFs = r.beforeAPFs;
-            this->afterAPFs = r.afterAPFs;
+            this->freeAPFs(); // APFs are owned, so deep copy them instead of sharing pointers
+            this->beforeAPFs = DynamicArray<NestedAPF<T>*>();
+            this->afterAPFs = DynamicArray<NestedAPF<T>*>();
+            this->rightAfterAPFs = DynamicArray<NestedAPF<T>*>();
+            for (NestedAPF<T>* p : r.beforeAPFs) { this->beforeAPFs.pushBack(this->cloneNestedAPF(p)); }
+            for (NestedAPF<T>* p : r.afterAPFs) { this->afterAPFs.pushBack(this->cloneNestedAPF(p)); }
+            for (NestedAPF<T>* p : r.rightAfterAPFs) { this->rightAfterAPFs.pushBack(this->cloneNestedAPF(p)); }
 
             return *this;
         }
 
         // Destructor
         ~Reverb() {
-            //APFs are allocated on heap to persist through calls
-            for (NestedAPF<T>* p : this->beforeAPFs) {
-                p->~NestedAPF<T>();
-                free(p);
-            }
-            for (NestedAPF<T>* p : this->afterAPFs) {
-                p->~NestedAPF<T>();
-                free(p);
-            }
+            this->freeAPFs();
         }
         
         /**
@@ -137,12 +268,14 @@ namespace giml {
          * @brief Abstract class to override and provide your own volume and surface area methods:
          * - `getVolume()` return a fixed volume of the same type that `Reverb` is using
          * - `getSurfaceArea()` return a fixed surface area of the same type that `Reverb` is using
+         * - `getAbsorptionCoefficient()` (optional) average absorption of the surfaces, defaults to 0.75
          * 
          */
         class CustomRoom {
         public:
             virtual T getVolume() = 0;
             virtual T getSurfaceArea() = 0;
+            virtual T getAbsorptionCoefficient() { return 0.75; }
         };
 
 
@@ -161,6 +294,7 @@ namespace giml {
          * @see giml::Reverb::setRoom()
          */
         void setParams(float time, float regen, float damping, float blend = 0.5f, float roomLength = 1.f, float absorptionCoefficient = 0.75f, RoomType roomType = RoomType::SPHERE) {
+            GIML_TRACE_SCOPE("Reverb::setParams");
             this->setTime(time);
             this->setRegen(regen);
             this->setRoom(roomLength, absorptionCoefficient, roomType);
@@ -169,6 +303,7 @@ namespace giml {
         }
 
         void setParams(float time, float regen, float damping, float blend = 0.5f, CustomRoom* customRoom = nullptr) {
+            GIML_TRACE_SCOPE("Reverb::setParams");
             this->setTime(time);
             this->setRegen(regen);
             this->setRoom(customRoom);
@@ -182,6 +317,7 @@ namespace giml {
          * @return T floating-point (float or double) output
          */
         inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("Reverb::processSample");
 
             //this->delayLineInput.writeSample(in);
             if (!(this->enabled)) { return in; }
@@ -190,7 +326,152 @@ namespace giml {
                 for (auto& apf : this->beforeAPFs) { prev = apf->processSample(prev); }
             }
 
-            // And then the comb filters
+            T wet = (this->tankDecimation == 1) ? this->processTank(prev) : this->processDecimatedTank(prev, 0, nullptr);
+            return giml::powMix(in, wet, this->param__blend);
+        }
+
+        /**
+         * @brief Processes one stereo frame through the shared tank. 
+         * Without `stereo` at construction, both channels get the mono reverb of the mid signal
+         * 
+         * @param inL left input
+         * @param inR right input
+         * @param outL left output
+         * @param outR right output
+         */
+        inline void processSample(const T& inL, const T& inR, T& outL, T& outR) {
+            GIML_TRACE_SAMPLE_SCOPE("Reverb::processSample");
+            if (!(this->enabled)) {
+                outL = inL;
+                outR = inR;
+                return;
+            }
+            T mid = (inL + inR) * T(0.5), side = (inL - inR) * T(0.5);
+            if (this->numBeforeAPFs > 0) {
+                for (auto& apf : this->beforeAPFs) { mid = apf->processSample(mid); }
+            }
+
+            T wetL, wetR;
+            if (!this->stereo) { wetL = wetR = (this->tankDecimation == 1) ? this->processTank(mid) : this->processDecimatedTank(mid, 0, nullptr); }
+            else if (this->tankDecimation == 1) { wetL = this->processStereoTank(mid, side, wetR); }
+            else { wetL = this->processDecimatedTank(mid, side, &wetR); }
+            outL = giml::powMix(inL, wetL, this->param__blend);
+            outR = giml::powMix(inR, wetR, this->param__blend);
+        }
+
+        using Effect<T>::processBlock;
+
+        /**
+         * @brief Processes a block of stereo frames in place, see the stereo `processSample()`
+         * @param left left channel, overwritten with the output
+         * @param right right channel, overwritten with the output
+         * @param numSamples number of samples in each channel
+         */
+        void processBlock(T* left, T* right, size_t numSamples) {
+            GIML_TRACE_SCOPE("Reverb::processBlock");
+            for (size_t i = 0; i < numSamples; i++) {
+                this->processSample(left[i], right[i], left[i], right[i]);
+            }
+        }
+
+        /**
+         * @brief How much of the stereo input reaches the tank as mid only
+         * @param crossfeed 1 feeds the combs the mid signal, 
+         * below 1 adds `1 - crossfeed` of the side signal with alternating signs (clamped to [0, 1])
+         */
+        void setCrossfeed(float crossfeed) { this->param__crossfeed = giml::clip<float>(crossfeed, 0.f, 1.f); }
+
+        /**
+         * @brief the APFs before the combs, then the longest comb and the APFs after it, 
+         * at the tank's rate and behind the halfbands when the tank is decimated. 
+         * Bounded from the loop gains rather than from the room's RT60, 
+         * since the comb gains are clamped below what a long RT60 asks for
+         */
+        int getTailSamples() const override {
+            int before = 0, combs = 0, after = 0, afterRight = 0;
+            for (const NestedAPF<T>* apf : this->beforeAPFs) {
+                int tail = apf->getTailSamples();
+                if (tail < 0) { return -1; }
+                before += tail;
+            }
+            for (const CombFilter<T>& combFilter : this->parallelCombFilters) {
+                int tail = combFilter.getTailSamples();
+                if (tail < 0) { return -1; }
+                combs = std::max(combs, tail);
+            }
+            for (const NestedAPF<T>* apf : this->afterAPFs) {
+                int tail = apf->getTailSamples();
+                if (tail < 0) { return -1; }
+                after += tail;
+            }
+            for (const NestedAPF<T>* apf : this->rightAfterAPFs) {
+                int tail = apf->getTailSamples();
+                if (tail < 0) { return -1; }
+                afterRight += tail;
+            }
+            int tank = combs + std::max(after, afterRight);
+            if (this->tankDecimation > 1) {
+                // a decimator and an interpolator per octave, each halfband's tail counted at its low rate
+                int halfbands = Halfband<T>::getTailSamples() * ((this->tankDecimation == 2) ? 4 : 12);
+                tank = tank * this->tankDecimation + halfbands + this->tankDecimation;
+            }
+            return before + tank;
+        }
+
+        /**
+         * @brief Clears every comb and allpass delay line, without reallocating them
+         */
+        void reset() override {
+            for (auto& combFilter : this->parallelCombFilters) { combFilter.reset(); }
+            for (auto& apf : this->beforeAPFs) { apf->reset(); }
+            for (auto& apf : this->afterAPFs) { apf->reset(); }
+            for (int i = 0; i < 2; i++) {
+                this->decimators[i].reset();
+                this->interpolators[i].reset();
+            }
+            for (int i = 0; i < 4; i++) { this->tankIn[i] = this->tankOut[i] = 0; }
+            this->tankPhase = 0;
+            for (auto& apf : this->rightAfterAPFs) { apf->reset(); }
+            for (int i = 0; i < 2; i++) {
+                this->sideDecimators[i].reset();
+                this->rightInterpolators[i].reset();
+            }
+            for (int i = 0; i < 4; i++) { this->tankSideIn[i] = this->tankOutRight[i] = 0; }
+        }
+
+        /**
+         * @brief Resizes the delay lines for `sampleRate` (reallocating only if they must grow) 
+         * and recomputes every delay and gain from the current parameters
+         */
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            GIML_TRACE_SCOPE("Reverb::prepare");
+            this->sampleRate = sampleRate;
+            for (auto& combFilter : this->parallelCombFilters) { combFilter.prepare(sampleRate / this->tankDecimation); }
+            for (auto& apf : this->beforeAPFs) { apf->prepare(sampleRate); }
+            for (auto& apf : this->afterAPFs) { apf->prepare(sampleRate / this->tankDecimation); }
+            for (auto& apf : this->rightAfterAPFs) { apf->prepare(sampleRate / this->tankDecimation); }
+
+            this->setTime(this->param__time);
+            this->setRegen(this->param__regen);
+            if (this->param__customRoom) { this->setRoom(this->param__customRoom); }
+            else { this->setRoom(this->param__length, this->param__absorption, this->param__roomType); }
+            this->setDamping(this->param__damping);
+            this->reset();
+        }
+
+    private:
+        // Room parameters, kept so that `prepare()` can recompute the feedback gains
+        float param__absorption = 0.75f;
+        RoomType param__roomType = RoomType::SPHERE;
+        CustomRoom* param__customRoom = nullptr;
+
+        // Sample rate the combs and the APFs after them run at
+        float tankRate() const { return (float)this->sampleRate / this->tankDecimation; }
+
+        /**
+         * @brief One sample through the late tank: the parallel combs, then the APFs after them
+         */
+        inline T processTank(T prev) {
             T summedValue = 0;
             for (auto& combFilter : this->parallelCombFilters) {
                 summedValue += combFilter.processSample(prev);
@@ -204,17 +485,102 @@ namespace giml {
                     //prev = apf->processSample(prev);
                 }
             }
+            return summedValue;
+        }
 
-            return giml::powMix(in, summedValue, this->param__blend);
+        /**
+         * @brief One sample through the stereo tank: the combs fed the mid (and side) signal, 
+         * summed with two sign patterns, then each sum through its own APFs
+         * 
+         * @param mid diffused mid signal
+         * @param side side signal, scaled by `1 - crossfeed`
+         * @param right right output
+         * @return left output
+         */
+        inline T processStereoTank(T mid, T side, T& right) {
+            side *= (1 - this->param__crossfeed);
+            T summedValue = 0, summedRight = 0;
+            for (int i = 0; i < this->numCombFilters; i++) {
+                T y = this->parallelCombFilters[i].processSample((i % 2) ? mid - side : mid + side);
+                summedValue += y;
+                summedRight += ((i / 2) % 2) ? -y : y; // + - + - on the left, + - - + on the right
+            }
+
+            summedValue /= this->numCombFilters;
+            summedRight /= this->numCombFilters;
+            for (auto& apf : this->afterAPFs) { summedValue = apf->processSample(summedValue); }
+            for (auto& apf : this->rightAfterAPFs) { summedRight = apf->processSample(summedRight); }
+            right = summedRight;
+            return summedValue;
+        }
+
+        // `tankDecimation` samples to one at the tank's rate
+        inline T decimateTank(Halfband<T>* halfbands, const T* in) {
+            if (this->tankDecimation == 2) { return halfbands[0].decimate(in[0], in[1]); }
+            T half0 = halfbands[0].decimate(in[0], in[1]);
+            T half1 = halfbands[0].decimate(in[2], in[3]);
+            return halfbands[1].decimate(half0, half1);
+        }
+
+        // one sample at the tank's rate to `tankDecimation` samples
+        inline void interpolateTank(Halfband<T>* halfbands, T in, T* out) {
+            if (this->tankDecimation == 2) { halfbands[0].interpolate(in, out[0], out[1]); return; }
+            T half0, half1;
+            halfbands[1].interpolate(in, half0, half1);
+            halfbands[0].interpolate(half0, out[0], out[1]);
+            halfbands[0].interpolate(half1, out[2], out[3]);
+        }
+
+        /**
+         * @brief Runs the tank once every `tankDecimation` samples on the decimated input,
+         * and plays back the interpolated output of the previous run: 
+         * the wet signal is `tankDecimation` samples late, plus the halfbands' group delay
+         * 
+         * @param right right output of the stereo tank, `nullptr` for the mono tank (which ignores `side`)
+         */
+        inline T processDecimatedTank(T prev, T side, T* right) {
+            int phase = this->tankPhase;
+            this->tankIn[phase] = prev;
+            T out = this->tankOut[phase];
+            if (right) {
+                this->tankSideIn[phase] = side;
+                *right = this->tankOutRight[phase];
+            }
+            if (phase == this->tankDecimation - 1) {
+                T mid = this->decimateTank(this->decimators, this->tankIn);
+                if (right) {
+                    T yRight;
+                    T y = this->processStereoTank(mid, this->decimateTank(this->sideDecimators, this->tankSideIn), yRight);
+                    this->interpolateTank(this->interpolators, y, this->tankOut);
+                    this->interpolateTank(this->rightInterpolators, yRight, this->tankOutRight);
+                }
+                else { this->interpolateTank(this->interpolators, this->processTank(mid), this->tankOut); }
+                phase = -1;
+            }
+            this->tankPhase = phase + 1;
+            return out;
+        }
+
+        void copyStereoState(const Reverb<T, StorageT>& r) {
+            this->stereo = r.stereo;
+            this->param__crossfeed = r.param__crossfeed;
+            for (int i = 0; i < 2; i++) {
+                this->sideDecimators[i] = r.sideDecimators[i];
+                this->rightInterpolators[i] = r.rightInterpolators[i];
+            }
+            for (int i = 0; i < 4; i++) {
+                this->tankSideIn[i] = r.tankSideIn[i];
+                this->tankOutRight[i] = r.tankOutRight[i];
+            }
         }
 
-    private:
         /**
          * @brief Takes the `time` value and calculates the delay indices for all the comb filters and the APFs
          * 
          * @param t time in seconds (you'll want to pass in milliseconds instead to avoid accidental delay effects)
          */
         inline void setTime(float t) { //in sec
+            GIML_TRACE_SCOPE("Reverb::setTime");
             this->param__time = t;
             // Recalculate/set the delay indices
 
@@ -252,41 +618,25 @@ namespace giml {
              *
              */
 
-            //Comb Filter Delay Indices
-            float* delayIndices = (float*)calloc(this->numCombFilters, sizeof(float));
-            //int delayIndices[this->numCombFilters] = {0};
-            delayIndices[0] = this->sampleRate * this->param__time; //They give us max
-            delayIndices[this->numCombFilters - 1] = delayIndices[0] / 1.5f; //We know min because of the ratio restriction
-            float division = M_PI_4 / (this->numCombFilters - 1); // (pi/4)/number of intermediate comb filters we have left
-            for (int i = 1; i < this->numCombFilters - 1; i++) { //Fill in the rest of the comb filters, order does not matter
-                delayIndices[i] = delayIndices[0] * (::tanf(i * division) + 2) / 3; //maxDelay * intermediate multiplier
-            }
-            //Actually set their new delay indices
+            //Comb Filter Delay Indices (the combs run at the tank's rate)
+            float maxDelay = this->tankRate() * this->param__time; //They give us max
             for (int i = 0; i < this->numCombFilters; i++) {
-                this->parallelCombFilters[i].setDelayIndex(delayIndices[i]);
+                this->parallelCombFilters[i].setDelayIndex(detail::reverbDelayIndex(i, this->numCombFilters, maxDelay));
             }
 
-            free(delayIndices);
-
             //TODO: Do what we need to do for APF
             int totalAPFs = this->numBeforeAPFs + this->numAfterAPFs;
             if (totalAPFs > 0) { //If we have any APFs to begin with
-                delayIndices = (float*)calloc(totalAPFs, sizeof(float));
-                delayIndices[0] = (this->sampleRate * this->param__time)/3; //They give us max
-                delayIndices[totalAPFs - 1] = delayIndices[0] / 1.5f; //We know min because of the ratio restriction
-                float division = M_PI_4 / (totalAPFs - 1); // (pi/4)/number of intermediate comb filters we have left
-                for (int i = 1; i < totalAPFs - 1; i++) { //Fill in the rest of the comb filters, order does not matter
-                    delayIndices[i] = delayIndices[0] * (::tanf(i * division) + 2) / 3; //maxDelay * intermediate multiplier
-                }
-                //Actually set their new delay indices
+                maxDelay = (this->sampleRate * this->param__time)/3; //They give us max
                 for (int i = 0; i < this->numBeforeAPFs; i++) {
-                    this->beforeAPFs[i]->setDelaySamples(delayIndices[i]);
+                    this->beforeAPFs[i]->setDelaySamples(detail::reverbDelayIndex(i, totalAPFs, maxDelay));
                 }
                 for (int i = 0; i < this->numAfterAPFs; i++) {
-                    this->afterAPFs[i]->setDelaySamples(delayIndices[this->numBeforeAPFs + i]);
+                    this->afterAPFs[i]->setDelaySamples(detail::reverbDelayIndex(this->numBeforeAPFs + i, totalAPFs, maxDelay) / this->tankDecimation);
+                }
+                for (int i = 0; i < (int)this->rightAfterAPFs.size(); i++) {
+                    this->rightAfterAPFs[i]->setDelaySamples(this->afterAPFs[i]->getDelaySamples());
                 }
-
-                free(delayIndices);
             }
         }
 
@@ -296,10 +646,12 @@ namespace giml {
          * @param g [0, 1) (non-inclusive because we need gain to be decaying for BIBO stability)
          */
         inline void setDamping(float g) { // [0, 1)
+            GIML_TRACE_SCOPE("Reverb::setDamping");
             g = giml::clip<float>(g, 0, 0.97f);
             this->param__damping = g;
             for (auto& apf : this->beforeAPFs) { apf->setLPFFeedbackGain(g); }
             for (auto& apf : this->afterAPFs) { apf->setLPFFeedbackGain(g); }
+            for (auto& apf : this->rightAfterAPFs) { apf->setLPFFeedbackGain(g); }
         }
 
         /**
@@ -314,6 +666,7 @@ namespace giml {
          * @param regen [0, 1) (non-inclusive because we need gain to be decaying for BIBO stability)
          */
         inline void setRegen(float regen) { // [0, 1) (non-inclusive because we need gain to be decaying for BIBO stability)
+            GIML_TRACE_SCOPE("Reverb::setRegen");
             regen = giml::clip<float>(regen, 0, 0.999);
             this->param__regen = regen;
 
@@ -345,9 +698,13 @@ namespace giml {
          * @param customRoom If you set CUSTOM in the previous field, you must specify a pointer to your custom room object so that we can properly calculate the proper feedback coefficients
          */
         inline void setRoom(float length, float absorptionCoefficient = 0.75f, RoomType type = RoomType::SPHERE) {
+            GIML_TRACE_SCOPE("Reverb::setRoom");
             //Length in feet (ft)
             if (length < 0) { length = 0; }
             this->param__length = length;
+            this->param__absorption = absorptionCoefficient;
+            this->param__roomType = type;
+            this->param__customRoom = nullptr;
             // recalculate the RT-60 decay time and the comb filter gains
 
             /**
@@ -373,29 +730,7 @@ namespace giml {
              * Cylinder: V = 1/3 pi r^2 h, SA = 2pi r h + 2pi r^2 (assume h = r though)
              * Square Pyramid: V = 1/3 s^2 h, SA = a^2 + 2a sqrt{a^2/4 + h^2} (assume h = s though)
              */
-            float RT60 = 0.f;
-            switch (type) {
-                //Simplified V/SA formulas:
-            case RoomType::SPHERE: {
-                RT60 = length / (6 * absorptionCoefficient);
-                break;
-            }
-            case RoomType::CUBE: {
-                RT60 = length / (12 * absorptionCoefficient);
-                break;
-            }
-            case RoomType::SQUARE_PYRAMID: {
-                //Sand Pyramids absorb a lot more than brick walls, say 0.7-0.9 vs 0.02 for brick
-                RT60 = length / (6 * (1 + ::sqrtf(5)) * absorptionCoefficient);
-                break;
-            }
-            case RoomType::CYLINDER: {
-                RT60 = length / (8 * absorptionCoefficient);
-                break;
-            }
-            }
-
-            this->calculateAndSetFeedbackCoefficients(RT60);
+            this->calculateAndSetFeedbackCoefficients(detail::roomRT60(length, absorptionCoefficient, type));
         }
         /**
          * @brief Call this function if they specify a custom room object instead
@@ -403,6 +738,8 @@ namespace giml {
          * @param customRoom You must specify a pointer to your custom room object so that we can properly calculate the proper feedback coefficients
          */
         inline void setRoom(CustomRoom* customRoom = nullptr) {
+            GIML_TRACE_SCOPE("Reverb::setRoom");
+            this->param__customRoom = customRoom;
             float RT60 = customRoom->getVolume() / (2 * customRoom->getSurfaceArea() * customRoom->getAbsorptionCoefficient());
             this->calculateAndSetFeedbackCoefficients(RT60);
         }
@@ -412,17 +749,19 @@ namespace giml {
          * g = 10^{\frac{3D}{RT60 * sampleFreq}}
          */
         inline void calculateAndSetFeedbackCoefficients(float RT60) {
+            GIML_TRACE_SCOPE("Reverb::calculateAndSetFeedbackCoefficients");
     
              // Set comb feedback gains corresponding to the newly calculated RT60 decay time
             for (int i = 0; i < this->numCombFilters; i++) {
                 float delayIndex = this->parallelCombFilters[i].getDelayIndex();
-                float feedbackGain = ::pow(10, -3 * delayIndex / (this->sampleRate * RT60));
+                float feedbackGain = ::pow(10, -3 * delayIndex / (this->tankRate() * RT60));
                 if (feedbackGain > 0.75) { feedbackGain = 0.75; } // TODO: better clamping
                 
                 // Flip the phase of every other comb filter
                 if (i % 2) { this->parallelCombFilters[i].setCombFeedbackGain(-feedbackGain); }
                 else { this->parallelCombFilters[i].setCombFeedbackGain(feedbackGain); }
             }
+            this->setRegen(this->param__regen); // the comb LPF gains depend on the new comb gains
 
             // Do what we need to do for APF
             for (int i = 0; i < this->numBeforeAPFs; i++) {
@@ -432,9 +771,14 @@ namespace giml {
             }
             for (int i = 0; i < this->numAfterAPFs; i++) {
                 float delayIndex = this->afterAPFs[i]->getDelaySamples();
-                float feedbackGain = ::powf(10, -3 * delayIndex / (this->sampleRate * RT60)) / 2;
+                float feedbackGain = ::powf(10, -3 * delayIndex / (this->tankRate() * RT60)) / 2;
                 this->afterAPFs[i]->setAPFFeedbackGain(-feedbackGain);
             }
+            for (int i = 0; i < (int)this->rightAfterAPFs.size(); i++) {
+                float delayIndex = this->rightAfterAPFs[i]->getDelaySamples();
+                float feedbackGain = ::powf(10, -3 * delayIndex / (this->tankRate() * RT60)) / 2;
+                this->rightAfterAPFs[i]->setAPFFeedbackGain(-feedbackGain);
+            }
         }
 
         /**
@@ -445,8 +789,7 @@ namespace giml {
         template <typename U>
         class NestedAPF { //not the same as 2nd order APF present in Biquad since this is Nth-order
         private:
-            CircularBuffer<U> delayLine;
-            SinOsc<U> LFO; //TODO: We can try another oscillator?
+            CircularBuffer<U, StorageT> delayLine;
             NestedAPF<U>* nestedAPF; //Pointer to another nestedAPF inside this one's feedback loop
         
         public:
@@ -455,16 +798,15 @@ namespace giml {
             NestedAPF() = delete;
 
             // Allow NestedAPF to take in a pointer to NestedAPF for placement in the feedback loop of this current APF
-            NestedAPF(int sampleRate, NestedAPF<U>* nestedAPF = nullptr) : LFO(sampleRate), nestedAPF(nestedAPF) {
+            NestedAPF(int sampleRate, NestedAPF<U>* nestedAPF = nullptr) : nestedAPF(nestedAPF) {
                 this->delayLine.allocate(5 * sampleRate);
-                //this->LFO.setFrequency(0.1);
             }
-            // Copy Constructor
-            NestedAPF(const NestedAPF<U>& a) {
-                this->delayLine = a.delayLine;
-                this->LFO = a.LFO;
-                this->lfoDepth = a.lfoDepth;
-                this->nestedAPF = a.nestedAPF;
+            // Copy Constructor (deep copies the nested APF chain, each level owns the next)
+            NestedAPF(const NestedAPF<U>& a) : delayLine(a.delayLine), nestedAPF(nullptr) {
+                if (a.nestedAPF) {
+                    NestedAPF<U>* temp = (NestedAPF<U>*)GIML_MALLOC(sizeof(NestedAPF<U>));
+                    this->nestedAPF = new (temp) NestedAPF<U>{ *a.nestedAPF };
+                }
 
                 this->delaySamples = a.delaySamples;
                 this->LPFFeedbackGain = a.LPFFeedbackGain;
@@ -474,10 +816,17 @@ namespace giml {
 
             // Copy assignment operator
             NestedAPF<U>& operator=(const NestedAPF<U>& a) {
+                if (this == &a) { return *this; }
                 this->delayLine = a.delayLine;
-                this->LFO = a.LFO;
-                this->lfoDepth = a.lfoDepth;
-                this->nestedAPF = a.nestedAPF;
+                if (this->nestedAPF) {
+                    this->nestedAPF->~NestedAPF();
+                    GIML_FREE(this->nestedAPF);
+                    this->nestedAPF = nullptr;
+                }
+                if (a.nestedAPF) {
+                    NestedAPF<U>* temp = (NestedAPF<U>*)GIML_MALLOC(sizeof(NestedAPF<U>));
+                    this->nestedAPF = new (temp) NestedAPF<U>{ *a.nestedAPF };
+                }
 
                 this->delaySamples = a.delaySamples;
                 this->LPFFeedbackGain = a.LPFFeedbackGain;
@@ -492,7 +841,7 @@ namespace giml {
                 //Deallocate if it hasn't been already
                 if (this->nestedAPF) {
                     this->nestedAPF->~NestedAPF();
-                    free(this->nestedAPF);
+                    GIML_FREE(this->nestedAPF);
                 }
             }
 
@@ -531,11 +880,9 @@ namespace giml {
 
             U processSample(U in) {
 
-                // Read previous sample from delay line 
-                // modulated by oscillator converted to unipolar through *0.5 + 0.5
-                U delayedVal = this->delayLine.readSample(this->delaySamples + 
-                                (this->LFO.processSample() + 1) / 2 * this->lfoDepth);
-                //U delayedVal = this->delayLine.readSample(this->delaySamples);
+                // Read previous sample from delay line, in the middle of the modulation depth
+                // (the APF LFOs were never given a frequency and always sat there, so they are left out)
+                U delayedVal = this->delayLine.readSample(this->delaySamples + lfoDepth / 2.f);
                 //Now go through LPF
                 delayedVal = delayedVal * (1 - this->LPFFeedbackGain) + 
                                             this->LPFFeedbackGain * this->LPFLast;
@@ -551,6 +898,44 @@ namespace giml {
 
                 return -this->APFFeedbackGain * w + delayedVal;
             }
+
+            /**
+             * @brief Bound on the sum of the absolute impulse response (the largest gain any input can see), 
+             * -1 if the feedback loop doesn't decay. The LPF's response sums to 1, so the loop gain is `|g|` times the nested APF's bound
+             */
+            float getGainBound() const {
+                float nested = this->nestedAPF ? this->nestedAPF->getGainBound() : 1.f;
+                float g = ::fabs(this->APFFeedbackGain), loop = g * nested;
+                if (nested < 0 || loop >= 1.f) { return -1.f; }
+                return (g + nested) / (1.f - loop);
+            }
+
+            /**
+             * @brief trips around the feedback loop until it decays below the threshold, 
+             * each one through the delay, the LPF and the nested APF's own tail
+             */
+            int getTailSamples() const {
+                float nested = this->nestedAPF ? this->nestedAPF->getGainBound() : 1.f;
+                int nestedTail = this->nestedAPF ? this->nestedAPF->getTailSamples() : 0;
+                float loop = ::fabs(this->APFFeedbackGain) * nested;
+                if (nested < 0 || nestedTail < 0 || loop >= 1.f) { return -1; }
+                int trips = decaySamples(loop, 1.f / (1.f - loop)); // peak of the recirculating signal
+                int lpfTail = decaySamples(::fabs(this->LPFFeedbackGain));
+                if (lpfTail < 0) { return -1; }
+                int delay = static_cast<int>(::ceil(this->delaySamples + lfoDepth / 2.f)) + 1; // interpolated read
+                return (trips + 1) * (delay + lpfTail + nestedTail);
+            }
+
+            void reset() {
+                this->delayLine.clear();
+                this->LPFLast = 0;
+                if (this->nestedAPF) { this->nestedAPF->reset(); }
+            }
+
+            void prepare(int sampleRate) {
+                this->delayLine.allocate(5 * sampleRate);
+                if (this->nestedAPF) { this->nestedAPF->prepare(sampleRate); }
+            }
         private:
             static const int lfoDepth = 2; // numSamples to go over/under by from original delay of delay line
             float delaySamples = 0.f; // delay in ms converted to how many samples in the past
@@ -565,7 +950,7 @@ namespace giml {
         template <typename U>
         class CombFilter { //not necessarily a standalone effect in itself
         private:
-            CircularBuffer<U> delayLineY;
+            CircularBuffer<U, StorageT> delayLineY;
             U CombFeedbackGain, LPFFeedbackGain;
             float delayIndex;
             bool neg; // Boolean for phase inversion
@@ -594,7 +979,7 @@ namespace giml {
             }
 
             //Copy constructor
-            CombFilter(const CombFilter<U>& c) {
+            CombFilter(const CombFilter<U>& c) : LPF(c.LPF) {
                 //this->pDelayLineX = c.pDelayLineX;
                 this->delayLineY = c.delayLineY;
                 this->delayIndex = c.delayIndex;
@@ -667,9 +1052,389 @@ namespace giml {
                 //return returnVal;
             }
 
+            /**
+             * @brief trips around the feedback loop until it decays below the threshold. 
+             * The FIR lowpass in the loop sums to 1, so each trip scales the signal by at most the comb gain
+             */
+            int getTailSamples() const {
+                float g = ::fabs(static_cast<float>(this->CombFeedbackGain));
+                if (g >= 1.f) { return -1; }
+                int trips = decaySamples(g, 1.f / (1.f - g)); // peak of the resonating delay line
+                return (trips + 1) * (static_cast<int>(::ceil(this->delayIndex)) + 1);
+            }
+
+            void reset() {
+                this->delayLineY.clear();
+                this->LPF.reset();
+                this->LPFLast = 0;
+            }
+
+            void prepare(int sampleRate) {
+                this->delayLineY.allocate(sampleRate * 5);
+                this->LPF.prepare(sampleRate, 0);
+            }
+
+        };
+
+    };
+
+    /**
+     * @brief `Reverb` with its topology fixed at compile time and every delay line stored inline, 
+     * for targets that forbid heap allocation: constructing, copying or preparing it never allocates, 
+     * and its memory is `sizeof(StaticReverb)`, known at link time. 
+     * Sounds the same as a `Reverb` constructed with the same topology
+     * 
+     * With the topology known, every loop has a constant trip count and the nested APFs unroll into straight code.
+     * The comb filters are processed as a bank: their gains and filter states are kept in arrays, 
+     * their delay lines are interleaved so that the samples written at each step share a cache line, 
+     * and the read positions are split into index and fraction whenever the delays change rather than per sample
+     * 
+     * @tparam T floating-point (float or double or long double)
+     * @tparam NumBeforeAPFs nested APFs in series before the comb filters
+     * @tparam NumCombFilters parallel comb filters
+     * @tparam NumAfterAPFs nested APFs in series after the comb filters
+     * @tparam APFNestingDepth APFs nested inside each of those
+     * @tparam MaxDelaySamples length of every delay line, 
+     * `time` is effectively clamped to `MaxDelaySamples / sampleRate` seconds
+     * @tparam StorageT type the delay lines store samples as, see `Reverb`
+     */
+    template <typename T, int NumBeforeAPFs = 2, int NumCombFilters = 20, int NumAfterAPFs = 2, int APFNestingDepth = 2, 
+              size_t MaxDelaySamples = 4800, typename StorageT = T>
+    class StaticReverb : public Effect<T> {
+        static_assert(NumCombFilters > 0, "StaticReverb needs at least one comb filter");
+        static_assert(NumBeforeAPFs >= 0 && NumAfterAPFs >= 0 && APFNestingDepth >= 0, "StaticReverb topology can't be negative");
+        static_assert(MaxDelaySamples > 1, "StaticReverb delay lines need at least 2 samples");
+
+    public:
+        using RoomType = typename Reverb<T>::RoomType;
+        using CustomRoom = typename Reverb<T>::CustomRoom;
+
+    private:
+        using Codec = storage_codec<T, StorageT>;
+        static constexpr T combScale = T(1) / NumCombFilters; // keeps the summed combs within bounds, without a division per sample
+
+        // The user-defined parameters, as in `Reverb`
+        float param__time = 0.f;
+        float param__regen = 0.f;
+        float param__damping = 0.f;
+        float param__length = 1.f;
+        float param__blend = 0.5f;
+        float param__absorption = 0.75f;
+        RoomType param__roomType = RoomType::SPHERE;
+        CustomRoom* param__customRoom = nullptr;
+
+        int sampleRate;
+
+        /**
+         * @brief Read position of a delay line: the whole samples before the write position 
+         * (as an offset past it, wrapped with a single comparison) and the fraction of the next older sample
+         */
+        struct Tap {
+            size_t offset = MaxDelaySamples, nextOffset = MaxDelaySamples - 1;
+            float frac = 0.f;
+
+            // same clamping as `CircularBuffer::readSample()`
+            void setDelay(float delayInSamples) {
+                size_t index = delayInSamples;
+                this->frac = delayInSamples - index;
+                this->offset = MaxDelaySamples - std::min(index, MaxDelaySamples - 1);
+                this->nextOffset = MaxDelaySamples - std::min(index + 1, MaxDelaySamples - 1);
+            }
         };
 
+        /**
+         * @brief One level of a nested APF, see `Reverb::NestedAPF`. 
+         * As in `Reverb`, the read position is the constant `delaySamples + lfoDepth / 2`, the middle of the modulation depth
+         */
+        struct APFStage {
+            std::array<StorageT, MaxDelaySamples> delayLine;
+            Tap tap;
+            float delaySamples = 0.f;
+            T LPFLast = 0;
+            float LPFFeedbackGain = 0.f, APFFeedbackGain = 0.f;
+
+            void setDelaySamples(float numSamples) {
+                static const int lfoDepth = 2; // numSamples to go over/under by from original delay of delay line
+                this->delaySamples = numSamples;
+                this->tap.setDelay(numSamples + lfoDepth / 2.f);
+            }
+        };
+        using NestedAPF = std::array<APFStage, APFNestingDepth + 1>; // outermost level first
+
+        // Comb filter bank, see `Reverb::CombFilter`. Frame `n` holds every comb's sample `n`
+        std::array<std::array<StorageT, NumCombFilters>, MaxDelaySamples> combFrames;
+        std::array<Tap, NumCombFilters> combTaps;
+        std::array<float, NumCombFilters> combDelays, combSigns; // sign flips the phase of every other comb
+        std::array<T, NumCombFilters> combFeedbackGains, combLPFFeedbackGains, combLPFLasts;
+
+        std::array<NestedAPF, NumBeforeAPFs> beforeAPFs;
+        std::array<NestedAPF, NumAfterAPFs> afterAPFs;
+
+        size_t writeIndex = 0; // shared by every delay line, they are all written once per sample
+
+    public:
+        // Constructor
+        StaticReverb() = delete;
+        StaticReverb(int sampleRate) : sampleRate(sampleRate) {
+            for (int i = 0; i < NumCombFilters; i++) {
+                this->combTaps[i].setDelay(0.f);
+                this->combDelays[i] = 0.f;
+                this->combSigns[i] = (i % 2) ? -1.f : 1.f;
+                this->combFeedbackGains[i] = 0;
+                this->combLPFFeedbackGains[i] = 0;
+            }
+            for (auto& apf : this->beforeAPFs) { for (auto& stage : apf) { stage.setDelaySamples(0.f); } }
+            for (auto& apf : this->afterAPFs) { for (auto& stage : apf) { stage.setDelaySamples(0.f); } }
+            this->reset();
+        }
+
+        // Destructor
+        ~StaticReverb() {}
+
+        // Copy constructor
+        StaticReverb(const StaticReverb& r) {
+            *this = r;
+        }
+
+        // Copy assignment operator
+        StaticReverb& operator=(const StaticReverb& r) {
+            if (this == &r) { return *this; }
+            this->enabled = r.enabled;
+            this->sampleRate = r.sampleRate;
+            this->param__time = r.param__time;
+            this->param__regen = r.param__regen;
+            this->param__damping = r.param__damping;
+            this->param__length = r.param__length;
+            this->param__blend = r.param__blend;
+            this->param__absorption = r.param__absorption;
+            this->param__roomType = r.param__roomType;
+            this->param__customRoom = r.param__customRoom;
+            this->combFrames = r.combFrames;
+            this->combTaps = r.combTaps;
+            this->combDelays = r.combDelays;
+            this->combSigns = r.combSigns;
+            this->combFeedbackGains = r.combFeedbackGains;
+            this->combLPFFeedbackGains = r.combLPFFeedbackGains;
+            this->combLPFLasts = r.combLPFLasts;
+            this->beforeAPFs = r.beforeAPFs;
+            this->afterAPFs = r.afterAPFs;
+            this->writeIndex = r.writeIndex;
+            return *this;
+        }
+
+        /**
+         * @brief Set the reverb parameters, see `Reverb::setParams()`
+         */
+        void setParams(float time, float regen, float damping, float blend = 0.5f, float roomLength = 1.f, float absorptionCoefficient = 0.75f, RoomType roomType = RoomType::SPHERE) {
+            GIML_TRACE_SCOPE("StaticReverb::setParams");
+            this->setTime(time);
+            this->setRegen(regen);
+            this->setRoom(roomLength, absorptionCoefficient, roomType);
+            this->setDamping(damping);
+            this->setBlend(blend);
+        }
+
+        void setParams(float time, float regen, float damping, float blend = 0.5f, CustomRoom* customRoom = nullptr) {
+            GIML_TRACE_SCOPE("StaticReverb::setParams");
+            this->setTime(time);
+            this->setRegen(regen);
+            this->setRoom(customRoom);
+            this->setDamping(damping);
+            this->setBlend(blend);
+        }
+
+        inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("StaticReverb::processSample");
+            if (!(this->enabled)) { return in; }
+            T prev = in;
+            for (auto& apf : this->beforeAPFs) { prev = this->processAPF<0>(apf, prev); }
+
+            T summedValue = this->processCombs(prev) * combScale;
+
+            for (auto& apf : this->afterAPFs) { summedValue = this->processAPF<0>(apf, summedValue); }
+
+            this->writeIndex++;
+            if (this->writeIndex >= MaxDelaySamples) { this->writeIndex = 0; }
+            return giml::powMix(in, summedValue, this->param__blend);
+        }
+
+        /**
+         * @brief Clears every comb and allpass delay line
+         */
+        void reset() override {
+            for (auto& frame : this->combFrames) { frame.fill(StorageT{}); }
+            this->combLPFLasts.fill(0);
+            for (auto& apf : this->beforeAPFs) { resetAPF(apf); }
+            for (auto& apf : this->afterAPFs) { resetAPF(apf); }
+            this->writeIndex = 0;
+        }
+
+        /**
+         * @brief Recomputes every delay and gain for `sampleRate` from the current parameters. 
+         * The delay lines keep their compile-time length
+         */
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            GIML_TRACE_SCOPE("StaticReverb::prepare");
+            this->sampleRate = sampleRate;
+            this->setTime(this->param__time);
+            this->setRegen(this->param__regen);
+            if (this->param__customRoom) { this->setRoom(this->param__customRoom); }
+            else { this->setRoom(this->param__length, this->param__absorption, this->param__roomType); }
+            this->setDamping(this->param__damping);
+            this->reset();
+        }
+
+    private:
+        // index `offset` samples past the write position, wrapped
+        inline size_t wrap(size_t offset) const {
+            size_t index = this->writeIndex + offset;
+            return (index >= MaxDelaySamples) ? index - MaxDelaySamples : index;
+        }
+
+        // linear interpolation, as `CircularBuffer::readSample(size_t, frac)`
+        static inline T interpolate(StorageT sample, StorageT nextSample, float frac) {
+            return Codec::decode(sample) * (1 - frac) + Codec::decode(nextSample) * frac;
+        }
+
+        // every comb's output, summed, after writing its input and filtered feedback
+        inline T processCombs(T in) {
+            std::array<T, NumCombFilters> yn;
+            for (int i = 0; i < NumCombFilters; i++) {
+                const Tap& tap = this->combTaps[i];
+                yn[i] = interpolate(this->combFrames[this->wrap(tap.offset)][i], 
+                                    this->combFrames[this->wrap(tap.nextOffset)][i], tap.frac) * this->combSigns[i];
+            }
+
+            T summedValue = 0;
+            auto& frame = this->combFrames[this->writeIndex];
+            for (int i = 0; i < NumCombFilters; i++) {
+                T filtered = yn[i] * (1 - this->combLPFFeedbackGains[i]) + 
+                    this->combLPFFeedbackGains[i] * this->combLPFLasts[i];
+                this->combLPFLasts[i] = yn[i]; //set next prev to current
+                frame[i] = Codec::encode(in + filtered * this->combFeedbackGains[i]);
+                summedValue += yn[i];
+            }
+            return summedValue;
+        }
+
+        // level `Level` of a nested APF, with the deeper levels in its feedback loop
+        template <int Level>
+        inline T processAPF(NestedAPF& apf, T in) {
+            APFStage& stage = apf[Level];
+            T delayedVal = interpolate(stage.delayLine[this->wrap(stage.tap.offset)], 
+                                       stage.delayLine[this->wrap(stage.tap.nextOffset)], stage.tap.frac);
+            delayedVal = delayedVal * (1 - stage.LPFFeedbackGain) + 
+                                        stage.LPFFeedbackGain * stage.LPFLast;
+            stage.LPFLast = delayedVal; //set next prev to current
+
+            T w = in + stage.APFFeedbackGain * delayedVal;
+            if constexpr (Level < APFNestingDepth) { w = this->processAPF<Level + 1>(apf, w); }
+            stage.delayLine[this->writeIndex] = Codec::encode(w);
+
+            return -stage.APFFeedbackGain * w + delayedVal;
+        }
+
+        static void resetAPF(NestedAPF& apf) {
+            for (auto& stage : apf) {
+                stage.delayLine.fill(StorageT{});
+                stage.LPFLast = 0;
+            }
+        }
+
+        // Like `Reverb`'s nested APFs, the first nested level gets 1/4 of the delay and gains, deeper levels none
+        static void setAPFDelaySamples(NestedAPF& apf, float numSamples) {
+            apf[0].setDelaySamples(numSamples);
+            if (APFNestingDepth > 0) { apf[1].setDelaySamples(numSamples / 4); }
+        }
+
+        static void setAPFLPFFeedbackGain(NestedAPF& apf, float g) {
+            apf[0].LPFFeedbackGain = g;
+            if (APFNestingDepth > 0) { apf[1].LPFFeedbackGain = g / 4; }
+        }
+
+        static void setAPFFeedbackGain(NestedAPF& apf, float g) {
+            apf[0].APFFeedbackGain = g;
+            if (APFNestingDepth > 0) { apf[1].APFFeedbackGain = g / 4; }
+        }
+
+        // See `Reverb::setTime()`
+        void setTime(float t) {
+            this->param__time = t;
+            float maxDelay = this->sampleRate * this->param__time;
+            for (int i = 0; i < NumCombFilters; i++) {
+                this->combDelays[i] = detail::reverbDelayIndex(i, NumCombFilters, maxDelay);
+                this->combTaps[i].setDelay(this->combDelays[i]);
+            }
+
+            constexpr int totalAPFs = NumBeforeAPFs + NumAfterAPFs;
+            maxDelay = (this->sampleRate * this->param__time)/3;
+            for (int i = 0; i < NumBeforeAPFs; i++) {
+                setAPFDelaySamples(this->beforeAPFs[i], detail::reverbDelayIndex(i, totalAPFs, maxDelay));
+            }
+            for (int i = 0; i < NumAfterAPFs; i++) {
+                setAPFDelaySamples(this->afterAPFs[i], detail::reverbDelayIndex(NumBeforeAPFs + i, totalAPFs, maxDelay));
+            }
+        }
+
+        void setDamping(float g) {
+            g = giml::clip<float>(g, 0, 0.97f);
+            this->param__damping = g;
+            for (auto& apf : this->beforeAPFs) { setAPFLPFFeedbackGain(apf, g); }
+            for (auto& apf : this->afterAPFs) { setAPFLPFFeedbackGain(apf, g); }
+        }
+
+        void setBlend(T b) { this->param__blend = giml::clip<T>(b, 0.0, 1.0); }
+
+        // See `Reverb::setRegen()`
+        void setRegen(float regen) {
+            regen = giml::clip<float>(regen, 0, 0.999);
+            this->param__regen = regen;
+            for (int i = 0; i < NumCombFilters; i++) {
+                float g = regen * (1 - ::fabs(this->combFeedbackGains[i]));
+                this->combLPFFeedbackGains[i] = giml::clip<float>(g, 0.f, 0.999f);
+            }
+        }
+
+        // See `Reverb::setRoom()`
+        void setRoom(float length, float absorptionCoefficient = 0.75f, RoomType type = RoomType::SPHERE) {
+            if (length < 0) { length = 0; }
+            this->param__length = length;
+            this->param__absorption = absorptionCoefficient;
+            this->param__roomType = type;
+            this->param__customRoom = nullptr;
+            this->calculateAndSetFeedbackCoefficients(detail::roomRT60(length, absorptionCoefficient, type));
+        }
+
+        void setRoom(CustomRoom* customRoom = nullptr) {
+            this->param__customRoom = customRoom;
+            float RT60 = customRoom->getVolume() / (2 * customRoom->getSurfaceArea() * customRoom->getAbsorptionCoefficient());
+            this->calculateAndSetFeedbackCoefficients(RT60);
+        }
+
+        // See `Reverb::calculateAndSetFeedbackCoefficients()`
+        void calculateAndSetFeedbackCoefficients(float RT60) {
+            for (int i = 0; i < NumCombFilters; i++) {
+                float feedbackGain = ::pow(10, -3 * this->combDelays[i] / (this->sampleRate * RT60));
+                if (feedbackGain > 0.75) { feedbackGain = 0.75; }
+
+                // Flip the phase of every other comb filter
+                if (i % 2) { feedbackGain = -feedbackGain; }
+                this->combFeedbackGains[i] = giml::clip<float>(feedbackGain, 0.f, 0.999f);
+            }
+            this->setRegen(this->param__regen); // the comb LPF gains depend on the new comb gains
+
+            for (int i = 0; i < NumBeforeAPFs; i++) {
+                float delayIndex = this->beforeAPFs[i][0].delaySamples;
+                float feedbackGain = ::powf(10, -3 * delayIndex / (this->sampleRate * RT60))/2;
+                setAPFFeedbackGain(this->beforeAPFs[i], -feedbackGain);
+            }
+            for (int i = 0; i < NumAfterAPFs; i++) {
+                float delayIndex = this->afterAPFs[i][0].delaySamples;
+                float feedbackGain = ::powf(10, -3 * delayIndex / (this->sampleRate * RT60)) / 2;
+                setAPFFeedbackGain(this->afterAPFs[i], -feedbackGain);
+            }
+        }
     };
 } // namespace giml
 
-#endif
\ No newline at end of file
+#endif
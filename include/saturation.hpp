@@ -22,7 +22,7 @@ namespace giml {
         }
         ~Saturation() {}
         //Copy constructor
-        Saturation(const Saturation& s) {
+        Saturation(const Saturation& s) : antiAliasingFilter(s.antiAliasingFilter) {
             this->sampleRate = s.sampleRate;
             this->oversamplingFactor = s.oversamplingFactor;
             this->drive = s.drive;
@@ -43,6 +43,7 @@ namespace giml {
         }
         
         inline T processSample(const T& in) override {
+            GIML_TRACE_SAMPLE_SCOPE("Saturation::processSample");
             if (!(this->enabled)) {
                 return in;
             }
@@ -91,34 +92,23 @@ namespace giml {
                 4. decimate and return
                 */
 
-                T* arrValues = (T*) malloc(this->oversamplingFactor * sizeof(T));
-                //arrValues[this->oversamplingFactor - 1] = in; //Set last value in array to current input
-
                 T delta = (in - prevX) / this->oversamplingFactor;
-
-                
-
+                returnVal = 0;
                 for (int i = 0; i < this->oversamplingFactor; i++) {
-                    arrValues[i] = in * this->preAmpGain + i * delta; //Linear interpolation for each sample (1st is previous real sample and last is current input)
+                    T x = in * this->preAmpGain + i * delta; //Linear interpolation for each sample (1st is previous real sample and last is current input)
                     //TODO: Apply correct distortion function here for each sample
-                    //arrValues[i] = ::tanhf(this->drive * arrValues[i]) / ::tanhf(this->drive);
+                    //x = ::tanhf(this->drive * x) / ::tanhf(this->drive);
 
                     // asymmetrical distortion with 
-                    if (arrValues[i] >= 0) { // if x positive 
-                        arrValues[i] = tanhf(this->drive * arrValues[i]) / tanhf(this->drive);
+                    if (x >= 0) { // if x positive 
+                        x = tanhf(this->drive * x) / tanhf(this->drive);
                     }
                     else { // if x negative 
-                        arrValues[i] = tanhf(3*this->drive * arrValues[i]) / tanhf(3*this->drive);
+                        x = tanhf(3*this->drive * x) / tanhf(3*this->drive);
                     }
 
-
-                    arrValues[i] = this->antiAliasingFilter.processSample(arrValues[i]); //TODO: See if anti-aliasing LPF is actually needed
-                }
-                returnVal = 0;
-                //returnVal = arrValues[this->oversamplingFactor-1];
-                for (int i = 0; i < this->oversamplingFactor; i++) {
                     //TODO: does averaging the values actually act as another low-pass filter?
-                    returnVal += arrValues[i];
+                    returnVal += this->antiAliasingFilter.processSample(x); //TODO: See if anti-aliasing LPF is actually needed
                 }
                 returnVal /= this->oversamplingFactor;
 
@@ -155,12 +145,34 @@ namespace giml {
             this->drive = dBtoA(d);
         }
 
+        /**
+         * @brief memoryless without oversampling, 
+         * otherwise the anti-aliasing filter's tail (in input samples) plus the interpolation's one sample
+         */
+        int getTailSamples() const override {
+            if (this->oversamplingFactor <= 1) { return 0; }
+            int filter = this->antiAliasingFilter.getTailSamples();
+            return (filter < 0) ? -1 : filter / this->oversamplingFactor + 2;
+        }
+
         void setPreAmpGain(float g) {
             if (g == 0) {
                 g += 1e-6;
             }
             this->preAmpGain = dBtoA(g);
         }
+
+        void reset() override {
+            this->prevX = 0;
+            this->antiAliasingFilter.reset();
+        }
+
+        void prepare(int sampleRate, size_t maxBlockSize) override {
+            this->sampleRate = sampleRate;
+            this->antiAliasingFilter.prepare(sampleRate, maxBlockSize);
+            this->antiAliasingFilter.setParams(this->sampleRate * this->oversamplingFactor / 2);
+            this->reset();
+        }
     };
 }
 #endif
\ No newline at end of file
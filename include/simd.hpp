@@ -0,0 +1,709 @@
+#ifndef GIML_SIMD_HPP
+#define GIML_SIMD_HPP
+
+/**
+ * Portable SIMD layer used internally by Gimmel's vectorized code paths.
+ *
+ * Fixed-width float vectors with arithmetic, `min`/`max`/`abs`/`sqrt`/`floor`, comparisons, `select` (blend),
+ * `gather` and `fma`:
+ * - `f32x4`: SSE2 (x86), NEON (ARM) or scalar fallback (e.g. Cortex-M, or `GIML_SIMD_SCALAR`)
+ * - `f32x8`: AVX2 when the translation unit is compiled for it, otherwise two `f32x4`
+ * - `f32x16`: AVX-512 when the translation unit is compiled for it, otherwise two `f32x8`
+ *
+ * All widths are available on every platform, so code written against them is portable; only
+ * the instructions they compile to change. `fma()` is fused where the target has FMA and a
+ * separate multiply and add otherwise, so results may differ in the last bit across targets.
+ *
+ * Block kernels (`giml::simd::kernels()`) come in one table per instruction set. On x86 with
+ * GCC, Clang or MSVC, the AVX2 and AVX-512 tables are compiled regardless of the compiler
+ * flags and the best one the CPU supports is selected once, on first use, so one binary runs
+ * optimally on every machine. Define `GIML_SIMD_NO_DISPATCH` to use only what the compiler
+ * flags allow instead.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+#if !defined(GIML_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GIML_SIMD_SSE2
+#include <immintrin.h>
+#elif !defined(GIML_SIMD_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define GIML_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// x86 kernels for instruction sets beyond the compiler flags (runtime dispatch)
+#if defined(GIML_SIMD_SSE2) && !defined(GIML_SIMD_NO_DISPATCH) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define GIML_SIMD_DISPATCH
+#endif
+
+#if defined(GIML_SIMD_SSE2) && (defined(__AVX2__) || defined(GIML_SIMD_DISPATCH))
+#define GIML_SIMD_HAS_AVX2
+#endif
+#if defined(GIML_SIMD_SSE2) && (defined(__AVX512F__) || defined(GIML_SIMD_DISPATCH))
+#define GIML_SIMD_HAS_AVX512
+#endif
+
+// Function attributes enabling an instruction set for a single function (GCC/Clang),
+// MSVC allows every intrinsic anywhere
+#if defined(GIML_SIMD_DISPATCH) && !defined(_MSC_VER)
+#define GIML_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GIML_SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define GIML_SIMD_FLATTEN __attribute__((flatten))
+#else
+#define GIML_SIMD_TARGET_AVX2
+#define GIML_SIMD_TARGET_AVX512
+#define GIML_SIMD_FLATTEN
+#endif
+
+#if defined(GIML_SIMD_DISPATCH) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace giml {
+    namespace simd {
+        /**
+         * @brief Instruction sets with a kernel table
+         */
+        enum class Isa { Scalar, SSE2, NEON, AVX2, AVX512 };
+
+        inline const char* isaName(Isa isa) {
+            switch (isa) {
+                case Isa::SSE2: return "sse2";
+                case Isa::NEON: return "neon";
+                case Isa::AVX2: return "avx2";
+                case Isa::AVX512: return "avx512";
+                default: return "scalar";
+            }
+        }
+
+        // ===== Scalar fallback =====
+
+        namespace scalar {
+            /**
+             * @brief 4 floats processed one lane at a time, for targets without SIMD
+             */
+            struct f32x4 {
+                static constexpr size_t width = 4;
+                struct mask { bool lanes[4]; };
+                float v[4];
+
+                f32x4() = default;
+                f32x4(float x) { for (int i = 0; i < 4; i++) { this->v[i] = x; } }
+                static f32x4 load(const float* p) { f32x4 r; for (int i = 0; i < 4; i++) { r.v[i] = p[i]; } return r; }
+                void store(float* p) const { for (int i = 0; i < 4; i++) { p[i] = this->v[i]; } }
+                static f32x4 gather(const float* base, const int32_t* indices) {
+                    f32x4 r; for (int i = 0; i < 4; i++) { r.v[i] = base[indices[i]]; } return r;
+                }
+                float operator[](size_t i) const { return this->v[i]; }
+
+#define GIML_SIMD_SCALAR_BINARY(op) \
+                friend f32x4 operator op(f32x4 a, f32x4 b) { for (int i = 0; i < 4; i++) { a.v[i] = a.v[i] op b.v[i]; } return a; }
+                GIML_SIMD_SCALAR_BINARY(+) GIML_SIMD_SCALAR_BINARY(-) GIML_SIMD_SCALAR_BINARY(*) GIML_SIMD_SCALAR_BINARY(/)
+#undef GIML_SIMD_SCALAR_BINARY
+#define GIML_SIMD_SCALAR_COMPARE(op) \
+                friend mask operator op(f32x4 a, f32x4 b) { mask m; for (int i = 0; i < 4; i++) { m.lanes[i] = a.v[i] op b.v[i]; } return m; }
+                GIML_SIMD_SCALAR_COMPARE(<) GIML_SIMD_SCALAR_COMPARE(<=) GIML_SIMD_SCALAR_COMPARE(>) GIML_SIMD_SCALAR_COMPARE(>=)
+#undef GIML_SIMD_SCALAR_COMPARE
+                friend f32x4 operator-(f32x4 a) { for (int i = 0; i < 4; i++) { a.v[i] = -a.v[i]; } return a; }
+                friend f32x4 min(f32x4 a, f32x4 b) { for (int i = 0; i < 4; i++) { a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; } return a; }
+                friend f32x4 max(f32x4 a, f32x4 b) { for (int i = 0; i < 4; i++) { a.v[i] = a.v[i] < b.v[i] ? b.v[i] : a.v[i]; } return a; }
+                friend f32x4 abs(f32x4 a) { for (int i = 0; i < 4; i++) { a.v[i] = ::fabsf(a.v[i]); } return a; }
+                friend f32x4 sqrt(f32x4 a) { for (int i = 0; i < 4; i++) { a.v[i] = ::sqrtf(a.v[i]); } return a; }
+                friend f32x4 floor(f32x4 a) { for (int i = 0; i < 4; i++) { a.v[i] = ::floorf(a.v[i]); } return a; }
+                friend f32x4 fma(f32x4 a, f32x4 b, f32x4 c) { for (int i = 0; i < 4; i++) { a.v[i] = a.v[i] * b.v[i] + c.v[i]; } return a; }
+                friend f32x4 select(mask m, f32x4 a, f32x4 b) { for (int i = 0; i < 4; i++) { a.v[i] = m.lanes[i] ? a.v[i] : b.v[i]; } return a; }
+                friend float reduceAdd(f32x4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+                friend float reduceMax(f32x4 a) {
+                    float r = a.v[0]; for (int i = 1; i < 4; i++) { r = r < a.v[i] ? a.v[i] : r; } return r;
+                }
+            };
+        } // namespace scalar
+
+        // ===== SSE2 =====
+
+#ifdef GIML_SIMD_SSE2
+        namespace sse2 {
+            /**
+             * @brief 4 floats in an SSE register. Uses SSE4.1 blends, FMA and AVX2 gathers
+             * when the translation unit is compiled for them
+             */
+            struct f32x4 {
+                static constexpr size_t width = 4;
+                using mask = __m128;
+                __m128 v;
+
+                f32x4() = default;
+                f32x4(__m128 x) : v(x) {}
+                f32x4(float x) : v(_mm_set1_ps(x)) {}
+                static f32x4 load(const float* p) { return _mm_loadu_ps(p); }
+                void store(float* p) const { _mm_storeu_ps(p, this->v); }
+                static f32x4 gather(const float* base, const int32_t* indices) {
+#ifdef __AVX2__
+                    return _mm_i32gather_ps(base, _mm_loadu_si128((const __m128i*)indices), 4);
+#else
+                    return _mm_setr_ps(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+#endif
+                }
+                float operator[](size_t i) const { float lanes[4]; this->store(lanes); return lanes[i]; }
+
+                friend f32x4 operator+(f32x4 a, f32x4 b) { return _mm_add_ps(a.v, b.v); }
+                friend f32x4 operator-(f32x4 a, f32x4 b) { return _mm_sub_ps(a.v, b.v); }
+                friend f32x4 operator*(f32x4 a, f32x4 b) { return _mm_mul_ps(a.v, b.v); }
+                friend f32x4 operator/(f32x4 a, f32x4 b) { return _mm_div_ps(a.v, b.v); }
+                friend f32x4 operator-(f32x4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.f)); }
+                friend mask operator<(f32x4 a, f32x4 b) { return _mm_cmplt_ps(a.v, b.v); }
+                friend mask operator<=(f32x4 a, f32x4 b) { return _mm_cmple_ps(a.v, b.v); }
+                friend mask operator>(f32x4 a, f32x4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+                friend mask operator>=(f32x4 a, f32x4 b) { return _mm_cmpge_ps(a.v, b.v); }
+                friend f32x4 min(f32x4 a, f32x4 b) { return _mm_min_ps(a.v, b.v); }
+                friend f32x4 max(f32x4 a, f32x4 b) { return _mm_max_ps(a.v, b.v); }
+                friend f32x4 abs(f32x4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+                friend f32x4 sqrt(f32x4 a) { return _mm_sqrt_ps(a.v); }
+                friend f32x4 floor(f32x4 a) { // without SSE4.1, exact for |a| < 2^31
+#ifdef __SSE4_1__
+                    return _mm_floor_ps(a.v);
+#else
+                    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+                    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.f)));
+#endif
+                }
+                friend f32x4 fma(f32x4 a, f32x4 b, f32x4 c) {
+#ifdef __FMA__
+                    return _mm_fmadd_ps(a.v, b.v, c.v);
+#else
+                    return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v);
+#endif
+                }
+                friend f32x4 select(mask m, f32x4 a, f32x4 b) {
+#ifdef __SSE4_1__
+                    return _mm_blendv_ps(b.v, a.v, m);
+#else
+                    return _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v));
+#endif
+                }
+                friend float reduceAdd(f32x4 a) {
+                    __m128 pairs = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+                    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+                }
+                friend float reduceMax(f32x4 a) {
+                    __m128 pairs = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));
+                    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+                }
+            };
+        } // namespace sse2
+#endif
+
+        // ===== NEON =====
+
+#ifdef GIML_SIMD_NEON
+        namespace neon {
+            /**
+             * @brief 4 floats in a NEON register. Division, square root and FMA are exact on AArch64;
+             * 32-bit ARM uses refined reciprocal estimates and, without VFPv4, an unfused multiply-add
+             */
+            struct f32x4 {
+                static constexpr size_t width = 4;
+                using mask = uint32x4_t;
+                float32x4_t v;
+
+                f32x4() = default;
+                f32x4(float32x4_t x) : v(x) {}
+                f32x4(float x) : v(vdupq_n_f32(x)) {}
+                static f32x4 load(const float* p) { return vld1q_f32(p); }
+                void store(float* p) const { vst1q_f32(p, this->v); }
+                static f32x4 gather(const float* base, const int32_t* indices) {
+                    float lanes[4] = { base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]] };
+                    return vld1q_f32(lanes);
+                }
+                float operator[](size_t i) const { float lanes[4]; this->store(lanes); return lanes[i]; }
+
+                friend f32x4 operator+(f32x4 a, f32x4 b) { return vaddq_f32(a.v, b.v); }
+                friend f32x4 operator-(f32x4 a, f32x4 b) { return vsubq_f32(a.v, b.v); }
+                friend f32x4 operator*(f32x4 a, f32x4 b) { return vmulq_f32(a.v, b.v); }
+                friend f32x4 operator/(f32x4 a, f32x4 b) {
+#ifdef __aarch64__
+                    return vdivq_f32(a.v, b.v);
+#else
+                    float32x4_t r = vrecpeq_f32(b.v);
+                    r = vmulq_f32(vrecpsq_f32(b.v, r), r); // two Newton-Raphson steps
+                    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+                    return vmulq_f32(a.v, r);
+#endif
+                }
+                friend f32x4 operator-(f32x4 a) { return vnegq_f32(a.v); }
+                friend mask operator<(f32x4 a, f32x4 b) { return vcltq_f32(a.v, b.v); }
+                friend mask operator<=(f32x4 a, f32x4 b) { return vcleq_f32(a.v, b.v); }
+                friend mask operator>(f32x4 a, f32x4 b) { return vcgtq_f32(a.v, b.v); }
+                friend mask operator>=(f32x4 a, f32x4 b) { return vcgeq_f32(a.v, b.v); }
+                friend f32x4 min(f32x4 a, f32x4 b) { return vminq_f32(a.v, b.v); }
+                friend f32x4 max(f32x4 a, f32x4 b) { return vmaxq_f32(a.v, b.v); }
+                friend f32x4 abs(f32x4 a) { return vabsq_f32(a.v); }
+                friend f32x4 sqrt(f32x4 a) {
+#ifdef __aarch64__
+                    return vsqrtq_f32(a.v);
+#else
+                    float32x4_t r = vrsqrteq_f32(a.v); // refined reciprocal square root estimate
+                    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+                    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+                    return vbslq_f32(vceqq_f32(a.v, vdupq_n_f32(0.f)), a.v, vmulq_f32(a.v, r)); // sqrt(0) = 0, not 0 * inf
+#endif
+                }
+                friend f32x4 floor(f32x4 a) { // on 32-bit ARM, exact for |a| < 2^31
+#ifdef __aarch64__
+                    return vrndmq_f32(a.v);
+#else
+                    float32x4_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(a.v));
+                    uint32x4_t above = vcgtq_f32(truncated, a.v);
+                    return vsubq_f32(truncated, vreinterpretq_f32_u32(vandq_u32(above, vreinterpretq_u32_f32(vdupq_n_f32(1.f)))));
+#endif
+                }
+                friend f32x4 fma(f32x4 a, f32x4 b, f32x4 c) {
+#if defined(__aarch64__) || defined(__ARM_FEATURE_FMA)
+                    return vfmaq_f32(c.v, a.v, b.v);
+#else
+                    return vmlaq_f32(c.v, a.v, b.v);
+#endif
+                }
+                friend f32x4 select(mask m, f32x4 a, f32x4 b) { return vbslq_f32(m, a.v, b.v); }
+                friend float reduceAdd(f32x4 a) {
+                    float32x2_t pairs = vadd_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+                    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+                }
+                friend float reduceMax(f32x4 a) {
+                    float32x2_t pairs = vmax_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+                    return vget_lane_f32(vpmax_f32(pairs, pairs), 0);
+                }
+            };
+        } // namespace neon
+#endif
+
+        // ===== AVX2 =====
+
+#ifdef GIML_SIMD_HAS_AVX2
+        namespace avx2 {
+            /**
+             * @brief 8 floats in an AVX register. Only usable on CPUs with AVX2 and FMA, see `supported()`
+             */
+            struct f32x8 {
+                static constexpr size_t width = 8;
+                using mask = __m256;
+                __m256 v;
+
+                f32x8() = default;
+                GIML_SIMD_TARGET_AVX2 f32x8(__m256 x) : v(x) {}
+                GIML_SIMD_TARGET_AVX2 f32x8(float x) : v(_mm256_set1_ps(x)) {}
+                GIML_SIMD_TARGET_AVX2 static f32x8 load(const float* p) { return _mm256_loadu_ps(p); }
+                GIML_SIMD_TARGET_AVX2 void store(float* p) const { _mm256_storeu_ps(p, this->v); }
+                GIML_SIMD_TARGET_AVX2 static f32x8 gather(const float* base, const int32_t* indices) {
+                    return _mm256_i32gather_ps(base, _mm256_loadu_si256((const __m256i*)indices), 4);
+                }
+                GIML_SIMD_TARGET_AVX2 float operator[](size_t i) const { float lanes[8]; this->store(lanes); return lanes[i]; }
+
+                GIML_SIMD_TARGET_AVX2 friend f32x8 operator+(f32x8 a, f32x8 b) { return _mm256_add_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 operator-(f32x8 a, f32x8 b) { return _mm256_sub_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 operator*(f32x8 a, f32x8 b) { return _mm256_mul_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 operator/(f32x8 a, f32x8 b) { return _mm256_div_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 operator-(f32x8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.f)); }
+                GIML_SIMD_TARGET_AVX2 friend mask operator<(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+                GIML_SIMD_TARGET_AVX2 friend mask operator<=(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+                GIML_SIMD_TARGET_AVX2 friend mask operator>(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+                GIML_SIMD_TARGET_AVX2 friend mask operator>=(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 min(f32x8 a, f32x8 b) { return _mm256_min_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 max(f32x8 a, f32x8 b) { return _mm256_max_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 abs(f32x8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 sqrt(f32x8 a) { return _mm256_sqrt_ps(a.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 floor(f32x8 a) { return _mm256_floor_ps(a.v); }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 fma(f32x8 a, f32x8 b, f32x8 c) {
+#if defined(__FMA__) || defined(GIML_SIMD_DISPATCH) || defined(_MSC_VER) // the dispatch target enables FMA
+                    return _mm256_fmadd_ps(a.v, b.v, c.v);
+#else
+                    return _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v);
+#endif
+                }
+                GIML_SIMD_TARGET_AVX2 friend f32x8 select(mask m, f32x8 a, f32x8 b) { return _mm256_blendv_ps(b.v, a.v, m); }
+                GIML_SIMD_TARGET_AVX2 friend float reduceAdd(f32x8 a) {
+                    __m128 quad = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+                    __m128 pairs = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+                    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+                }
+                GIML_SIMD_TARGET_AVX2 friend float reduceMax(f32x8 a) {
+                    __m128 quad = _mm_max_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+                    __m128 pairs = _mm_max_ps(quad, _mm_movehl_ps(quad, quad));
+                    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+                }
+            };
+        } // namespace avx2
+#endif
+
+        // ===== AVX-512 =====
+
+#ifdef GIML_SIMD_HAS_AVX512
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized" // false positives in GCC 12's avx512fintrin.h
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+        namespace avx512 {
+            /**
+             * @brief 16 floats in an AVX-512 register (AVX-512F only). Only usable on CPUs with AVX-512F,
+             * see `supported()`
+             */
+            struct f32x16 {
+                static constexpr size_t width = 16;
+                using mask = __mmask16;
+                __m512 v;
+
+                f32x16() = default;
+                GIML_SIMD_TARGET_AVX512 f32x16(__m512 x) : v(x) {}
+                GIML_SIMD_TARGET_AVX512 f32x16(float x) : v(_mm512_set1_ps(x)) {}
+                GIML_SIMD_TARGET_AVX512 static f32x16 load(const float* p) { return _mm512_loadu_ps(p); }
+                GIML_SIMD_TARGET_AVX512 void store(float* p) const { _mm512_storeu_ps(p, this->v); }
+                GIML_SIMD_TARGET_AVX512 static f32x16 gather(const float* base, const int32_t* indices) {
+                    return _mm512_i32gather_ps(_mm512_loadu_si512(indices), base, 4);
+                }
+                GIML_SIMD_TARGET_AVX512 float operator[](size_t i) const { float lanes[16]; this->store(lanes); return lanes[i]; }
+
+                GIML_SIMD_TARGET_AVX512 friend f32x16 operator+(f32x16 a, f32x16 b) { return _mm512_add_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 operator-(f32x16 a, f32x16 b) { return _mm512_sub_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 operator*(f32x16 a, f32x16 b) { return _mm512_mul_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 operator/(f32x16 a, f32x16 b) { return _mm512_div_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 operator-(f32x16 a) { return _mm512_sub_ps(_mm512_setzero_ps(), a.v); }
+                GIML_SIMD_TARGET_AVX512 friend mask operator<(f32x16 a, f32x16 b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+                GIML_SIMD_TARGET_AVX512 friend mask operator<=(f32x16 a, f32x16 b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ); }
+                GIML_SIMD_TARGET_AVX512 friend mask operator>(f32x16 a, f32x16 b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+                GIML_SIMD_TARGET_AVX512 friend mask operator>=(f32x16 a, f32x16 b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 min(f32x16 a, f32x16 b) { return _mm512_min_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 max(f32x16 a, f32x16 b) { return _mm512_max_ps(a.v, b.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 abs(f32x16 a) { return _mm512_abs_ps(a.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 sqrt(f32x16 a) { return _mm512_sqrt_ps(a.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 floor(f32x16 a) { return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 fma(f32x16 a, f32x16 b, f32x16 c) { return _mm512_fmadd_ps(a.v, b.v, c.v); }
+                GIML_SIMD_TARGET_AVX512 friend f32x16 select(mask m, f32x16 a, f32x16 b) { return _mm512_mask_blend_ps(m, b.v, a.v); }
+                GIML_SIMD_TARGET_AVX512 friend float reduceAdd(f32x16 a) { return _mm512_reduce_add_ps(a.v); }
+                GIML_SIMD_TARGET_AVX512 friend float reduceMax(f32x16 a) { return _mm512_reduce_max_ps(a.v); }
+            };
+        } // namespace avx512
+#endif
+
+        // ===== Wide fallback =====
+
+        /**
+         * @brief Twice the width of `Half`, for instruction sets without registers that wide
+         */
+        template <typename Half>
+        struct wide {
+            static constexpr size_t width = 2 * Half::width;
+            struct mask { typename Half::mask lo, hi; };
+            Half lo, hi;
+
+            wide() = default;
+            wide(Half l, Half h) : lo(l), hi(h) {}
+            wide(float x) : lo(x), hi(x) {}
+            static wide load(const float* p) { return wide(Half::load(p), Half::load(p + Half::width)); }
+            void store(float* p) const { this->lo.store(p); this->hi.store(p + Half::width); }
+            static wide gather(const float* base, const int32_t* indices) {
+                return wide(Half::gather(base, indices), Half::gather(base, indices + Half::width));
+            }
+            float operator[](size_t i) const { return i < Half::width ? this->lo[i] : this->hi[i - Half::width]; }
+
+            friend wide operator+(wide a, wide b) { return wide(a.lo + b.lo, a.hi + b.hi); }
+            friend wide operator-(wide a, wide b) { return wide(a.lo - b.lo, a.hi - b.hi); }
+            friend wide operator*(wide a, wide b) { return wide(a.lo * b.lo, a.hi * b.hi); }
+            friend wide operator/(wide a, wide b) { return wide(a.lo / b.lo, a.hi / b.hi); }
+            friend wide operator-(wide a) { return wide(-a.lo, -a.hi); }
+            friend mask operator<(wide a, wide b) { return mask{ a.lo < b.lo, a.hi < b.hi }; }
+            friend mask operator<=(wide a, wide b) { return mask{ a.lo <= b.lo, a.hi <= b.hi }; }
+            friend mask operator>(wide a, wide b) { return mask{ a.lo > b.lo, a.hi > b.hi }; }
+            friend mask operator>=(wide a, wide b) { return mask{ a.lo >= b.lo, a.hi >= b.hi }; }
+            friend wide min(wide a, wide b) { return wide(min(a.lo, b.lo), min(a.hi, b.hi)); }
+            friend wide max(wide a, wide b) { return wide(max(a.lo, b.lo), max(a.hi, b.hi)); }
+            friend wide abs(wide a) { return wide(abs(a.lo), abs(a.hi)); }
+            friend wide sqrt(wide a) { return wide(sqrt(a.lo), sqrt(a.hi)); }
+            friend wide floor(wide a) { return wide(floor(a.lo), floor(a.hi)); }
+            friend wide fma(wide a, wide b, wide c) { return wide(fma(a.lo, b.lo, c.lo), fma(a.hi, b.hi, c.hi)); }
+            friend wide select(mask m, wide a, wide b) { return wide(select(m.lo, a.lo, b.lo), select(m.hi, a.hi, b.hi)); }
+            friend float reduceAdd(wide a) { return reduceAdd(a.lo + a.hi); }
+            friend float reduceMax(wide a) { return reduceMax(max(a.lo, a.hi)); }
+        };
+
+        // ===== Widths for the compiler flags =====
+
+#if defined(GIML_SIMD_SSE2)
+        using f32x4 = sse2::f32x4;
+        constexpr Isa nativeIsa = Isa::SSE2;
+#elif defined(GIML_SIMD_NEON)
+        using f32x4 = neon::f32x4;
+        constexpr Isa nativeIsa = Isa::NEON;
+#else
+        using f32x4 = scalar::f32x4;
+        constexpr Isa nativeIsa = Isa::Scalar;
+#endif
+
+#ifdef __AVX2__
+        using f32x8 = avx2::f32x8;
+#else
+        using f32x8 = wide<f32x4>;
+#endif
+
+#ifdef __AVX512F__
+        using f32x16 = avx512::f32x16;
+#else
+        using f32x16 = wide<f32x8>;
+#endif
+
+        // ===== Block kernels =====
+
+        /**
+         * @brief Block kernels of one instruction set. Arrays need no particular alignment
+         * and may have any length
+         */
+        struct Kernels {
+            Isa isa;
+            void (*scale)(float* x, size_t n, float gain); // x *= gain
+            void (*mulAdd)(float* y, const float* x, size_t n, float gain); // y += x * gain
+            void (*clamp)(float* x, size_t n, float lo, float hi); // x = clip(x, lo, hi)
+            float (*peak)(const float* x, size_t n); // max |x|, 0 for an empty block
+            void (*gather)(float* y, const float* base, const int32_t* indices, size_t n); // y = base[indices]
+            void (*phasor)(float* y, size_t n, double phase, double increment); // y[i] = frac(phase + (i + 1) * increment)
+            void (*sine)(float* x, size_t n); // x = sin(2pi * x), polynomial, |error| < 5e-7
+            void (*wavetable)(float* x, size_t n, const float* table, size_t size); // x = table at phase frac(x), see `kernel::wavetable()`
+        };
+
+        namespace kernel {
+            // Generic kernel bodies: full vectors of `V` up to `end` (so the compiler can tell `i` never passes `n`),
+            // then the remainder one sample at a time
+
+            template <typename V>
+            inline void scale(float* x, size_t n, float gain) {
+                size_t i = 0, end = n - n % V::width;
+                for (; i < end; i += V::width) { (V::load(x + i) * V(gain)).store(x + i); }
+                for (; i < n; i++) { x[i] *= gain; }
+            }
+
+            template <typename V>
+            inline void mulAdd(float* y, const float* x, size_t n, float gain) {
+                size_t i = 0, end = n - n % V::width;
+                for (; i < end; i += V::width) { fma(V::load(x + i), V(gain), V::load(y + i)).store(y + i); }
+                for (; i < n; i++) { y[i] += x[i] * gain; }
+            }
+
+            template <typename V>
+            inline void clamp(float* x, size_t n, float lo, float hi) {
+                size_t i = 0, end = n - n % V::width;
+                for (; i < end; i += V::width) { min(max(V::load(x + i), V(lo)), V(hi)).store(x + i); }
+                for (; i < n; i++) { x[i] = x[i] < lo ? lo : (x[i] > hi ? hi : x[i]); }
+            }
+
+            template <typename V>
+            inline float peak(const float* x, size_t n) {
+                size_t i = 0, end = n - n % V::width;
+                float result = 0.f;
+                if (end > 0) {
+                    V acc = V(0.f);
+                    for (; i < end; i += V::width) { acc = max(acc, abs(V::load(x + i))); }
+                    result = reduceMax(acc);
+                }
+                for (; i < n; i++) { result = ::fabsf(x[i]) > result ? ::fabsf(x[i]) : result; }
+                return result;
+            }
+
+            template <typename V>
+            inline void gather(float* y, const float* base, const int32_t* indices, size_t n) {
+                size_t i = 0, end = n - n % V::width;
+                for (; i < end; i += V::width) { V::gather(base, indices + i).store(y + i); }
+                for (; i < n; i++) { y[i] = base[indices[i]]; }
+            }
+
+            // The oscillator kernels run their last partial vector zero-padded, so that every sample
+            // goes through the same vector code (the remainder matches the lanes bit for bit)
+
+            template <typename V>
+            inline V loadPartial(const float* x, size_t n) {
+                float lanes[V::width] = {};
+                for (size_t l = 0; l < n; l++) { lanes[l] = x[l]; }
+                return V::load(lanes);
+            }
+
+            template <typename V>
+            inline void storePartial(const V& v, float* x, size_t n) {
+                float lanes[V::width];
+                v.store(lanes);
+                for (size_t l = 0; l < n; l++) { x[l] = lanes[l]; }
+            }
+
+            template <typename V>
+            inline void phasor(float* y, size_t n, double phase, double increment) {
+                float offsets[V::width];
+                for (size_t l = 0; l < V::width; l++) { offsets[l] = (float)((l + 1) * increment); }
+                V ramp = V::load(offsets);
+                for (size_t i = 0; i < n; i += V::width) {
+                    double base = phase + i * increment; // in double: no drift over long blocks
+                    V x = V((float)(base - ::floor(base))) + ramp;
+                    x = x - floor(x);
+                    if (i + V::width <= n) { x.store(y + i); }
+                    else { storePartial(x, y + i, n - i); }
+                }
+            }
+
+            /**
+             * @brief `sin(2pi * x)`: `x` folded to a quarter cycle around 0 (a triangle wave of `x`, which has the same sine),
+             * then the odd Taylor polynomial to `x^11` in Horner form
+             */
+            template <typename V>
+            inline V sinCycles(const V& x) {
+                V shifted = x + V(0.25f);
+                V t = V(0.25f) - abs(shifted - floor(shifted) - V(0.5f)); // [-1/4, 1/4]
+                V t2 = t * t;
+                V p = fma(t2, V(-15.094642576822984f), V(42.058693944897634f));
+                p = fma(t2, p, V(-76.70585975306136f));
+                p = fma(t2, p, V(81.60524927607504f));
+                p = fma(t2, p, V(-41.341702240399755f));
+                p = fma(t2, p, V(6.283185307179586f));
+                return t * p;
+            }
+
+            template <typename V>
+            inline void sine(float* x, size_t n) {
+                size_t i = 0;
+                for (; i + V::width <= n; i += V::width) { sinCycles(V::load(x + i)).store(x + i); }
+                if (i < n) { storePartial(sinCycles(loadPartial<V>(x + i, n - i)), x + i, n - i); }
+            }
+
+            /**
+             * @brief One cycle of `table` (`size` samples plus a guard sample `table[size] == table[0]`)
+             * at phase `frac(x)`, linearly interpolated
+             */
+            template <typename V>
+            inline V wavetableLookup(const V& x, const float* table, size_t size) {
+                V position = (x - floor(x)) * V((float)size);
+                V index = min(floor(position), V((float)(size - 1))); // `position` may round up to `size`
+                float lanes[V::width];
+                int32_t indices[V::width];
+                index.store(lanes);
+                for (size_t l = 0; l < V::width; l++) { indices[l] = (int32_t)lanes[l]; }
+                V a = V::gather(table, indices), b = V::gather(table + 1, indices);
+                return fma(position - index, b - a, a);
+            }
+
+            template <typename V>
+            inline void wavetable(float* x, size_t n, const float* table, size_t size) {
+                size_t i = 0;
+                for (; i + V::width <= n; i += V::width) { wavetableLookup(V::load(x + i), table, size).store(x + i); }
+                if (i < n) { storePartial(wavetableLookup(loadPartial<V>(x + i, n - i), table, size), x + i, n - i); }
+            }
+
+            /**
+             * @brief Instantiates the generic kernels for one vector type. `flatten` inlines the
+             * vector operations into the instruction-set-specific entry points
+             */
+#define GIML_SIMD_KERNEL_TABLE(name, V, ISA, TARGET) \
+            TARGET GIML_SIMD_FLATTEN inline void name##Scale(float* x, size_t n, float g) { scale<V>(x, n, g); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##MulAdd(float* y, const float* x, size_t n, float g) { mulAdd<V>(y, x, n, g); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##Clamp(float* x, size_t n, float lo, float hi) { clamp<V>(x, n, lo, hi); } \
+            TARGET GIML_SIMD_FLATTEN inline float name##Peak(const float* x, size_t n) { return peak<V>(x, n); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##Gather(float* y, const float* b, const int32_t* idx, size_t n) { gather<V>(y, b, idx, n); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##Phasor(float* y, size_t n, double p, double inc) { phasor<V>(y, n, p, inc); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##Sine(float* x, size_t n) { sine<V>(x, n); } \
+            TARGET GIML_SIMD_FLATTEN inline void name##Wavetable(float* x, size_t n, const float* t, size_t size) { wavetable<V>(x, n, t, size); } \
+            inline constexpr Kernels name##Table = { ISA, name##Scale, name##MulAdd, name##Clamp, name##Peak, name##Gather, \
+                                                     name##Phasor, name##Sine, name##Wavetable };
+
+            GIML_SIMD_KERNEL_TABLE(scalar, scalar::f32x4, Isa::Scalar, )
+#if defined(GIML_SIMD_SSE2)
+            GIML_SIMD_KERNEL_TABLE(sse2, sse2::f32x4, Isa::SSE2, )
+#elif defined(GIML_SIMD_NEON)
+            GIML_SIMD_KERNEL_TABLE(neon, neon::f32x4, Isa::NEON, )
+#endif
+#ifdef GIML_SIMD_HAS_AVX2
+            GIML_SIMD_KERNEL_TABLE(avx2, avx2::f32x8, Isa::AVX2, GIML_SIMD_TARGET_AVX2)
+#endif
+#ifdef GIML_SIMD_HAS_AVX512
+            GIML_SIMD_KERNEL_TABLE(avx512, avx512::f32x16, Isa::AVX512, GIML_SIMD_TARGET_AVX512)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+#undef GIML_SIMD_KERNEL_TABLE
+        } // namespace kernel
+
+        // ===== Dispatch =====
+
+        /**
+         * @brief Whether the running CPU (and OS) supports `isa`
+         */
+        inline bool supported(Isa isa) {
+            switch (isa) {
+                case Isa::Scalar: return true;
+                case Isa::SSE2: return nativeIsa == Isa::SSE2;
+                case Isa::NEON: return nativeIsa == Isa::NEON;
+#if defined(__AVX2__) && defined(__FMA__)
+                case Isa::AVX2: return true;
+#elif defined(GIML_SIMD_HAS_AVX2) && defined(_MSC_VER)
+                case Isa::AVX2: {
+                    int info[4];
+                    __cpuidex(info, 1, 0);
+                    bool fma = info[2] & (1 << 12), osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+                    if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) { return false; } // YMM state enabled by the OS
+                    __cpuidex(info, 7, 0);
+                    return info[1] & (1 << 5);
+                }
+#elif defined(GIML_SIMD_HAS_AVX2)
+                case Isa::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#if defined(__AVX512F__)
+                case Isa::AVX512: return true;
+#elif defined(GIML_SIMD_HAS_AVX512) && defined(_MSC_VER)
+                case Isa::AVX512: {
+                    if (!supported(Isa::AVX2) || (_xgetbv(0) & 0xe6) != 0xe6) { return false; } // ZMM state enabled by the OS
+                    int info[4];
+                    __cpuidex(info, 7, 0);
+                    return info[1] & (1 << 16);
+                }
+#elif defined(GIML_SIMD_HAS_AVX512)
+                case Isa::AVX512: return supported(Isa::AVX2) && __builtin_cpu_supports("avx512f");
+#endif
+                default: return false;
+            }
+        }
+
+        /**
+         * @brief Kernel table of `isa`, or `nullptr` if it isn't compiled in or the CPU doesn't support it
+         */
+        inline const Kernels* kernelsFor(Isa isa) {
+            if (!supported(isa)) { return nullptr; }
+            switch (isa) {
+                case Isa::Scalar: return &kernel::scalarTable;
+#if defined(GIML_SIMD_SSE2)
+                case Isa::SSE2: return &kernel::sse2Table;
+#elif defined(GIML_SIMD_NEON)
+                case Isa::NEON: return &kernel::neonTable;
+#endif
+#ifdef GIML_SIMD_HAS_AVX2
+                case Isa::AVX2: return &kernel::avx2Table;
+#endif
+#ifdef GIML_SIMD_HAS_AVX512
+                case Isa::AVX512: return &kernel::avx512Table;
+#endif
+                default: return nullptr;
+            }
+        }
+
+        /**
+         * @brief Best kernel table for the running CPU, selected once on first use (thread-safe)
+         */
+        inline const Kernels& kernels() {
+            static const Kernels* best = [] {
+                const Isa preferred[] = { Isa::AVX512, Isa::AVX2, Isa::SSE2, Isa::NEON };
+                for (Isa isa : preferred) {
+                    if (const Kernels* table = kernelsFor(isa)) { return table; }
+                }
+                return &kernel::scalarTable;
+            }();
+            return *best;
+        }
+    } // namespace simd
+} // namespace giml
+
+#endif
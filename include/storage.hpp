@@ -0,0 +1,139 @@
+#ifndef GIML_STORAGE_HPP
+#define GIML_STORAGE_HPP
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace giml {
+    /**
+     * @brief IEEE 754 half-precision storage (1 sign, 5 exponent and 10 mantissa bits).
+     * Only a storage format: samples are converted to and from `float` on write and read
+     */
+    struct half { uint16_t bits; };
+
+    /**
+     * @brief bfloat16 storage: the top half of a `float` (1 sign, 8 exponent and 7 mantissa bits),
+     * same range as `float` with less precision than `half`
+     */
+    struct bfloat16 { uint16_t bits; };
+
+    namespace detail {
+        inline uint32_t floatBits(float f) { uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+        inline float bitsFloat(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+
+        /**
+         * @brief `float` to `half`, rounding to nearest even.
+         * Uses F16C (`-mf16c`) or the ARM half-precision type when available,
+         * otherwise the bit-exact software conversion of F. Giesen's `float_to_half_fast3_rtne`
+         */
+        inline uint16_t floatToHalf(float f) {
+#if defined(__F16C__)
+            return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#elif defined(__ARM_FP16_FORMAT_IEEE)
+            __fp16 h = f;
+            uint16_t bits;
+            memcpy(&bits, &h, sizeof(bits));
+            return bits;
+#else
+            uint32_t u = floatBits(f);
+            uint32_t sign = u & 0x80000000u;
+            u ^= sign;
+            uint16_t h;
+            if (u >= (143u << 23)) { h = (u > (255u << 23)) ? 0x7e00 : 0x7c00; } // overflow to inf, NaN stays NaN
+            else if (u < (113u << 23)) { // subnormal or zero, let the FPU round the mantissa
+                const float magic = bitsFloat(126u << 23);
+                h = (uint16_t)(floatBits(bitsFloat(u) + magic) - floatBits(magic));
+            }
+            else {
+                uint32_t mantissaOdd = (u >> 13) & 1;
+                u += ((uint32_t)(15 - 127) << 23) + 0xfff + mantissaOdd; // rebias, round to nearest even
+                h = (uint16_t)(u >> 13);
+            }
+            return h | (uint16_t)(sign >> 16);
+#endif
+        }
+
+        /**
+         * @brief `half` to `float`, exact
+         */
+        inline float halfToFloat(uint16_t h) {
+#if defined(__F16C__)
+            return _cvtsh_ss(h);
+#elif defined(__ARM_FP16_FORMAT_IEEE)
+            __fp16 f;
+            memcpy(&f, &h, sizeof(h));
+            return f;
+#else
+            const uint32_t exponentMask = 0x7c00u << 13;
+            uint32_t u = (uint32_t)(h & 0x7fff) << 13;
+            uint32_t exponent = u & exponentMask;
+            u += (127u - 15u) << 23; // rebias
+            if (exponent == exponentMask) { u += (128u - 16u) << 23; } // inf or NaN
+            else if (exponent == 0) { // subnormal or zero, renormalize
+                u += 1u << 23;
+                u = floatBits(bitsFloat(u) - bitsFloat(113u << 23));
+            }
+            return bitsFloat(u | ((uint32_t)(h & 0x8000) << 16));
+#endif
+        }
+    } // namespace detail
+
+    /**
+     * @brief Converts samples of type `T` to the storage type of a delay line and back.
+     * `StorageT == T` stores samples as they are, the reduced-precision formats
+     * (`int16_t`, `half`, `bfloat16`) halve the memory and bandwidth of a `float` delay line
+     */
+    template <typename T, typename StorageT>
+    struct storage_codec {
+        static_assert(std::is_same<T, StorageT>::value, "no conversion between this sample type and storage type");
+        static StorageT encode(T x) { return x; }
+        static T decode(StorageT x) { return x; }
+    };
+
+    /**
+     * @brief 16-bit integer storage, full scale is `[-1, 1)`: louder samples clip,
+     * so leave headroom for recirculating delay lines that build up above the input level.
+     * Noise floor around -101 dBFS
+     */
+    template <typename T>
+    struct storage_codec<T, int16_t> {
+        static_assert(std::is_floating_point<T>::value, "int16_t storage needs a floating-point sample type");
+        static int16_t encode(T x) {
+            float scaled = (float)x * 32768.f;
+            scaled = (scaled > 32767.f) ? 32767.f : ((scaled < -32768.f) ? -32768.f : scaled);
+            return (int16_t)(scaled + ((scaled < 0.f) ? -0.5f : 0.5f)); // round to nearest
+        }
+        static T decode(int16_t x) { return (T)(x * (1.f / 32768.f)); }
+    };
+
+    /**
+     * @brief half-precision storage, 11 significant bits (noise about 80 dB below the signal)
+     * down to 6e-5, up to 65504
+     */
+    template <typename T>
+    struct storage_codec<T, half> {
+        static_assert(std::is_floating_point<T>::value, "half storage needs a floating-point sample type");
+        static half encode(T x) { return half{ detail::floatToHalf((float)x) }; }
+        static T decode(half x) { return (T)detail::halfToFloat(x.bits); }
+    };
+
+    /**
+     * @brief bfloat16 storage, 8 significant bits (noise about 63 dB below the signal), `float`'s range
+     */
+    template <typename T>
+    struct storage_codec<T, bfloat16> {
+        static_assert(std::is_floating_point<T>::value, "bfloat16 storage needs a floating-point sample type");
+        static bfloat16 encode(T x) {
+            uint32_t u = detail::floatBits((float)x);
+            if ((u & 0x7fffffffu) > 0x7f800000u) { return bfloat16{ (uint16_t)((u >> 16) | 0x40) }; } // keep NaN quiet
+            u += 0x7fffu + ((u >> 16) & 1); // round to nearest even
+            return bfloat16{ (uint16_t)(u >> 16) };
+        }
+        static T decode(bfloat16 x) { return (T)detail::bitsFloat((uint32_t)x.bits << 16); }
+    };
+} // namespace giml
+
+#endif
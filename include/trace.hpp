@@ -0,0 +1,141 @@
+#ifndef GIML_TRACE_HPP
+#define GIML_TRACE_HPP
+
+/**
+ * Tracing hooks for timeline profiling.
+ *
+ * Compile with `GIML_TRACE` defined to record trace scopes around block processing,
+ * parameter setters and heavy internal steps (e.g. `Reverb::setTime()`).
+ * Define `GIML_TRACE_SAMPLES` as well to also trace every `processSample()` call
+ * (very high event rate, expect the ring to wrap quickly).
+ *
+ * Events are written to a preallocated lock-free ring (`GIML_TRACE_CAPACITY` events,
+ * oldest are overwritten) and can be dumped offline as Chrome/Perfetto trace JSON
+ * with `giml::trace::writeChromeJSON()`, viewable in `chrome://tracing` or https://ui.perfetto.dev
+ *
+ * When `GIML_TRACE` is not defined every macro expands to nothing.
+ */
+
+#ifdef GIML_TRACE
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#ifndef GIML_TRACE_CAPACITY
+#define GIML_TRACE_CAPACITY 65536 // must be a power of 2
+#endif
+
+namespace giml {
+    namespace trace {
+        static_assert((GIML_TRACE_CAPACITY & (GIML_TRACE_CAPACITY - 1)) == 0, "GIML_TRACE_CAPACITY must be a power of 2");
+
+        /**
+         * @brief A single complete ("X") trace event
+         */
+        struct Event {
+            const char* name; // must point to a string literal (stored, not copied)
+            int64_t startNanos;
+            int64_t durationNanos;
+            int32_t threadId;
+            int32_t arg; // optional integer argument, -1 for none
+        };
+
+        // Preallocated ring, no allocation happens while tracing
+        inline Event events[GIML_TRACE_CAPACITY];
+        inline std::atomic<uint64_t> eventCount{0};
+
+        inline int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * @brief small sequential id for the calling thread
+         */
+        inline int32_t threadId() {
+            static std::atomic<int32_t> nextId{1};
+            thread_local int32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+            return id;
+        }
+
+        /**
+         * @brief Records an event. Lock-free, safe to call from any number of threads
+         */
+        inline void record(const char* name, int64_t startNanos, int64_t durationNanos, int32_t arg = -1) {
+            uint64_t index = eventCount.fetch_add(1, std::memory_order_relaxed);
+            Event& e = events[index & (GIML_TRACE_CAPACITY - 1)];
+            e.name = name;
+            e.startNanos = startNanos;
+            e.durationNanos = durationNanos;
+            e.threadId = threadId();
+            e.arg = arg;
+        }
+
+        /**
+         * @brief Discards all recorded events. Not safe while other threads are tracing
+         */
+        inline void clear() { eventCount.store(0, std::memory_order_relaxed); }
+
+        /**
+         * @brief RAII scope, records one event covering its lifetime
+         */
+        class Scope {
+        private:
+            const char* name;
+            int32_t arg;
+            int64_t start;
+
+        public:
+            Scope(const char* name, int32_t arg = -1) : name(name), arg(arg), start(now()) {}
+            ~Scope() { record(this->name, this->start, now() - this->start, this->arg); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        /**
+         * @brief Writes the recorded events (oldest first) as Chrome trace-event JSON.
+         * Meant to be called offline, once the traced threads have stopped
+         * @param filename output path
+         * @return false if the file could not be opened
+         */
+        inline bool writeChromeJSON(const char* filename) {
+            FILE* pFile = fopen(filename, "w");
+            if (!pFile) { return false; }
+            uint64_t count = eventCount.load(std::memory_order_acquire);
+            uint64_t first = (count > GIML_TRACE_CAPACITY) ? count - GIML_TRACE_CAPACITY : 0;
+            fprintf(pFile, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+            for (uint64_t i = first; i < count; i++) {
+                const Event& e = events[i & (GIML_TRACE_CAPACITY - 1)];
+                fprintf(pFile, "%s{\"name\": \"%s\", \"cat\": \"giml\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                               "\"ts\": %.3f, \"dur\": %.3f",
+                        (i == first) ? "" : ",\n", e.name, e.threadId,
+                        e.startNanos * 1e-3, e.durationNanos * 1e-3); // trace-event timestamps are in microseconds
+                if (e.arg >= 0) { fprintf(pFile, ", \"args\": {\"index\": %d}", e.arg); }
+                fprintf(pFile, "}");
+            }
+            fprintf(pFile, "\n]}\n");
+            fclose(pFile);
+            return true;
+        }
+    } // namespace trace
+} // namespace giml
+
+#define GIML_TRACE_CONCAT_INNER(a, b) a##b
+#define GIML_TRACE_CONCAT(a, b) GIML_TRACE_CONCAT_INNER(a, b)
+#define GIML_TRACE_SCOPE(name) giml::trace::Scope GIML_TRACE_CONCAT(gimlTraceScope, __LINE__){ name }
+#define GIML_TRACE_SCOPE_ARG(name, arg) giml::trace::Scope GIML_TRACE_CONCAT(gimlTraceScope, __LINE__){ name, (int32_t)(arg) }
+#ifdef GIML_TRACE_SAMPLES
+#define GIML_TRACE_SAMPLE_SCOPE(name) GIML_TRACE_SCOPE(name)
+#else
+#define GIML_TRACE_SAMPLE_SCOPE(name)
+#endif
+
+#else // GIML_TRACE
+
+#define GIML_TRACE_SCOPE(name)
+#define GIML_TRACE_SCOPE_ARG(name, arg)
+#define GIML_TRACE_SAMPLE_SCOPE(name)
+
+#endif // GIML_TRACE
+#endif
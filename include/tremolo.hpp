@@ -7,14 +7,24 @@ namespace giml {
     /**
      * @brief This class implements a basic tremolo effect 
      * @tparam T floating-point type for input and output sample data such as `float`, `double`, or `long double`,
-     * up to user what precision they are looking for (float is more performant)
+     * up to user what precision they are looking for (float is more performant). 
+     * A SIMD vector such as `giml::simd::f32x4` processes one channel per lane, see `sample_traits`.
+     * With a fixed-point `giml::q31` or `giml::q15` the LFO still runs in `float`
      */
     template <typename T>
     class Tremolo : public Effect<T> {
     private:
+        using Scalar = typename sample_traits<T>::scalar;
+        using Coeff = typename sample_traits<T>::coeff;
         int sampleRate;
-        T speed = 1000.0, depth = 1.0;
-        giml::SinOsc<T> osc;
+        Scalar speed = 1000.0, depth = 1.0;
+        giml::SinOsc<Scalar> osc; // one LFO shared by all lanes
+
+        // Envelopes `in` by the LFO sample `lfo`
+        inline T modulate(const T& in, Scalar lfo) const {
+            Scalar gain = (lfo * 2 - 1) * this->depth; // waveshape SinOsc output to make it unipolar, scale by depth
+            return in * Coeff(1 - gain); // return in * waveshaped SinOsc 
+        }
 
     public:
         // Constructor
@@ -27,7 +37,7 @@ namespace giml {
         ~Tremolo() {}
 
         // Copy constructor
-        Tremolo(const Tremolo<T>& t) {
+        Tremolo(const Tremolo<T>& t) : osc(t.osc) {
             this->enabled = t.enabled;
             this->sampleRate = t.sampleRate;
             this->speed = t.speed;
@@ -51,16 +61,55 @@ namespace giml {
          * @return `in` enveloped by `osc`
          */
         inline T processSample(const T& in) {
+            GIML_TRACE_SAMPLE_SCOPE("Tremolo::processSample");
+            if (!this->enabled) { return in; }
+            return this->modulate(in, this->osc.processSample());
+        }
+
+        /**
+         * @brief Returns an enveloped version of the input, with the LFO supplied by the caller
+         * (e.g. one output of a `giml::OscillatorBank`) instead of `osc`
+         * @param in current sample
+         * @param lfo LFO sample, bipolar as `giml::SinOsc` outputs
+         * @return `in` enveloped by `lfo`
+         */
+        inline T processSample(const T& in, Scalar lfo) {
+            GIML_TRACE_SAMPLE_SCOPE("Tremolo::processSample");
             if (!this->enabled) { return in; }
-            T gain = this->osc.processSample() * 2 - 1; // waveshape SinOsc output to make it unipolar
-            gain *= this->depth; // scale by depth
-            return in * (1 - gain); // return in * waveshaped SinOsc 
+            return this->modulate(in, lfo);
+        }
+
+        /**
+         * @brief Processes a block in place, generating the LFO a chunk at a time with `SinOsc::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples) override {
+            GIML_TRACE_SCOPE("Tremolo::processBlock");
+            if (!this->enabled) { return; }
+            Scalar lfo[detail::lfoBlockSize];
+            for (size_t offset = 0; offset < numSamples; offset += detail::lfoBlockSize) {
+                size_t n = std::min(detail::lfoBlockSize, numSamples - offset);
+                this->osc.processBlock(lfo, n);
+                this->processBlock(buffer + offset, n, lfo);
+            }
+        }
+
+        /**
+         * @brief Processes a block in place, with the LFO supplied by the caller instead of `osc`
+         * @param lfo LFO samples, bipolar as `giml::SinOsc` outputs
+         * @param lfoStride distance between consecutive LFO samples, e.g. `N` to read one oscillator
+         * of `giml::OscillatorBank<Scalar, N>::processBlock()`
+         */
+        void processBlock(T* buffer, size_t numSamples, const Scalar* lfo, size_t lfoStride = 1) {
+            GIML_TRACE_SCOPE("Tremolo::processBlock");
+            if (!this->enabled) { return; }
+            for (size_t i = 0; i < numSamples; i++) { buffer[i] = this->modulate(buffer[i], lfo[i * lfoStride]); }
         }
 
         /**
          * @brief sets params speed and depth
          */
-        void setParams(T speed = 1000.0, T depth = 1.0) {
+        void setParams(Scalar speed = 1000.0, Scalar depth = 1.0) {
+            GIML_TRACE_SCOPE("Tremolo::setParams");
             this->setSpeed(speed);
             this->setDepth(depth);
         }
@@ -69,7 +118,7 @@ namespace giml {
          * @brief sets the rate of `osc`
          * @param millisPerCycle desired modulation frequency in milliseconds
          */
-        void setSpeed(T millisPerCycle) { // set speed of LFO
+        void setSpeed(Scalar millisPerCycle) { // set speed of LFO
             if (millisPerCycle < 0.05) { millisPerCycle = 0.05; } // osc frequency ceiling at 20kHz to avoid aliasing
             this->speed = millisPerCycle;
             this->osc.setFrequency(1000.0 / this->speed); // convert to Hz (milliseconds to seconds)
@@ -79,8 +128,16 @@ namespace giml {
          * @brief sets the amount of gain reduction when `osc` is at its peak
          * @param d modulation depth (clamped to [0,1])
          */
-        void setDepth(T d) { // set depth
-            this->depth = giml::clip<T>(d, 0, 1);
+        void setDepth(Scalar d) { // set depth
+            this->depth = giml::clip<Scalar>(d, 0, 1);
+        }
+
+        void reset() override { this->osc.setPhase(0); }
+
+        void prepare(int sampleRate, size_t /*maxBlockSize*/) override {
+            this->sampleRate = sampleRate;
+            this->osc.setSampleRate(sampleRate);
+            this->reset();
         }
     };
 }
@@ -7,10 +7,144 @@
 #endif
 #include <stdlib.h> // For malloc/calloc/free
 #include <cstring> 
+#include <new> // placement new
 #include <stdexcept>
 #include <complex>
+#include <type_traits>
+#include "trace.hpp"
+#include "fixed.hpp"
+#include "storage.hpp"
+#ifdef GIML_LOAD_METER
+#include <atomic>
+#include <chrono>
+#endif
+
+/**
+ * Allocation hooks. Every heap allocation made by Gimmel goes through these macros,
+ * define them before including any Gimmel header to route allocations through
+ * your own allocator (e.g. a memory pool on embedded targets, or a counting allocator for profiling)
+ */
+#ifndef GIML_MALLOC
+#define GIML_MALLOC(size) ::malloc(size)
+#endif
+#ifndef GIML_CALLOC
+#define GIML_CALLOC(count, size) ::calloc(count, size)
+#endif
+#ifndef GIML_REALLOC
+#define GIML_REALLOC(ptr, size) ::realloc(ptr, size)
+#endif
+#ifndef GIML_FREE
+#define GIML_FREE(ptr) ::free(ptr)
+#endif
 
 namespace giml {
+    namespace detail {
+        // Unqualified calls, so that a vector sample type's own operations are found through ADL
+        template <typename V> inline V lanesAbs(V x) { return abs(x); }
+        template <typename V> inline V lanesSqrt(V x) { return sqrt(x); }
+        template <typename V> inline V lanesMin(V a, V b) { return min(a, b); }
+        template <typename V> inline V lanesMax(V a, V b) { return max(a, b); }
+        template <typename M, typename V> inline V lanesSelect(M m, V a, V b) { return select(m, a, b); }
+
+        /**
+         * @brief Uninitialized inline room for `Capacity` objects of type `T`, for containers
+         * with a compile-time capacity. Empty when `Capacity == 0`, the container allocates instead
+         */
+        template <typename T, size_t Capacity>
+        struct InlineStorage {
+            alignas(T) unsigned char inlineBytes[Capacity * sizeof(T)];
+            T* inlineData() { return reinterpret_cast<T*>(this->inlineBytes); }
+        };
+
+        template <typename T>
+        struct InlineStorage<T, 0> {
+            T* inlineData() { return nullptr; }
+        };
+    } // namespace detail
+
+    /**
+     * @brief Describes the sample type `T` that effects are templated on.
+     * Scalars (`float`, `double`) carry one channel. SIMD vectors (any type with a `width`,
+     * such as `giml::simd::f32x4`) carry one independent channel per lane,
+     * so a `Delay<simd::f32x4>` processes four channels in one instance.
+     * 
+     * Parameters are `scalar` and shared by all lanes. Coefficients that multiply samples
+     * are `coeff`, side-chain levels in dB are `level`, and the state of recursive filters
+     * whose coefficients approach 1 (e.g. `OnePole`) is `state`. Comparing samples
+     * yields a `mask`, so sample-dependent branches are written with `select()`
+     */
+    template <typename T, typename = void>
+    struct sample_traits {
+        using scalar = T;
+        using coeff = T;
+        using level = T;
+        using state = T;
+        using mask = bool;
+        static constexpr size_t width = 1;
+
+        static T abs(T x) { return std::abs(x); }
+        static T sqrt(T x) { return std::sqrt(x); }
+        static T min(T a, T b) { return (b < a) ? b : a; } // same as `std::min`
+        static T max(T a, T b) { return (a < b) ? b : a; } // same as `std::max`
+        static T select(mask m, T a, T b) { return m ? a : b; }
+
+        /**
+         * @brief applies the scalar function `f` to every lane
+         */
+        template <typename F>
+        static T map(T x, F f) { return f(x); }
+    };
+
+    template <typename T>
+    struct sample_traits<T, std::void_t<decltype(T::width)>> {
+        using scalar = float;
+        using coeff = float;
+        using level = T;
+        using state = T;
+        using mask = typename T::mask;
+        static constexpr size_t width = T::width;
+
+        static T abs(T x) { return detail::lanesAbs(x); }
+        static T sqrt(T x) { return detail::lanesSqrt(x); }
+        static T min(T a, T b) { return detail::lanesMin(a, b); }
+        static T max(T a, T b) { return detail::lanesMax(a, b); }
+        static T select(mask m, T a, T b) { return detail::lanesSelect(m, a, b); }
+
+        template <typename F>
+        static T map(T x, F f) {
+            float lanes[T::width];
+            x.store(lanes);
+            for (size_t i = 0; i < T::width; i++) { lanes[i] = f(lanes[i]); }
+            return T::load(lanes);
+        }
+    };
+
+    /**
+     * Fixed-point samples (`q31`, `q15`, see `fixed.hpp`) take `float` parameters, converted once when they are set.
+     * Coefficients are `q3_28` and levels `q8_23`, so processing itself needs no FPU.
+     * Filter state is `q31` even for `q15` samples: with a coefficient near 1, 
+     * the 16-bit rounding of `in * (1 - g)` every sample would build up in the state
+     */
+    template <typename Storage, int Frac>
+    struct sample_traits<fixed<Storage, Frac>> {
+        using T = fixed<Storage, Frac>;
+        using scalar = float;
+        using coeff = q3_28;
+        using level = q8_23;
+        using state = q31;
+        using mask = bool;
+        static constexpr size_t width = 1;
+
+        static T abs(T x) { return detail::lanesAbs(x); }
+        static T sqrt(T x) { return detail::lanesSqrt(x); }
+        static T min(T a, T b) { return detail::lanesMin(a, b); }
+        static T max(T a, T b) { return detail::lanesMax(a, b); }
+        static T select(mask m, T a, T b) { return m ? a : b; }
+
+        template <typename F>
+        static T map(T x, F f) { return T(f(static_cast<float>(x))); }
+    };
+
     /**
      * @brief Converts dB value to linear amplitude,
      * the native format of audio samples
@@ -33,6 +167,22 @@ namespace giml {
         return 20.f * log10(ampVal);
     }
 
+    /**
+     * @brief `dBtoA()` for every lane of a vector sample
+     */
+    template <typename T, typename = std::enable_if_t<(sample_traits<T>::width > 1)>>
+    inline T dBtoA(T dBVal) {
+        return sample_traits<T>::map(dBVal, [](float x) { return dBtoA(x); });
+    }
+
+    /**
+     * @brief `aTodB()` for every lane of a vector sample
+     */
+    template <typename T, typename = std::enable_if_t<(sample_traits<T>::width > 1)>>
+    inline T aTodB(T ampVal) {
+        return sample_traits<T>::map(ampVal, [](float x) { return aTodB(x); });
+    }
+
     /**
      * @brief Converts a quantity of milliseconds to an
      * equivalent quantity of samples
@@ -62,28 +212,15 @@ namespace giml {
         return ((x - inMin) / (inMax - inMin)) * (outMax - outMin) + outMin;
     }
 
-    /**
-     * @brief Mixes two numbers with linear interpolation
-     * @param in1 input 1
-     * @param in2 input 2
-     * @param mix percentage of input 2 to mix in. Clamped to `[0,1]`
-     * @return `in1 * (1-mix) + in2 * mix`
-     */
-    template <typename T>
-    inline T linMix(T in1, T in2, T mix = 0.5) {
-        mix = (mix < 0) ? 0 : (mix > 1 ? 1 : mix); // clamp to [0, 1]
-        return in1 * (1-mix) + in2 * mix;
-    }
-
     /**
      * @brief Mixes two numbers with equal power logic
      * @param in1 input 1
      * @param in2 input 2
-     * @param mix in range `[0,1]`
+     * @param mix in range `[0,1]`, shared by all lanes of a vector sample
      * @return `in1 * cos(mix*M_PI_2) + in2 * sin(mix * M_PI_2)`
      */
     template <typename T>
-    inline T powMix(T in1, T in2, T mix = 0.5) {
+    inline T powMix(T in1, T in2, typename sample_traits<T>::scalar mix = 0.5) {
         mix = (mix < 0) ? 0 : (mix > 1 ? 1 : mix); // clamp to [0, 1]
         mix *= M_PI_2;
 
@@ -106,7 +243,21 @@ namespace giml {
      */
     template <typename T>
     inline T clip(T in, T min, T max) {
-        return (in < min) ? min : (in > max ? max : in);
+        using S = sample_traits<T>;
+        return S::select(in < min, min, S::select(in > max, max, in));
+    }
+
+    /**
+     * @brief Mixes two numbers with linear interpolation
+     * @param in1 input 1
+     * @param in2 input 2
+     * @param mix percentage of input 2 to mix in. Clamped to `[0,1]`, may be a `coeff` shared by all lanes
+     * @return `in1 * (1-mix) + in2 * mix`
+     */
+    template <typename T, typename M = T>
+    inline T linMix(T in1, T in2, M mix = 0.5) {
+        mix = giml::clip<M>(mix, 0, 1); // clamp to [0, 1]
+        return in1 * (1-mix) + in2 * mix;
     }
 
     /**
@@ -117,7 +268,7 @@ namespace giml {
      */
     template <typename T>
     inline T biSigmoid(T in) {
-        return in / ::sqrt(in*in + 1);
+        return in / sample_traits<T>::sqrt(in*in + 1);
     }
 
     /**
@@ -183,6 +334,26 @@ namespace giml {
         return exp(-1.0 / millisToSamples(timeMillis, sampleRate));
     }
 
+#ifndef GIML_TAIL_THRESHOLD
+#define GIML_TAIL_THRESHOLD 1e-6 // -120 dB, level below which a tail is considered to have died out
+#endif
+
+    /**
+     * @brief calculates the number of samples (or periods) a given decay multiplier 
+     * needs to decay below `GIML_TAIL_THRESHOLD`
+     * @param gVal decay multiplier per sample (or per period)
+     * @param peak largest level the decaying state can start from, relative to the input (e.g. a resonance's gain)
+     * @return number of samples, -1 if `|gVal| >= 1` (never decays)
+     */
+    template <typename T>
+    inline int decaySamples(T gVal, T peak = T(1)) {
+        gVal = ::fabs(gVal);
+        if (gVal >= T(1)) { return -1; }
+        T target = T(GIML_TAIL_THRESHOLD) / std::max(peak, T(1));
+        if (gVal <= target) { return 1; }
+        return static_cast<int>(::ceil(::log(target) / ::log(gVal)));
+    }
+
     /**
      * @brief Effect class that implements a toggle switch (disabled by default)
      */
@@ -205,10 +376,116 @@ namespace giml {
 
         virtual inline T processSample(const T& in) { return in; }
 
+        /**
+         * @brief Processes a block of samples in place. 
+         * Default implementation calls `processSample()` on every sample,
+         * effects can override it with a faster block implementation
+         * @param buffer samples to process, overwritten with the output
+         * @param numSamples number of samples in `buffer`
+         */
+        virtual void processBlock(T* buffer, size_t numSamples) {
+            GIML_TRACE_SCOPE("Effect::processBlock");
+            for (size_t i = 0; i < numSamples; i++) {
+                buffer[i] = this->processSample(buffer[i]);
+            }
+        }
+
+        /**
+         * @brief Number of samples after which the output no longer depends on past input 
+         * (to within `GIML_TAIL_THRESHOLD`). A fresh instance fed this many samples before 
+         * a given point produces the same output from that point on, which allows rendering
+         * a long signal in independent chunks.
+         * @return tail length in samples, -1 if unbounded or unknown (e.g. feedback >= 1, 
+         * or an LFO whose phase depends on the time since construction)
+         */
+        virtual int getTailSamples() const { return -1; }
+
+        /**
+         * @brief Clears the internal state (delay lines, filter history, LFO phase), 
+         * as if the effect had just been constructed with its current parameters. 
+         * Does not allocate, so a preallocated instance can be reused for a new signal
+         */
+        virtual void reset() {}
+
+        /**
+         * @brief Prepares the effect to process at `sampleRate`, in blocks of at most `maxBlockSize` samples. 
+         * Recomputes every coefficient that depends on the sample rate from the current parameters 
+         * and resets the state. Buffers are only reallocated when they need to grow, 
+         * so preparing again at the same or a lower rate does not allocate
+         * @param sampleRate new sample rate
+         * @param maxBlockSize largest `numSamples` that will be passed to `processBlock()`, 0 if unknown
+         */
+        virtual void prepare(int /*sampleRate*/, size_t /*maxBlockSize*/) { this->reset(); }
+
     protected:
         bool enabled = false;
     };
 
+#ifdef GIML_LOAD_METER
+#ifndef GIML_LOAD_METER_MAX_STAGES
+#define GIML_LOAD_METER_MAX_STAGES 16
+#endif
+    /**
+     * @brief Lock-free CPU load meter, compiled in with `GIML_LOAD_METER`.
+     * The audio thread calls `record()` once per block, 
+     * any other thread (e.g. a UI) can read the averages and peaks without blocking it.
+     * Timings are normalized to nanoseconds per sample so that blocks of different sizes are comparable
+     */
+    class LoadMeter {
+    private:
+        std::atomic<float> averageNanos{0.f}; // exponential moving average of ns/sample
+        std::atomic<float> peakNanos{0.f}; // highest ns/sample seen since last `resetPeak()`
+        std::atomic<float> lastNanos{0.f}; // ns/sample of the most recent block
+        static constexpr float smoothing = 0.05f; // moving average coefficient (per block)
+
+    public:
+        /**
+         * @brief monotonic timestamp in nanoseconds (`clock_gettime(CLOCK_MONOTONIC)` on Linux)
+         */
+        static inline long long now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * @brief Records the processing time of one block. Audio thread only
+         * @param elapsedNanos time spent processing the block
+         * @param numSamples block size
+         */
+        void record(long long elapsedNanos, size_t numSamples) {
+            if (numSamples == 0) { return; }
+            float perSample = (float)elapsedNanos / numSamples;
+            this->lastNanos.store(perSample, std::memory_order_relaxed);
+            float avg = this->averageNanos.load(std::memory_order_relaxed);
+            this->averageNanos.store(avg + smoothing * (perSample - avg), std::memory_order_relaxed);
+            float peak = this->peakNanos.load(std::memory_order_relaxed);
+            while (perSample > peak && 
+                   !this->peakNanos.compare_exchange_weak(peak, perSample, std::memory_order_relaxed)) {}
+        }
+
+        float getAverageNanosPerSample() const { return this->averageNanos.load(std::memory_order_relaxed); }
+        float getPeakNanosPerSample() const { return this->peakNanos.load(std::memory_order_relaxed); }
+        float getLastNanosPerSample() const { return this->lastNanos.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief average load as a proportion of the real-time budget (1.0 = 100% of one core)
+         * @param sampleRate sample rate of your project
+         */
+        float getLoad(int sampleRate) const { return this->getAverageNanosPerSample() * sampleRate * 1e-9f; }
+
+        /**
+         * @brief peak load as a proportion of the real-time budget
+         * @param sampleRate sample rate of your project
+         */
+        float getPeakLoad(int sampleRate) const { return this->getPeakNanosPerSample() * sampleRate * 1e-9f; }
+
+        /**
+         * @brief Clears the peak, safe to call from any thread
+         */
+        void resetPeak() { this->peakNanos.store(0.f, std::memory_order_relaxed); }
+    };
+#endif
+
     /**
      * @brief smoothed dB peak detector class
      * @todo implement the other detectors from Reiss et al, add enum for mode
@@ -216,6 +493,7 @@ namespace giml {
     template <typename T>
     class dBDetector { 
     private:
+        using Coeff = typename sample_traits<T>::coeff;
         T y1last = 0;
         T yL_last = 0;
 
@@ -227,11 +505,13 @@ namespace giml {
          * @param alphaR release coefficient 
          * @return `yL`
          */
-        T operator()(T xL, T aA, T aR) {
-            y1last = std::max(xL, (aR * y1last) + ((T(1.0) - aR) * xL)); // Release
-            yL_last = (aA * yL_last) + ((T(1.0) - aA) * y1last); // Attack
+        T operator()(T xL, Coeff aA, Coeff aR) {
+            y1last = sample_traits<T>::max(xL, (y1last * aR) + (xL * (Coeff(1.0) - aR))); // Release
+            yL_last = (yL_last * aA) + (y1last * (Coeff(1.0) - aA)); // Attack
             return yL_last;
         }
+
+        void reset() { this->y1last = 0; this->yL_last = 0; }
     };
 
     /**
@@ -278,11 +558,23 @@ namespace giml {
         T operator()(const T& in) {
             T riseOrFall = linMix(decayMillis, attackMillis, in);
             T samps = millisToSamples(riseOrFall, sampleRate);
-            samps = std::max(samps, 1.f); // make sure it's at least 1
+            samps = std::max(samps, T(1)); // make sure it's at least 1
             T t60Val = t60(samps);
             this->y1 = linMix(in, y1, t60Val); // apply filter 
             return y1; // return the current output
         }
+
+        /**
+         * @brief number of samples for the slower of attack and decay to die out
+         */
+        int getTailSamples() const {
+            T samps = millisToSamples(std::max(attackMillis, decayMillis), sampleRate);
+            return decaySamples(t60(std::max(samps, T(1))));
+        }
+
+        void reset() { this->y1 = 0; }
+
+        void setSampleRate(int sampleRate) { this->sampleRate = sampleRate; }
     };
 
     template <typename T>
@@ -321,23 +613,54 @@ namespace giml {
      * Handy for effects that require a delay line.
      * TODO: Add allpass interpolation
      * See Generating Sound & Organizing Time I - Wakefield and Taylor 2022 Chapter 7 pg. 223
+     * @tparam T sample type written and read
+     * @tparam StorageT type the samples are stored as, see `storage_codec`. 
+     * `int16_t`, `half` or `bfloat16` halve the memory and bandwidth of a `float` buffer 
+     * @tparam Capacity if non-zero, the samples are stored inline in the object (`Capacity` of them) 
+     * and the buffer never touches the heap: `allocate()` clamps the size instead
      */
-    template <typename T>
-    class CircularBuffer {
+    template <typename T, typename StorageT = T, size_t Capacity = 0>
+    class CircularBuffer : private detail::InlineStorage<StorageT, Capacity> {
     private:
-        T* pBackingArr = nullptr;
+        using Codec = storage_codec<T, StorageT>;
+        StorageT* pBackingArr = nullptr;
         size_t bufferSize = 0;
+        size_t bufferCapacity = 0; // allocated size, `bufferSize` can shrink below it
         size_t writeIndex = 0;
 
+        // zero-filled room for `size` samples, inline or on the heap
+        StorageT* acquire(size_t size) {
+            if constexpr (Capacity > 0) {
+                memset(this->inlineData(), 0, size * sizeof(StorageT));
+                return this->inlineData();
+            }
+            else { return (StorageT*)GIML_CALLOC(size, sizeof(StorageT)); }
+        }
+
+        void release() {
+            if constexpr (Capacity == 0) { if (this->pBackingArr) { GIML_FREE(this->pBackingArr); } }
+            this->pBackingArr = nullptr;
+        }
+
     public:
         /**
-         * @brief function that allocates an array of `size` indices
+         * @brief function that allocates an array of `size` indices, zero-filled. 
+         * Only reallocates if `size` exceeds the current capacity. 
+         * With a compile-time `Capacity`, `size` is clamped to it and nothing is allocated
          * @param size in a delay line, the number of past samples stored
          */
         void allocate(size_t size) {
-            if (this->pBackingArr) { free(this->pBackingArr); } // free if occupied
+            if (Capacity > 0 && size > Capacity) { size = Capacity; }
+            if (size > this->bufferCapacity || !this->pBackingArr) {
+                this->release(); // free if occupied
+                this->pBackingArr = this->acquire(size); // zero-fill values
+                this->bufferCapacity = size;
+                this->bufferSize = size;
+                this->writeIndex = 0;
+                return;
+            }
             this->bufferSize = size;
-            this->pBackingArr = (T*)calloc(this->bufferSize, sizeof(T)); // zero-fill values
+            this->clear();
         }
 
         //Constructor
@@ -348,7 +671,9 @@ namespace giml {
             // There is no previous object, this object is being created new
             // We need to deep copy over the entire array
             this->bufferSize = c.bufferSize;
-            this->pBackingArr = (T*)calloc(bufferSize, sizeof(T));
+            this->bufferCapacity = c.bufferSize;
+            this->writeIndex = c.writeIndex;
+            this->pBackingArr = this->acquire(this->bufferSize);
             for (size_t i = 0; i < this->bufferSize; i++) {
                 this->pBackingArr[i] = c.pBackingArr[i];
             }
@@ -357,9 +682,12 @@ namespace giml {
         // Copy assignment constructor
         CircularBuffer& operator=(const CircularBuffer& c) {
             //There is a previous object here so first we need to free the previous buffer
-            if (this->pBackingArr) { free(this->pBackingArr); }
+            if (this == &c) { return *this; }
+            this->release();
             this->bufferSize = c.bufferSize;
-            this->pBackingArr = (T*)calloc(bufferSize, sizeof(T));
+            this->bufferCapacity = c.bufferSize;
+            this->writeIndex = c.writeIndex;
+            this->pBackingArr = this->acquire(this->bufferSize);
             for (size_t i = 0; i < this->bufferSize; i++) {
                 this->pBackingArr[i] = c.pBackingArr[i];
             }
@@ -367,15 +695,23 @@ namespace giml {
             return *this;
         }
 
+        /**
+         * @brief Zero-fills the buffer without reallocating it
+         */
+        void clear() {
+            if (this->pBackingArr) { memset(this->pBackingArr, 0, this->bufferSize * sizeof(StorageT)); }
+            this->writeIndex = 0;
+        }
+
         // Destructor that frees the memory
-        ~CircularBuffer() { if (this->pBackingArr) { free(pBackingArr); } }
+        ~CircularBuffer() { this->release(); }
 
         /**
          * @brief Writes a new sample to the buffer
          * @param input sample value
          */
         void writeSample(T input) {
-            this->pBackingArr[this->writeIndex] = input;
+            this->pBackingArr[this->writeIndex] = Codec::encode(input);
             this->writeIndex++;
             if (this->writeIndex >= this->bufferSize) {
                 this->writeIndex = 0; // circular logic 
@@ -392,7 +728,7 @@ namespace giml {
             if (delayInSamples >= this->bufferSize) { delayInSamples = this->bufferSize - 1; }
             long int readIndex = this->writeIndex - delayInSamples; // calculate readIndex
             if (readIndex < 0) { readIndex += this->bufferSize; } // circular logic 
-          return this->pBackingArr[readIndex];
+          return Codec::decode(this->pBackingArr[readIndex]);
         }
 
         inline T readSample(int delayInSamples) const {
@@ -406,12 +742,21 @@ namespace giml {
          */
         inline T readSample(float delayInSamples) const {
             size_t readIndex = delayInSamples; // sample 1
-            size_t readIndex2 = readIndex + 1; // sample 2
             float frac = delayInSamples - readIndex; // proportion of sample 2 to blend in
+            return this->readSample(readIndex, frac);
+        }
 
+        /**
+         * @brief Reads a sample from the buffer using linear interpolation, 
+         * with the fractional delay split ahead of time (no floating-point math for fixed-point `T`)
+         * @param delayInSamples whole samples ago
+         * @param frac proportion of the next older sample to blend in, `[0, 1)`
+         * @return `interpolated sample from delayInSamples + frac ago`
+         */
+        inline T readSample(size_t delayInSamples, typename sample_traits<T>::coeff frac) const {
             return  // do linear interpolation
-                (this->readSample(readIndex) * (1.f - frac)) 
-                + (this->readSample(readIndex2) * frac); 
+                (this->readSample(delayInSamples) * (1 - frac)) 
+                + (this->readSample(delayInSamples + 1) * frac); 
         }
 
         /**
@@ -425,19 +770,56 @@ namespace giml {
          * @brief getter for `bufferSize`
          */
         size_t size() const { return this->bufferSize; }
+
+        /**
+         * @brief getter for the allocated size, the largest `size` that `allocate()` can take without reallocating
+         */
+        size_t capacity() const { return this->bufferCapacity; }
+
+        /**
+         * @brief The stored samples, for reading many taps at once (e.g. with `simd::kernels()`):
+         * the sample `delayInSamples` ago is at `data()[index(delayInSamples)]`
+         */
+        const StorageT* data() const { return this->pBackingArr; }
+
+        /**
+         * @brief Position in `data()` of the sample `delayInSamples` ago, clamped like `readSample()`.
+         * `index(0)` is where the next sample will be written
+         */
+        size_t index(size_t delayInSamples) const {
+            if (delayInSamples >= this->bufferSize) { delayInSamples = this->bufferSize - 1; }
+            return (this->writeIndex >= delayInSamples) ? this->writeIndex - delayInSamples
+                                                        : this->writeIndex + this->bufferSize - delayInSamples;
+        }
     };
 
     /**
      * @brief DynamicArray implementation for when we need small resizable arrays
+     * @tparam Capacity if non-zero, the elements are stored inline in the object (at most `Capacity` of them) 
+     * and the array never touches the heap: `pushBack()` on a full array drops the element
      */
-    template <typename T>
-    class DynamicArray {
+    template <typename T, size_t Capacity = 0>
+    class DynamicArray : private detail::InlineStorage<T, Capacity> {
     private:
         T* pBackingArr;
         size_t length, initialCapacity, totalCapacity;
 
+        // zero-filled room for `capacity` elements, inline or on the heap
+        T* acquire(size_t capacity) {
+            if constexpr (Capacity > 0) {
+                ::memset((void*)this->inlineData(), 0, capacity * sizeof(T));
+                return this->inlineData();
+            }
+            else { return (T*)GIML_CALLOC(capacity, sizeof(T)); }
+        }
+
+        void release() {
+            if constexpr (Capacity == 0) { GIML_FREE(this->pBackingArr); }
+        }
+
         void resize(size_t newCapacity) {
-            T* newSpace = (T*)realloc(this->pBackingArr, newCapacity * sizeof(T));
+            if (Capacity > 0) { return; } // inline storage neither grows nor shrinks
+            T* newSpace = (T*)GIML_REALLOC(this->pBackingArr, newCapacity * sizeof(T));
             if (newCapacity > this->totalCapacity) {
                 //Then we need to 0-initialize the rest of the new space
                 ::memset((void*)(newSpace + this->totalCapacity), 0, (newCapacity - this->totalCapacity) * sizeof(T));
@@ -448,8 +830,9 @@ namespace giml {
 
     public:
         //Constructor
-        DynamicArray(size_t initialCapacity = 4) {
-            this->pBackingArr = (T*)calloc(initialCapacity, sizeof(T)); //Needs to be calloc so that the data is zero-ed out
+        DynamicArray(size_t initialCapacity = (Capacity > 0) ? Capacity : 4) {
+            if (Capacity > 0) { initialCapacity = Capacity; }
+            this->pBackingArr = this->acquire(initialCapacity); //Needs to be calloc so that the data is zero-ed out
             this->initialCapacity = initialCapacity;
             this->totalCapacity = initialCapacity;
             this->length = 0;
@@ -457,24 +840,29 @@ namespace giml {
 
         //Copy constructor
         DynamicArray(const DynamicArray& d) {
-            this->pBackingArr = (T*)malloc(d.totalCapacity * sizeof(T));
+            this->pBackingArr = this->acquire(d.totalCapacity); // zeroed, same as `pushBack()` expects
             this->initialCapacity = d.initialCapacity;
             this->totalCapacity = d.totalCapacity;
             this->length = d.length;
-            //Deep copy over all values
-            for (int i = 0; i < d.length; i++) {
-                this->pBackingArr[i] = d.pBackingArr[i];
+            //Deep copy over all values, constructing them in the raw storage
+            for (size_t i = 0; i < d.length; i++) {
+                new (this->pBackingArr + i) T(d.pBackingArr[i]);
             }
         }
         //Copy assignment operator
         DynamicArray& operator=(const DynamicArray& d) {
-            this->pBackingArr = (T*)malloc(d.totalCapacity * sizeof(T));
+            if (this == &d) { return *this; }
+            for (size_t i = 0; i < this->length; i++) {
+                this->pBackingArr[i].~T(); // clean up previous contents
+            }
+            this->release();
+            this->pBackingArr = this->acquire(d.totalCapacity); // zeroed, same as `pushBack()` expects
             this->initialCapacity = d.initialCapacity;
             this->totalCapacity = d.totalCapacity;
             this->length = d.length;
-            //Deep copy over all values
-            for (int i = 0; i < d.length; i++) {
-                this->pBackingArr[i] = d.pBackingArr[i];
+            //Deep copy over all values, constructing them in the raw storage
+            for (size_t i = 0; i < d.length; i++) {
+                new (this->pBackingArr + i) T(d.pBackingArr[i]);
             }
 
             return *this;
@@ -484,17 +872,22 @@ namespace giml {
             for (size_t i = 0; i < this->length; i++) {
                 this->pBackingArr[i].~T(); //Make sure to call the destructor if the object needs to be cleaned up
             }
-            free(this->pBackingArr);
+            this->release();
         }
 
         size_t size() const { return this->length; }
         size_t getCapacity() const { return this->totalCapacity; }
 
         void pushBack(const T& val) {
+            if (Capacity > 0 && this->length == Capacity) {
+                printf("DynamicArray is full!\n");
+                return;
+            }
             if (this->length == this->totalCapacity) {
                 this->resize(this->totalCapacity * 1.5); //Apparently STL lib uses 1.5 as their resize factor for vector
             }
-            this->pBackingArr[this->length++] = val;
+            new (this->pBackingArr + this->length) T(val); // construct in place, so objects get their vtable
+            this->length++;
         }
 
         void removeAt(size_t indexToRemove) {
@@ -580,16 +973,29 @@ namespace giml {
      * ```
      * Can later change mBiquad & mReverb directly, changes should take effect in EffectsLine
      * 
+     * Compile with `GIML_LOAD_METER` defined to time every stage in `processBlock()`:
+     * 
+     * ```cpp
+     * signalChain.processBlock(buffer, blockSize); // audio thread
+     * float reverbLoad = signalChain.getStageMeter(1).getLoad(sampleRate); // any thread
+     * ```
+     * 
      * @tparam T 
      */
     template <typename T>
     class EffectsLine : public DynamicArray<Effect<T>*> {
+#ifdef GIML_LOAD_METER
+    private:
+        LoadMeter stageMeters[GIML_LOAD_METER_MAX_STAGES]; // fixed so that readers never see a reallocation
+        LoadMeter totalMeter;
+#endif
+
     public:
         EffectsLine(size_t initialCapacity = 5): DynamicArray<Effect<T>*>(initialCapacity) {}
         //Copy constructor
         EffectsLine(const EffectsLine& e) {}
         //Copy assignment operator
-        EffectsLine& operator=(const EffectsLine& e) {}
+        EffectsLine& operator=(const EffectsLine& e) { return *this; }
         //Destructor
         ~EffectsLine() {} //Base class destructor automatically called
 
@@ -606,6 +1012,88 @@ namespace giml {
             }
           return returnVal;
         }
+
+        /**
+         * @brief Sends a block of samples through the entire pedal chain, one effect at a time
+         * 
+         * @param buffer input samples, overwritten with the output of the final effect
+         * @param numSamples number of samples in `buffer`
+         */
+        void processBlock(T* buffer, size_t numSamples) {
+            GIML_TRACE_SCOPE("EffectsLine::processBlock");
+#ifdef GIML_LOAD_METER
+            long long chainStart = LoadMeter::now();
+#endif
+            for (size_t stage = 0; stage < this->size(); stage++) {
+                GIML_TRACE_SCOPE_ARG("EffectsLine::stage", stage);
+#ifdef GIML_LOAD_METER
+                long long stageStart = LoadMeter::now();
+#endif
+                this->begin()[stage]->processBlock(buffer, numSamples);
+#ifdef GIML_LOAD_METER
+                if (stage < GIML_LOAD_METER_MAX_STAGES) {
+                    this->stageMeters[stage].record(LoadMeter::now() - stageStart, numSamples);
+                }
+#endif
+            }
+#ifdef GIML_LOAD_METER
+            this->totalMeter.record(LoadMeter::now() - chainStart, numSamples);
+#endif
+        }
+
+        /**
+         * @brief Tail of the whole chain, the sum of its effects' tails
+         * @return tail length in samples, -1 if any effect's tail is unbounded or unknown
+         */
+        int getTailSamples() const {
+            int total = 0;
+            for (size_t stage = 0; stage < this->size(); stage++) {
+                int tail = this->begin()[stage]->getTailSamples();
+                if (tail < 0) { return -1; }
+                total += tail;
+            }
+            return total;
+        }
+
+        /**
+         * @brief Resets every effect in the chain, see `Effect::reset()`
+         */
+        void reset() {
+            for (Effect<T>* e : *this) { e->reset(); }
+        }
+
+        /**
+         * @brief Prepares every effect in the chain, see `Effect::prepare()`
+         */
+        void prepare(int sampleRate, size_t maxBlockSize) {
+            for (Effect<T>* e : *this) { e->prepare(sampleRate, maxBlockSize); }
+        }
+
+#ifdef GIML_LOAD_METER
+        /**
+         * @brief load meter of one effect in the chain, in the order they were pushed. 
+         * Only the first `GIML_LOAD_METER_MAX_STAGES` effects are metered, 
+         * later stages get a shared meter that never records (reads 0)
+         */
+        const LoadMeter& getStageMeter(size_t stage) const { 
+            static const LoadMeter unmetered;
+            if (stage >= GIML_LOAD_METER_MAX_STAGES) { return unmetered; }
+            return this->stageMeters[stage]; 
+        }
+
+        /**
+         * @brief load meter of the whole chain
+         */
+        const LoadMeter& getTotalMeter() const { return this->totalMeter; }
+
+        /**
+         * @brief clears the peaks of every meter, safe to call from any thread
+         */
+        void resetPeaks() {
+            for (LoadMeter& m : this->stageMeters) { m.resetPeak(); }
+            this->totalMeter.resetPeak();
+        }
+#endif
     };
 
 
@@ -630,7 +1118,7 @@ namespace giml {
             while (currNode != this->head) {
                 tempNodeToDelete = currNode;
                 currNode = currNode->next;
-                free(tempNodeToDelete);
+                GIML_FREE(tempNodeToDelete);
             }
             //startingNode->next = this->head;
         }
@@ -641,14 +1129,14 @@ namespace giml {
         LinkedList(const giml::LinkedList<T>& l) {
             if (l.length != 0) {
                 //Then we have elements to deep copy over
-                this->head = (Node*)malloc(sizeof(Node));
+                this->head = (Node*)GIML_MALLOC(sizeof(Node));
                 this->head->value = l.head->value; //Hopefully this is a deep copy
                 this->head->next = nullptr;
                 this->length = l.length;
 
                 Node* pCurrNode = this->head, pTheirNode = l.head->next;
                 while (pTheirNode) {
-                    Node* newNode = (Node*)malloc(sizeof(Node));
+                    Node* newNode = (Node*)GIML_MALLOC(sizeof(Node));
                     newNode->value = pTheirNode->value;
                     newNode->next = nullptr;
 
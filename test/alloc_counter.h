@@ -0,0 +1,79 @@
+#pragma once
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdlib.h> //For malloc
+#include <stddef.h>
+#include <string.h>
+
+/* Counting allocator for Gimmel's allocation hooks.
+   Include this before any Gimmel header so that every allocation made by the
+   library is tracked. Not thread-safe, meant for single-threaded benchmarks */
+namespace alloc_counter {
+    struct Stats {
+        size_t currentBytes = 0; // bytes currently allocated
+        size_t peakBytes = 0; // high-water mark of currentBytes since last `resetPeak()`
+        size_t allocations = 0; // number of calls to malloc/calloc/realloc since last `resetPeak()`
+    };
+
+    inline Stats& stats() {
+        static Stats s;
+        return s;
+    }
+
+    // Sets the high-water mark to the current usage, call before the section you want to measure
+    inline void resetPeak() {
+        stats().peakBytes = stats().currentBytes;
+        stats().allocations = 0;
+    }
+
+    // Every block is prefixed with its size so that `free` knows how much to subtract
+    static constexpr size_t kHeaderSize = alignof(max_align_t);
+
+    inline void record(size_t bytesAdded) {
+        Stats& s = stats();
+        s.currentBytes += bytesAdded;
+        s.allocations++;
+        if (s.currentBytes > s.peakBytes) { s.peakBytes = s.currentBytes; }
+    }
+
+    inline void* countingMalloc(size_t size) {
+        unsigned char* p = (unsigned char*)::malloc(size + kHeaderSize);
+        if (!p) { return nullptr; }
+        *(size_t*)p = size;
+        record(size);
+        return p + kHeaderSize;
+    }
+
+    inline void* countingCalloc(size_t count, size_t size) {
+        void* p = countingMalloc(count * size);
+        if (p) { ::memset(p, 0, count * size); }
+        return p;
+    }
+
+    inline void countingFree(void* ptr) {
+        if (!ptr) { return; }
+        unsigned char* p = (unsigned char*)ptr - kHeaderSize;
+        stats().currentBytes -= *(size_t*)p;
+        ::free(p);
+    }
+
+    inline void* countingRealloc(void* ptr, size_t size) {
+        if (!ptr) { return countingMalloc(size); }
+        unsigned char* p = (unsigned char*)ptr - kHeaderSize;
+        size_t oldSize = *(size_t*)p;
+        p = (unsigned char*)::realloc(p, size + kHeaderSize);
+        if (!p) { return nullptr; }
+        *(size_t*)p = size;
+        stats().currentBytes -= oldSize;
+        record(size);
+        return p + kHeaderSize;
+    }
+}
+
+#define GIML_MALLOC(size) alloc_counter::countingMalloc(size)
+#define GIML_CALLOC(count, size) alloc_counter::countingCalloc(count, size)
+#define GIML_REALLOC(ptr, size) alloc_counter::countingRealloc(ptr, size)
+#define GIML_FREE(ptr) alloc_counter::countingFree(ptr)
+
+#endif
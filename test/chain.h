@@ -0,0 +1,305 @@
+#pragma once
+#ifndef CHAIN_H
+#define CHAIN_H
+
+// Include all gimmel effects
+#include "../include/gimmel.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Text description of an effects chain, shared by the offline tools.
+   Effects are separated by `|` (or newlines in a chain file, `#` starts a comment),
+   each is a type followed by `key=value` parameters. Unset parameters keep the
+   defaults of the effect's `setParams()`:
+
+       compressor thresh=-20 ratio=4 | saturation drive=6 | delay time=398 feedback=0.3 | reverb time=0.03 shape=cube
+
+   Types and parameters:
+       biquad      type(lpf1|hpf1|lpf2|hpf2|lpfbw|hpfbw|apf1|apf2|lsf|hsf|peq) cutoff q gain
+       chorus      rate depth blend
+       compressor  thresh ratio makeup knee attack release
+       delay       time feedback damping blend
+       detune      pitch window blend
+       envelope    q attack release
+       expander    thresh ratio knee attack release
+       flanger     rate depth blend
+       phaser      rate feedback
+       reverb      time regen damping blend room absorption shape(cube|sphere|pyramid|cylinder)
+       saturation  drive preamp volume oversampling
+       tremolo     speed depth
+*/
+struct EffectSpec {
+    std::string type;
+    std::map<std::string, std::string> params;
+};
+
+struct ChainSpec {
+    std::vector<EffectSpec> effects;
+
+    /**
+     * @brief Parses a chain description
+     * @param text the description, or the path of a file containing one
+     * @param error set to a readable message on failure
+     * @return false if the description is malformed
+     */
+    bool parse(const std::string& text, std::string& error) {
+        std::string description = text;
+        std::ifstream file(text);
+        if (file) {
+            std::stringstream contents;
+            std::string line;
+            while (std::getline(file, line)) {
+                contents << line.substr(0, line.find('#')) << " | ";
+            }
+            description = contents.str();
+        }
+
+        this->effects.clear();
+        std::stringstream stages(description);
+        std::string stage;
+        while (std::getline(stages, stage, '|')) {
+            std::stringstream tokens(stage);
+            std::string token;
+            EffectSpec effect;
+            while (tokens >> token) {
+                if (effect.type.empty()) {
+                    effect.type = token;
+                    continue;
+                }
+                size_t eq = token.find('=');
+                if (eq == std::string::npos || eq == 0 || eq + 1 == token.size()) {
+                    error = "expected key=value after '" + effect.type + "', got '" + token + "'";
+                    return false;
+                }
+                effect.params[token.substr(0, eq)] = token.substr(eq + 1);
+            }
+            if (!effect.type.empty()) { this->effects.push_back(effect); }
+        }
+        if (this->effects.empty()) {
+            error = "empty chain";
+            return false;
+        }
+        return true;
+    }
+
+    std::string toString() const {
+        std::string s;
+        for (const EffectSpec& e : this->effects) {
+            if (!s.empty()) { s += " | "; }
+            s += e.type;
+            for (const auto& p : e.params) { s += " " + p.first + "=" + p.second; }
+        }
+        return s;
+    }
+};
+
+/* One instance of a chain built from a `ChainSpec`. Owns its effects,
+   so every worker thread can build its own independent copy */
+class Chain {
+public:
+    /**
+     * @brief Builds the effects of `spec`
+     * @param error set to a readable message on failure
+     * @return nullptr for unknown effect types, parameters or values
+     */
+    static std::unique_ptr<Chain> build(const ChainSpec& spec, int sampleRate, std::string& error) {
+        std::unique_ptr<Chain> chain(new Chain());
+        for (const EffectSpec& e : spec.effects) {
+            Params p { e };
+            giml::Effect<float>* effect = makeEffect(p, sampleRate);
+            if (!effect) {
+                error = "unknown effect type '" + e.type + "'";
+                return nullptr;
+            }
+            chain->effects.emplace_back(effect);
+            if (!configure(*effect, p, error)) { return nullptr; }
+            effect->enable();
+            chain->line.pushBack(effect);
+        }
+        chain->spec = spec;
+        return chain;
+    }
+
+    /**
+     * @brief Applies the parameters of `spec` to the existing effects, without allocating. 
+     * `spec` must list the same effect types in the same order, with the same 
+     * construction-time parameters (saturation `oversampling`). 
+     * State is kept, call `reset()` to start a new signal
+     * @param error set to a readable message on failure
+     * @return false if `spec` does not match the chain, or has unknown parameters or values
+     */
+    bool configure(const ChainSpec& spec, std::string& error) {
+        if (spec.effects.size() != this->effects.size()) {
+            error = "chain has " + std::to_string(this->effects.size()) + " effects, got " + std::to_string(spec.effects.size());
+            return false;
+        }
+        for (size_t i = 0; i < spec.effects.size(); i++) {
+            const EffectSpec& e = spec.effects[i];
+            const EffectSpec& built = this->spec.effects[i];
+            if (e.type != built.type) {
+                error = "expected " + built.type + " at position " + std::to_string(i) + ", got " + e.type;
+                return false;
+            }
+            if (e.type == "saturation" && lookup(e, "oversampling") != lookup(built, "oversampling")) {
+                error = "saturation oversampling can not change after construction";
+                return false;
+            }
+            Params p { e };
+            p.find("oversampling");
+            if (!configure(*this->effects[i], p, error)) { return false; }
+        }
+        this->spec = spec;
+        return true;
+    }
+
+    // Clears the state of every effect, see `giml::Effect::reset()`
+    void reset() { this->line.reset(); }
+
+    // Parameters currently applied
+    const ChainSpec& getSpec() const { return this->spec; }
+
+    void processBlock(float* buffer, size_t numSamples) { this->line.processBlock(buffer, numSamples); }
+
+    // Tail of the whole chain in samples, -1 if unbounded, see `giml::Effect::getTailSamples()`
+    int getTailSamples() const { return this->line.getTailSamples(); }
+
+    size_t size() const { return this->effects.size(); }
+    giml::Effect<float>& operator[](size_t index) { return *this->effects[index]; }
+
+private:
+    std::vector<std::unique_ptr<giml::Effect<float>>> effects;
+    giml::EffectsLine<float> line;
+    ChainSpec spec;
+
+    Chain() {}
+
+    // Parameter lookup that remembers which keys were consumed
+    struct Params {
+        const EffectSpec& spec;
+        std::map<std::string, bool> used;
+        std::string error;
+
+        const std::string* find(const char* key) {
+            auto it = this->spec.params.find(key);
+            if (it == this->spec.params.end()) { return nullptr; }
+            this->used[key] = true;
+            return &it->second;
+        }
+
+        float get(const char* key, float defaultValue) {
+            const std::string* value = this->find(key);
+            if (!value) { return defaultValue; }
+            char* end = nullptr;
+            float f = strtof(value->c_str(), &end);
+            if (end == value->c_str() || *end != '\0') {
+                this->error = "invalid value '" + *value + "' for " + this->spec.type + " " + key;
+            }
+            return f;
+        }
+
+        // Maps a string value onto one of `choices`
+        template <typename E>
+        E choose(const char* key, E defaultValue, const std::vector<std::pair<const char*, E>>& choices) {
+            const std::string* value = this->find(key);
+            if (!value) { return defaultValue; }
+            for (const auto& c : choices) {
+                if (*value == c.first) { return c.second; }
+            }
+            this->error = "invalid value '" + *value + "' for " + this->spec.type + " " + key;
+            return defaultValue;
+        }
+    };
+
+    static std::string lookup(const EffectSpec& e, const char* key) {
+        auto it = e.params.find(key);
+        return (it == e.params.end()) ? std::string() : it->second;
+    }
+
+    // Constructs the effect named by `p.spec.type`, nullptr if unknown
+    static giml::Effect<float>* makeEffect(Params& p, int sampleRate) {
+        const std::string& type = p.spec.type;
+        if (type == "biquad") { return new giml::Biquad<float>(sampleRate); }
+        if (type == "chorus") { return new giml::Chorus<float>(sampleRate); }
+        if (type == "compressor") { return new giml::Compressor<float>(sampleRate); }
+        if (type == "delay") { return new giml::Delay<float>(sampleRate); }
+        if (type == "detune") { return new giml::Detune<float>(sampleRate); }
+        if (type == "envelope") { return new giml::EnvelopeFilter<float>(sampleRate); }
+        if (type == "expander") { return new giml::Expander<float>(sampleRate); }
+        if (type == "flanger") { return new giml::Flanger<float>(sampleRate); }
+        if (type == "phaser") { return new giml::Phaser<float>(sampleRate); }
+        if (type == "reverb") { return new giml::Reverb<float>(sampleRate); }
+        if (type == "saturation") { return new giml::Saturation<float>(sampleRate, (int)p.get("oversampling", 1.f)); }
+        if (type == "tremolo") { return new giml::Tremolo<float>(sampleRate); }
+        return nullptr;
+    }
+
+    // Applies the parameters of `p` to `effect`, which `makeEffect()` built from the same type
+    static bool configure(giml::Effect<float>& effect, Params& p, std::string& error) {
+        const std::string& type = p.spec.type;
+        if (type == "biquad") {
+            typedef giml::Biquad<float>::BiquadUseCase UseCase;
+            giml::Biquad<float>& e = static_cast<giml::Biquad<float>&>(effect);
+            e.setType(p.choose<UseCase>("type", UseCase::LPF_2nd, {
+                { "lpf1", UseCase::LPF_1st }, { "hpf1", UseCase::HPF_1st },
+                { "lpf2", UseCase::LPF_2nd }, { "hpf2", UseCase::HPF_2nd },
+                { "lpfbw", UseCase::LPF_Butterworth }, { "hpfbw", UseCase::HPF_Butterworth },
+                { "apf1", UseCase::APF_1st }, { "apf2", UseCase::APF_2nd },
+                { "lsf", UseCase::LSF }, { "hsf", UseCase::HSF }, { "peq", UseCase::PEQ_constQ } }));
+            e.setParams(p.get("cutoff", 1000.f), p.get("q", 0.707f), p.get("gain", 0.f));
+        } else if (type == "chorus") {
+            static_cast<giml::Chorus<float>&>(effect).setParams(p.get("rate", 0.2f), p.get("depth", 6.f), p.get("blend", 0.5f));
+        } else if (type == "compressor") {
+            static_cast<giml::Compressor<float>&>(effect).setParams(p.get("thresh", 0.f), p.get("ratio", 2.f), p.get("makeup", 0.f),
+                                                                  p.get("knee", 1.f), p.get("attack", 3.5f), p.get("release", 100.f));
+        } else if (type == "delay") {
+            static_cast<giml::Delay<float>&>(effect).setParams(p.get("time", 398.f), p.get("feedback", 0.3f),
+                                                             p.get("damping", 0.5f), p.get("blend", 0.5f));
+        } else if (type == "detune") {
+            static_cast<giml::Detune<float>&>(effect).setParams(p.get("pitch", 1.f), p.get("window", 22.f), p.get("blend", 0.5f));
+        } else if (type == "envelope") {
+            static_cast<giml::EnvelopeFilter<float>&>(effect).setParams(p.get("q", 10.f), p.get("attack", 7.76f), p.get("release", 1105.f));
+        } else if (type == "expander") {
+            static_cast<giml::Expander<float>&>(effect).setParams(p.get("thresh", 0.f), p.get("ratio", 2.f), p.get("knee", 1.f),
+                                                                p.get("attack", 3.5f), p.get("release", 100.f));
+        } else if (type == "flanger") {
+            static_cast<giml::Flanger<float>&>(effect).setParams(p.get("rate", 0.2f), p.get("depth", 5.f), p.get("blend", 0.5f));
+        } else if (type == "phaser") {
+            static_cast<giml::Phaser<float>&>(effect).setParams(p.get("rate", 0.5f), p.get("feedback", 0.85f));
+        } else if (type == "reverb") {
+            typedef giml::Reverb<float>::RoomType RoomType;
+            static_cast<giml::Reverb<float>&>(effect).setParams(p.get("time", 0.03f), p.get("regen", 0.6f), p.get("damping", 0.75f),
+                p.get("blend", 0.5f), p.get("room", 1000.f), p.get("absorption", 0.75f),
+                p.choose<RoomType>("shape", RoomType::CUBE, {
+                    { "cube", RoomType::CUBE }, { "sphere", RoomType::SPHERE },
+                    { "pyramid", RoomType::SQUARE_PYRAMID }, { "cylinder", RoomType::CYLINDER } }));
+        } else if (type == "saturation") {
+            giml::Saturation<float>& e = static_cast<giml::Saturation<float>&>(effect);
+            // Only touch what is set, the setters do not accept 0 dB as a neutral value
+            if (p.spec.params.count("drive")) { e.setDrive(p.get("drive", 0.f)); }
+            if (p.spec.params.count("preamp")) { e.setPreAmpGain(p.get("preamp", 0.f)); }
+            if (p.spec.params.count("volume")) { e.setVolume(p.get("volume", 0.f)); }
+        } else if (type == "tremolo") {
+            static_cast<giml::Tremolo<float>&>(effect).setParams(p.get("speed", 1000.f), p.get("depth", 1.f));
+        }
+
+        if (!p.error.empty()) {
+            error = p.error;
+            return false;
+        }
+        for (const auto& kv : p.spec.params) {
+            if (!p.used.count(kv.first)) {
+                error = "unknown parameter '" + kv.first + "' for " + type;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
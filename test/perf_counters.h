@@ -0,0 +1,188 @@
+#pragma once
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+/* Hardware performance counters via Linux `perf_event_open`.
+   The counters are opened as one group led by `cycles` and read together (`PERF_FORMAT_GROUP`),
+   so that instructions, cycles and misses cover the same interval and IPC is consistent.
+   If the group cannot be created or never gets scheduled (more counters than the PMU has),
+   each counter is opened on its own instead. Missing ones (VMs, containers,
+   `perf_event_paranoid`, non-Linux platforms) are simply reported as unavailable */
+class PerfCounters {
+public:
+    enum Counter {
+        INSTRUCTIONS, CYCLES, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, DTLB_MISSES,
+        NUM_COUNTERS
+    };
+
+    static const char* name(int counter) {
+        static const char* names[NUM_COUNTERS] = {
+            "instructions", "cycles", "L1dMisses", "LLCMisses", "branchMisses", "dTLBMisses"
+        };
+        return names[counter];
+    }
+
+    PerfCounters() {
+        for (int i = 0; i < NUM_COUNTERS; i++) { fds[i] = -1; grouped[i] = false; values[i] = 0; }
+    }
+    ~PerfCounters() { this->close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * Opens every counter the platform allows, counting user-space of the calling thread only.
+     * @return true if at least one counter is available
+     */
+    bool open() {
+#ifdef __linux__
+        const uint64_t scaling = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[CYCLES] = openCounter(CYCLES, -1, scaling | PERF_FORMAT_GROUP);
+        if (fds[CYCLES] >= 0) {
+            grouped[CYCLES] = true;
+            for (int i = 0; i < NUM_COUNTERS; i++) {
+                if (i == CYCLES) { continue; }
+                fds[i] = openCounter(i, fds[CYCLES], scaling | PERF_FORMAT_GROUP);
+                grouped[i] = fds[i] >= 0;
+            }
+            if (!this->groupRuns()) { this->close(); }
+        }
+        // whatever the group could not take is counted on its own
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] < 0) { fds[i] = openCounter(i, -1, scaling); }
+        }
+#endif
+        return this->anyAvailable();
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] >= 0) { ::close(fds[i]); }
+            fds[i] = -1;
+            grouped[i] = false;
+        }
+#endif
+    }
+
+    bool available(int counter) const { return fds[counter] >= 0; }
+
+    // true if `counter` is read together with `cycles` in one group
+    bool isGrouped(int counter) const { return grouped[counter]; }
+
+    bool anyAvailable() const {
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (this->available(i)) { return true; }
+        }
+        return false;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (grouped[CYCLES]) {
+            ioctl(fds[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] < 0 || grouped[i]) { continue; }
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Stops counting and latches the values, scaled up if the kernel had to multiplex counters
+    void stop() {
+#ifdef __linux__
+        if (grouped[CYCLES]) { ioctl(fds[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP); }
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] >= 0 && !grouped[i]) { ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0); }
+        }
+        for (int i = 0; i < NUM_COUNTERS; i++) { values[i] = 0; }
+        if (grouped[CYCLES]) { this->readGroup(); }
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] < 0 || grouped[i]) { continue; }
+            uint64_t data[3] = { 0, 0, 0 }; // value, time enabled, time running
+            if (::read(fds[i], data, sizeof(data)) != sizeof(data)) { continue; }
+            values[i] = scale(data[0], data[1], data[2]);
+        }
+#endif
+    }
+
+    uint64_t value(int counter) const { return values[counter]; }
+
+    // Instructions per cycle, 0 if either counter is unavailable
+    double ipc() const {
+        if (!this->available(INSTRUCTIONS) || !this->available(CYCLES) || values[CYCLES] == 0) { return 0.0; }
+        return (double)values[INSTRUCTIONS] / values[CYCLES];
+    }
+
+private:
+    int fds[NUM_COUNTERS];
+    bool grouped[NUM_COUNTERS];
+    uint64_t values[NUM_COUNTERS];
+
+    static uint64_t scale(uint64_t value, uint64_t enabled, uint64_t running) {
+        return (running > 0 && running < enabled) ? (uint64_t)((double)value * enabled / running) : value;
+    }
+
+#ifdef __linux__
+    static int openCounter(int counter, int groupFd, uint64_t readFormat) {
+        const uint32_t cacheRead = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint32_t types[NUM_COUNTERS] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+        };
+        const uint64_t configs[NUM_COUNTERS] = {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_L1D | cacheRead,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_DTLB | cacheRead
+        };
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[counter];
+        attr.config = configs[counter];
+        attr.disabled = (groupFd < 0) ? 1 : 0; // members start and stop with their leader
+        attr.exclude_kernel = 1; // allowed with the default perf_event_paranoid
+        attr.exclude_hv = 1;
+        attr.read_format = readFormat;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0); // this thread, any CPU
+    }
+
+    // Reads the whole group at once: { nr, time enabled, time running, leader, members in opening order }
+    void readGroup() {
+        uint64_t data[3 + NUM_COUNTERS];
+        ssize_t bytes = ::read(fds[CYCLES], data, sizeof(data));
+        if (bytes < (ssize_t)(3 * sizeof(uint64_t)) || bytes < (ssize_t)((3 + data[0]) * sizeof(uint64_t))) { return; }
+        uint64_t n = 0;
+        values[CYCLES] = scale(data[3 + n++], data[1], data[2]);
+        for (int i = 0; i < NUM_COUNTERS && n < data[0]; i++) {
+            if (i == CYCLES || !grouped[i]) { continue; }
+            values[i] = scale(data[3 + n++], data[1], data[2]);
+        }
+    }
+
+    // A group larger than the PMU opens fine but is never scheduled, which shows as zero running time
+    bool groupRuns() {
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        volatile uint64_t spin = 0;
+        for (int i = 0; i < 10000; i++) { spin = spin + i; }
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t data[3 + NUM_COUNTERS];
+        ssize_t bytes = ::read(fds[CYCLES], data, sizeof(data));
+        return bytes >= (ssize_t)(3 * sizeof(uint64_t)) && data[2] > 0;
+    }
+#endif
+};
+
+#endif
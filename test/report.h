@@ -0,0 +1,89 @@
+#pragma once
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Machine-readable benchmark report.
+   Written as JSON Lines, one measurement per line:
+   {"effect": "Reverb", "metric": "processSample", "value": 152.000, "unit": "ns"}
+   A previous report can be loaded as a baseline to gate regressions */
+class BenchmarkReport {
+public:
+    struct Entry {
+        std::string effect, metric, unit;
+        double value = 0.0;
+    };
+
+    void add(const std::string& effect, const std::string& metric, double value, const std::string& unit) {
+        entries.push_back({ effect, metric, unit, value });
+    }
+
+    const std::vector<Entry>& getEntries() const { return entries; }
+
+    bool write(const char* filename) const {
+        FILE* pFile = fopen(filename, "w");
+        if (!pFile) {
+            std::cout << "Could not open report for writing: " << filename << std::endl;
+            return false;
+        }
+        for (const Entry& e : entries) {
+            fprintf(pFile, "{\"effect\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}\n",
+                    e.effect.c_str(), e.metric.c_str(), e.value, e.unit.c_str());
+        }
+        fclose(pFile);
+        return true;
+    }
+
+    // Reads a report previously written by `write()`
+    bool read(const char* filename) {
+        FILE* pFile = fopen(filename, "r");
+        if (!pFile) {
+            std::cout << "Could not open report for reading: " << filename << std::endl;
+            return false;
+        }
+        char line[512], effect[128], metric[128], unit[32];
+        double value;
+        while (fgets(line, sizeof(line), pFile)) {
+            if (sscanf(line, " {\"effect\": \"%127[^\"]\", \"metric\": \"%127[^\"]\", \"value\": %lf, \"unit\": \"%31[^\"]\"}",
+                       effect, metric, &value, unit) == 4) {
+                this->add(effect, metric, value, unit);
+            }
+        }
+        fclose(pFile);
+        return true;
+    }
+
+    /**
+     * Compares this report against `baseline` and prints every regression.
+     * Timings (`ns`) are noisy so they get their own tolerance,
+     * memory (`bytes`) is deterministic and uses `memoryTolerance`.
+     * Hardware counters (`events`, `ratio`) are informational only and never gated
+     * @return number of regressions found
+     */
+    int compare(const BenchmarkReport& baseline, double timeTolerance, double memoryTolerance) const {
+        int regressions = 0;
+        for (const Entry& e : entries) {
+            if (e.unit != "ns" && e.unit != "bytes") { continue; }
+            for (const Entry& b : baseline.entries) {
+                if (b.effect != e.effect || b.metric != e.metric || b.unit != e.unit) { continue; }
+                double tolerance = (e.unit == "ns") ? timeTolerance : memoryTolerance;
+                if (e.value > b.value * (1.0 + tolerance)) {
+                    std::cout << "REGRESSION " << e.effect << " " << e.metric << ": "
+                              << b.value << " -> " << e.value << " " << e.unit << std::endl;
+                    regressions++;
+                }
+                break;
+            }
+        }
+        return regressions;
+    }
+
+private:
+    std::vector<Entry> entries;
+};
+
+#endif
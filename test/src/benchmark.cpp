@@ -9,6 +9,7 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <algorithm>
 
 
 // Benchmark utilities
@@ -243,13 +244,15 @@ void benchmarkTremolo() {
 void runFullAudioProcessingTest() {
     std::cout << "\n=== FULL AUDIO PROCESSING TEST ===" << std::endl;
     
-    WAVLoader loader { "audio/Gmaj.wav" };  // Use existing audio file
-    WAVWriter writer { "audio/benchmark_out.wav", loader.sampleRate };
+    WAVStreamReader reader { "audio/Gmaj.wav", 512 };  // Use existing audio file
+    if (!reader.isOpen()) { return; }
+    int sampleRate = reader.getSampleRate();
+    WAVBlockWriter writer { "audio/benchmark_out.wav", sampleRate, 1, WAVBlockWriter::Format::INT32 };
     
     // Create all effects
-    auto reverb = std::make_unique<giml::Reverb<float>>(loader.sampleRate, 4, 20, 4, 2);
-    auto delay = std::make_unique<giml::Delay<float>>(loader.sampleRate);
-    auto chorus = std::make_unique<giml::Chorus<float>>(loader.sampleRate);
+    auto reverb = std::make_unique<giml::Reverb<float>>(sampleRate, 4, 20, 4, 2);
+    auto delay = std::make_unique<giml::Delay<float>>(sampleRate);
+    auto chorus = std::make_unique<giml::Chorus<float>>(sampleRate);
     
     // Configure effects
     reverb->setParams(0.030f, 0.6f, 0.75f, 0.25f, 1000.f, 0.75f, giml::Reverb<float>::RoomType::CUBE);
@@ -260,34 +263,40 @@ void runFullAudioProcessingTest() {
     delay->enable();
     chorus->enable();
     
-    float input, output;
-    int sampleCount = 0;
+    std::vector<float> dry(reader.getChunkFrames());
+    long long sampleCount = 0;
     long long totalProcessingTime = 0;
     
-    while (loader.readSample(&input)) {
+    // The effects are mono, process the first channel
+    while (size_t frames = reader.readChunk()) {
+        float* block = reader.getChannel(0);
+        std::copy(block, block + frames, dry.begin());
+
         auto begin = std::chrono::steady_clock::now();
         
         // Process through effects chain
-        output = input;
-        output = reverb->processSample(output);
-        output = delay->processSample(output);
-        output = chorus->processSample(output);
-        output = giml::powMix<float>(output, input, 0.5f);
+        reverb->processBlock(block, frames);
+        delay->processBlock(block, frames);
+        chorus->processBlock(block, frames);
+        for (size_t i = 0; i < frames; i++) {
+            block[i] = giml::powMix<float>(block[i], dry[i], 0.5f);
+        }
         
         auto end = std::chrono::steady_clock::now();
         totalProcessingTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
         
-        writer.writeSample(output);
-        sampleCount++;
+        writer.writeMono(block, frames);
         
-        if (sampleCount % 48000 == 0) {
-            std::cout << "Processed " << (sampleCount / 48000) << " seconds of audio" << std::endl;
+        if ((sampleCount + (long long)frames) / sampleRate > sampleCount / sampleRate) {
+            std::cout << "Processed " << ((sampleCount + frames) / sampleRate) << " seconds of audio" << std::endl;
         }
+        sampleCount += frames;
     }
+    if (sampleCount == 0) { return; }
     
     std::cout << "Total samples processed: " << sampleCount << std::endl;
     std::cout << "Average processing time per sample: " << (totalProcessingTime / sampleCount) << " ns" << std::endl;
-    std::cout << "Real-time factor: " << (1000000000.0 / (totalProcessingTime / sampleCount)) / loader.sampleRate << "x" << std::endl;
+    std::cout << "Real-time factor: " << (1000000000.0 * sampleCount / totalProcessingTime) / sampleRate << "x" << std::endl;
 }
 
 int main() {
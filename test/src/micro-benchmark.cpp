@@ -1,3 +1,8 @@
+// Route gimmel's allocations through the counting allocator (must come before gimmel)
+#include "alloc_counter.h"
+#include "report.h"
+#include "perf_counters.h"
+
 // Include all gimmel effects
 #include "../include/gimmel.hpp"
 
@@ -6,6 +11,19 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#ifdef _MSC_VER
+#include <intrin.h> // _ReadWriteBarrier
+#endif
 
 // Benchmark utilities
 static long long timeElapsed = 0L;
@@ -21,17 +39,51 @@ static long long iterations = 0L;
         iterations++; \
    }
 
+// Optimization barrier: makes the compiler assume `value` is read, so an otherwise unused result
+// (e.g. a timed copy) is not elided
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#endif
+}
+
+// Machine-readable results, see report.h
+static BenchmarkReport report;
+
 #define BENCHMARK_REPORT(effectName, operation) { \
         if (iterations > 0) { \
             std::cout << std::setw(15) << effectName << " " << std::setw(15) << operation \
                       << ": " << std::setw(8) << (timeElapsed / iterations) << " ns avg" << std::endl; \
+            report.add(effectName, operation, (double)timeElapsed / iterations, "ns"); \
         } \
    }
 
+// Hardware counters, only collected with `--perf`
+static PerfCounters perf;
+static bool perfEnabled = false;
+
+#define MEMORY_REPORT(effectName, metric, bytes) { \
+        std::cout << std::setw(15) << effectName << " " << std::setw(15) << metric \
+                  << ": " << std::setw(8) << (bytes) << " bytes" << std::endl; \
+        report.add(effectName, metric, (double)(bytes), "bytes"); \
+   }
+
 // Test constants
 const int SAMPLE_RATE = 48000;
 const int TEST_ITERATIONS = 100000;  // More iterations for micro-benchmarks
 const float TEST_INPUT = 0.5f;
+const int LIFECYCLE_ITERATIONS = 10; // construction/copy are expensive for some effects (Reverb)
+const int SIMD_BLOCK_SIZE = 1024;
+const int SIMD_ITERATIONS = 10000;
+const float FIXED_INPUT_PEAK = 0.4f; // leaves headroom for effects that boost (Tremolo), fixed-point saturates at 1
+const float FIXED_Q31_TOLERANCE = 1e-5f; // -100 dB
+const float FIXED_Q15_TOLERANCE = 3e-3f; // -50 dB, Biquad keeps its recursive state in 16 bits
+const float STORAGE_INPUT_PEAK = 0.25f; // Reverb's combs resonate above the input level, int16_t storage clips at 1
 
 // Effect benchmark template
 template<typename EffectType>
@@ -49,14 +101,1041 @@ void benchmarkEffect(const std::string& effectName, std::unique_ptr<EffectType>&
         (void)output; // Suppress unused variable warning
     }
     BENCHMARK_REPORT(effectName, "processSample");
+
+    // Benchmark processBlock, per sample
+    std::vector<float> block(SIMD_BLOCK_SIZE, input);
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS / SIMD_BLOCK_SIZE; i++) {
+        std::fill(block.begin(), block.end(), input);
+        BENCHMARK_START();
+        effect->processBlock(block.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE;
+    BENCHMARK_REPORT(effectName, "processBlock");
+
+    // Hardware counters, in a separate untimed loop so the clock reads are not counted
+    if (perfEnabled) {
+        perf.start();
+        for (int i = 0; i < TEST_ITERATIONS; i++) {
+            volatile float output = effect->processSample(input);
+            (void)output;
+        }
+        perf.stop();
+        for (int c = 0; c < PerfCounters::NUM_COUNTERS; c++) {
+            if (!perf.available(c)) { continue; }
+            double perSample = (double)perf.value(c) / TEST_ITERATIONS;
+            std::cout << std::setw(15) << effectName << " " << std::setw(15) << PerfCounters::name(c)
+                      << ": " << std::setw(8) << std::fixed << std::setprecision(3) << perSample
+                      << std::defaultfloat << " /sample" << std::endl;
+            report.add(effectName, std::string(PerfCounters::name(c)) + "/sample", perSample, "events");
+        }
+        if (perf.ipc() > 0.0) {
+            std::cout << std::setw(15) << effectName << " " << std::setw(15) << "IPC"
+                      << ": " << std::setw(8) << std::fixed << std::setprecision(3) << perf.ipc()
+                      << std::defaultfloat << std::endl;
+            report.add(effectName, "IPC", perf.ipc(), "ratio");
+        }
+    }
+}
+
+// Detects whether an effect provides `reset()`
+template <typename EffectType, typename = void>
+struct HasReset : std::false_type {};
+template <typename EffectType>
+struct HasReset<EffectType, std::void_t<decltype(std::declval<EffectType&>().reset())>> : std::true_type {};
+
+/**
+ * Lifecycle benchmark: construction, copy and `reset()` time,
+ * plus the heap usage of construction and copy as seen by the counting allocator.
+ * `makeEffect` must return a `std::unique_ptr<EffectType>`
+ */
+template <typename EffectType, typename Factory>
+void benchmarkLifecycle(const std::string& effectName, Factory makeEffect) {
+    // Construction (timed together with destruction of the previous iteration's instance)
+    BENCHMARK_RESET();
+    for (int i = 0; i < LIFECYCLE_ITERATIONS; i++) {
+        BENCHMARK_START();
+        auto effect = makeEffect();
+        BENCHMARK_END_AND_RECORD();
+    }
+    BENCHMARK_REPORT(effectName, "construct");
+
+    // Construction heap usage
+    size_t baseline = alloc_counter::stats().currentBytes;
+    alloc_counter::resetPeak();
+    auto effect = makeEffect();
+    MEMORY_REPORT(effectName, "heapPeak", alloc_counter::stats().peakBytes - baseline);
+    MEMORY_REPORT(effectName, "heapSteady", alloc_counter::stats().currentBytes - baseline);
+    MEMORY_REPORT(effectName, "objectSize", sizeof(EffectType));
+
+    // Copy construction
+    BENCHMARK_RESET();
+    for (int i = 0; i < LIFECYCLE_ITERATIONS; i++) {
+        BENCHMARK_START();
+        EffectType copy(*effect);
+        doNotOptimize(copy);
+        BENCHMARK_END_AND_RECORD();
+    }
+    BENCHMARK_REPORT(effectName, "copy");
+
+    baseline = alloc_counter::stats().currentBytes;
+    alloc_counter::resetPeak();
+    {
+        EffectType copy(*effect);
+        MEMORY_REPORT(effectName, "copyHeapPeak", alloc_counter::stats().peakBytes - baseline);
+    }
+
+    // Reset
+    if constexpr (HasReset<EffectType>::value) {
+        effect->enable();
+        for (int i = 0; i < 1000; i++) { effect->processSample(TEST_INPUT); } // dirty the state first
+        BENCHMARK_RESET();
+        for (int i = 0; i < LIFECYCLE_ITERATIONS; i++) {
+            BENCHMARK_START();
+            effect->reset();
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(effectName, "reset");
+    } else {
+        std::cout << std::setw(15) << effectName << " " << std::setw(15) << "reset" << ":      n/a" << std::endl;
+    }
+
+    // Sample rate change within the allocated capacity: must not touch the heap
+    baseline = alloc_counter::stats().currentBytes;
+    alloc_counter::resetPeak();
+    BENCHMARK_RESET();
+    for (int i = 0; i < LIFECYCLE_ITERATIONS; i++) {
+        BENCHMARK_START();
+        effect->prepare(i % 2 ? SAMPLE_RATE : SAMPLE_RATE / 2, 512);
+        BENCHMARK_END_AND_RECORD();
+    }
+    BENCHMARK_REPORT(effectName, "prepare");
+    MEMORY_REPORT(effectName, "prepareHeapPeak", alloc_counter::stats().peakBytes - baseline);
+}
+
+/**
+ * SIMD kernel benchmark: time per block of every kernel table the CPU supports,
+ * checked against the scalar table. Returns the number of tables that disagree with it
+ */
+int benchmarkSimdKernels() {
+    using namespace giml::simd;
+    std::vector<float> input(SIMD_BLOCK_SIZE), other(SIMD_BLOCK_SIZE), table(SIMD_BLOCK_SIZE + 1);
+    std::vector<int32_t> indices(SIMD_BLOCK_SIZE);
+    for (int i = 0; i < SIMD_BLOCK_SIZE; i++) {
+        input[i] = ::sinf(0.05f * i) * 1.5f;
+        other[i] = ::cosf(0.011f * i);
+        indices[i] = (i * 97) % SIMD_BLOCK_SIZE; // scattered reads, like modulated delay taps
+        table[i] = ::sinf(2.f * (float)M_PI * i / SIMD_BLOCK_SIZE);
+    }
+    table[SIMD_BLOCK_SIZE] = table[0]; // guard sample
+
+    // Runs every kernel of `k` once, into `out` (8 blocks)
+    auto runAll = [&](const Kernels& k, std::vector<float>& out) {
+        out.assign(8 * SIMD_BLOCK_SIZE, 0.f);
+        float* x = out.data();
+        std::copy(input.begin(), input.end(), x);
+        k.scale(x, SIMD_BLOCK_SIZE, 0.7f);
+        x += SIMD_BLOCK_SIZE;
+        std::copy(other.begin(), other.end(), x);
+        k.mulAdd(x, input.data(), SIMD_BLOCK_SIZE, 0.3f);
+        x += SIMD_BLOCK_SIZE;
+        std::copy(input.begin(), input.end(), x);
+        k.clamp(x, SIMD_BLOCK_SIZE, -1.f, 1.f);
+        x += SIMD_BLOCK_SIZE;
+        k.gather(x, input.data(), indices.data(), SIMD_BLOCK_SIZE);
+        x += SIMD_BLOCK_SIZE;
+        k.phasor(x, SIMD_BLOCK_SIZE, 0.3, 0.01234567); // no phase lands on a wrap, where rounding could flip it to 0
+        x += SIMD_BLOCK_SIZE;
+        std::copy(input.begin(), input.end(), x);
+        k.sine(x, SIMD_BLOCK_SIZE);
+        x += SIMD_BLOCK_SIZE;
+        std::copy(input.begin(), input.end(), x);
+        k.wavetable(x, SIMD_BLOCK_SIZE, table.data(), SIMD_BLOCK_SIZE);
+        x += SIMD_BLOCK_SIZE;
+        x[0] = k.peak(input.data(), SIMD_BLOCK_SIZE);
+    };
+
+    std::vector<float> expected, actual;
+    runAll(*kernelsFor(Isa::Scalar), expected);
+    std::cout << "Selected: " << isaName(kernels().isa) << std::endl;
+
+    int mismatches = 0;
+    for (Isa isa : { Isa::Scalar, Isa::SSE2, Isa::NEON, Isa::AVX2, Isa::AVX512 }) {
+        const Kernels* k = kernelsFor(isa);
+        if (!k) { continue; }
+        std::string name = std::string("simd-") + isaName(isa);
+
+        runAll(*k, actual);
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (::fabsf(actual[i] - expected[i]) > 1e-6f * (1.f + ::fabsf(expected[i]))) { // fma rounds once
+                std::cout << std::setw(15) << name << ": mismatch at " << i << " (" << actual[i]
+                          << " vs " << expected[i] << ")" << std::endl;
+                mismatches++;
+                break;
+            }
+        }
+
+        std::vector<float> block(input);
+        std::vector<float> out(SIMD_BLOCK_SIZE);
+        volatile float sink = 0.f;
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            k->scale(block.data(), SIMD_BLOCK_SIZE, (i & 1) ? 2.f : 0.5f);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "scale");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            k->mulAdd(out.data(), input.data(), SIMD_BLOCK_SIZE, (i & 1) ? 1.f : -1.f);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "mulAdd");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            k->clamp(block.data(), SIMD_BLOCK_SIZE, -1.f, 1.f);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "clamp");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            sink = k->peak(input.data(), SIMD_BLOCK_SIZE);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "peak");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            k->gather(out.data(), input.data(), indices.data(), SIMD_BLOCK_SIZE);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "gather");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            BENCHMARK_START();
+            k->phasor(out.data(), SIMD_BLOCK_SIZE, 0.3, 0.01234567);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "phasor");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            std::copy(input.begin(), input.end(), block.begin());
+            BENCHMARK_START();
+            k->sine(block.data(), SIMD_BLOCK_SIZE);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "sine");
+        BENCHMARK_RESET();
+        for (int i = 0; i < SIMD_ITERATIONS; i++) {
+            std::copy(input.begin(), input.end(), block.begin());
+            BENCHMARK_START();
+            k->wavetable(block.data(), SIMD_BLOCK_SIZE, table.data(), SIMD_BLOCK_SIZE);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT(name, "wavetable");
+        (void)sink;
+    }
+    return mismatches;
+}
+
+/**
+ * Lane benchmark: one `EffectType<f32x4>` against four `EffectType<float>` instances on
+ * four different channels, checked lane by lane. Returns 1 if any lane disagrees
+ */
+template <template <typename> class EffectType, typename Setup>
+int benchmarkLanes(const std::string& effectName, Setup setup) {
+    using giml::simd::f32x4;
+    std::vector<EffectType<float>> channels(4, EffectType<float>(SAMPLE_RATE));
+    EffectType<f32x4> lanes(SAMPLE_RATE);
+    for (auto& c : channels) { setup(c); c.enable(); }
+    setup(lanes);
+    lanes.enable();
+
+    int mismatches = 0;
+    volatile float sink = 0.f;
+    float frame[4], out[4];
+    auto input = [&](int n) {
+        for (int c = 0; c < 4; c++) { frame[c] = ::sinf(0.01f * (c + 1) * n) * ((n % 9000) < 4000 ? 0.8f : 0.05f); }
+    };
+
+    BENCHMARK_RESET();
+    for (int n = 0; n < TEST_ITERATIONS; n++) {
+        input(n);
+        BENCHMARK_START();
+        for (int c = 0; c < 4; c++) { out[c] = channels[c].processSample(frame[c]); }
+        BENCHMARK_END_AND_RECORD();
+        sink = out[0];
+    }
+    BENCHMARK_REPORT(effectName, "4x float");
+
+    // replay the same input so lane and channel state line up
+    for (auto& c : channels) { c.reset(); }
+    BENCHMARK_RESET();
+    for (int n = 0; n < TEST_ITERATIONS; n++) {
+        input(n);
+        BENCHMARK_START();
+        f32x4 y = lanes.processSample(f32x4::load(frame));
+        BENCHMARK_END_AND_RECORD();
+        for (int c = 0; c < 4 && !mismatches; c++) {
+            float expected = channels[c].processSample(frame[c]);
+            if (::fabsf(y[c] - expected) > 1e-6f * (1.f + ::fabsf(expected))) { // double vs float dB math
+                std::cout << std::setw(15) << effectName << ": lane " << c << " mismatch at " << n << " ("
+                          << y[c] << " vs " << expected << ")" << std::endl;
+                mismatches = 1;
+            }
+        }
+    }
+    BENCHMARK_REPORT(effectName, "f32x4");
+    (void)sink;
+    return mismatches;
+}
+
+/**
+ * `OnePole` wrapped as an effect for `benchmarkFixed()`, as a lowpass or as a highpass (`in - lpf(in)`)
+ */
+template <typename T>
+struct OnePoleEffect {
+    giml::OnePole<T> filter;
+    bool highpass = false;
+    OnePoleEffect(int /*sampleRate*/) {}
+    void enable() {}
+    void reset() { this->filter.reset(); }
+    T processSample(T in) { return this->highpass ? this->filter.hpf(in) : this->filter.lpf(in); }
+};
+
+/**
+ * Fixed-point benchmark: `EffectType<Q>` against the `EffectType<float>` reference on the same signal,
+ * timed per sample (and counted in cycles with `--perf`). Returns 1 if the output strays further than `tolerance`
+ */
+template <template <typename> class EffectType, typename Q, typename Setup>
+int benchmarkFixed(const std::string& effectName, const std::string& format, float tolerance, Setup setup) {
+    EffectType<float> reference(SAMPLE_RATE);
+    EffectType<Q> fixed(SAMPLE_RATE);
+    setup(reference);
+    setup(fixed);
+    reference.enable();
+    fixed.enable();
+
+    std::vector<float> input(TEST_ITERATIONS), expected(TEST_ITERATIONS);
+    for (int n = 0; n < TEST_ITERATIONS; n++) { // bursts over a slow sine, to exercise detectors and filters
+        float burst = ((n % 20000) < 9000) ? 1.f : 0.03f;
+        input[n] = FIXED_INPUT_PEAK * (0.75f * ::sinf(0.013f * n) * burst + 0.25f * ::sinf(0.0011f * n));
+    }
+
+    BENCHMARK_RESET();
+    for (int n = 0; n < TEST_ITERATIONS; n++) {
+        BENCHMARK_START();
+        expected[n] = reference.processSample(input[n]);
+        BENCHMARK_END_AND_RECORD();
+    }
+    BENCHMARK_REPORT(effectName, "float");
+
+    float maxError = 0.f;
+    BENCHMARK_RESET();
+    for (int n = 0; n < TEST_ITERATIONS; n++) {
+        Q in = input[n];
+        BENCHMARK_START();
+        Q out = fixed.processSample(in);
+        BENCHMARK_END_AND_RECORD();
+        maxError = std::max(maxError, ::fabsf(static_cast<float>(out) - expected[n]));
+    }
+    BENCHMARK_REPORT(effectName, format);
+    double errordB = 20.0 * ::log10(std::max(maxError, 1e-12f));
+    std::cout << std::setw(15) << effectName << " " << std::setw(15) << (format + " error")
+              << ": " << std::setw(8) << std::fixed << std::setprecision(1) << errordB << std::defaultfloat << " dB" << std::endl;
+    report.add(effectName, format + " error", errordB, "dB");
+
+    if (perfEnabled && perf.available(PerfCounters::CYCLES)) {
+        reference.reset();
+        fixed.reset();
+        volatile float sink = 0.f;
+        perf.start();
+        for (int n = 0; n < TEST_ITERATIONS; n++) { sink = reference.processSample(input[n]); }
+        perf.stop();
+        double floatCycles = (double)perf.value(PerfCounters::CYCLES) / TEST_ITERATIONS;
+        perf.start();
+        for (int n = 0; n < TEST_ITERATIONS; n++) { sink = static_cast<float>(fixed.processSample(Q(input[n]))); }
+        perf.stop();
+        double fixedCycles = (double)perf.value(PerfCounters::CYCLES) / TEST_ITERATIONS;
+        (void)sink;
+        report.add(effectName, "float cycles/sample", floatCycles, "events");
+        report.add(effectName, format + " cycles/sample", fixedCycles, "events");
+        std::cout << std::setw(15) << effectName << " " << std::setw(15) << "cycles/sample"
+                  << ": " << std::fixed << std::setprecision(1) << floatCycles << " float, " << fixedCycles << " " << format
+                  << std::defaultfloat << std::endl;
+    }
+
+    if (maxError > tolerance) {
+        std::cout << std::setw(15) << effectName << ": " << format << " differs from float by " << maxError
+                  << " (tolerance " << tolerance << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Delay-line storage benchmark: `EffectType<float, StorageT>` against `EffectType<float>` on the same signal.
+ * Reports the heap used by the delay lines, the time per sample and the noise floor
+ * (RMS of the difference in dBFS). Returns 1 if the noise floor is above `maxNoisedB`
+ */
+template <template <typename, typename> class EffectType, typename StorageT, typename Setup, typename... Args>
+int benchmarkStorage(const std::string& effectName, const std::string& format, double maxNoisedB, Setup setup, Args... args) {
+    size_t baseline = alloc_counter::stats().currentBytes;
+    auto stored = std::make_unique<EffectType<float, StorageT>>(args...);
+    MEMORY_REPORT(effectName, format + " heap", alloc_counter::stats().currentBytes - baseline);
+    auto reference = std::make_unique<EffectType<float, float>>(args...);
+    setup(*reference);
+    setup(*stored);
+    reference->enable();
+    stored->enable();
+
+    double squaredError = 0.0;
+    BENCHMARK_RESET();
+    for (int n = 0; n < TEST_ITERATIONS; n++) { // bursts over a slow sine, decaying tails in between
+        float burst = ((n % 20000) < 9000) ? 1.f : 0.f;
+        float in = STORAGE_INPUT_PEAK * (0.75f * ::sinf(0.013f * n) * burst + 0.25f * ::sinf(0.0011f * n));
+        float expected = reference->processSample(in);
+        BENCHMARK_START();
+        float out = stored->processSample(in);
+        BENCHMARK_END_AND_RECORD();
+        squaredError += (double)(out - expected) * (out - expected);
+    }
+    BENCHMARK_REPORT(effectName, format);
+    double noisedB = 10.0 * ::log10(std::max(squaredError / TEST_ITERATIONS, 1e-24));
+    std::cout << std::setw(15) << effectName << " " << std::setw(15) << (format + " noise")
+              << ": " << std::setw(8) << std::fixed << std::setprecision(1) << noisedB << std::defaultfloat << " dBFS" << std::endl;
+    report.add(effectName, format + " noise", noisedB, "dB");
+
+    if (noisedB > maxNoisedB) {
+        std::cout << std::setw(15) << effectName << ": " << format << " storage noise " << noisedB
+                  << " dBFS (limit " << maxNoisedB << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Early reflections benchmark: one `EarlyReflections` with `numTaps` taps, per sample and per block,
+ * against a `Delay` (no feedback) per tap. Returns 1 if `processBlock()` disagrees with `processSample()`
+ */
+int benchmarkEarlyReflections(int numTaps) {
+    std::string name = "ER " + std::to_string(numTaps) + " taps";
+    giml::EarlyReflections<float> perSample(SAMPLE_RATE);
+    perSample.setRoom(40.f, 0.5f, giml::Reverb<float>::RoomType::CUBE, numTaps);
+    perSample.prepare(SAMPLE_RATE, SIMD_BLOCK_SIZE);
+    perSample.enable();
+    giml::EarlyReflections<float> perBlock(perSample);
+    std::vector<giml::Delay<float>> delays(numTaps, giml::Delay<float>(SAMPLE_RATE));
+    for (int k = 0; k < numTaps; k++) {
+        delays[k].setParams(20.f + 3.f * k, 0.f, 0.f, 1.f);
+        delays[k].enable();
+    }
+
+    std::vector<float> block(SIMD_BLOCK_SIZE);
+    int mismatches = 0;
+    volatile float sink = 0.f;
+    BENCHMARK_RESET();
+    for (int b = 0; b < SIMD_ITERATIONS / 10; b++) {
+        for (int i = 0; i < SIMD_BLOCK_SIZE; i++) { block[i] = ::sinf(0.013f * (b * SIMD_BLOCK_SIZE + i)); }
+        BENCHMARK_START();
+        perBlock.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+        for (int i = 0; i < SIMD_BLOCK_SIZE && mismatches == 0; i++) {
+            float expected = perSample.processSample(::sinf(0.013f * (b * SIMD_BLOCK_SIZE + i)));
+            if (::fabsf(block[i] - expected) > 1e-5f) {
+                std::cout << std::setw(15) << name << ": processBlock mismatch at " << (b * SIMD_BLOCK_SIZE + i)
+                          << " (" << block[i] << " vs " << expected << ")" << std::endl;
+                mismatches++;
+            }
+        }
+    }
+    iterations *= SIMD_BLOCK_SIZE; // per sample
+    BENCHMARK_REPORT(name, "processBlock");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        sink = perSample.processSample(TEST_INPUT);
+        BENCHMARK_END_AND_RECORD();
+    }
+    BENCHMARK_REPORT(name, "processSample");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float sum = 0.f;
+        for (auto& d : delays) { sum += d.processSample(TEST_INPUT); }
+        BENCHMARK_END_AND_RECORD();
+        sink = sum;
+    }
+    BENCHMARK_REPORT(name, "Delay per tap");
+    (void)sink;
+    return mismatches;
+}
+
+/**
+ * Quadrature oscillator benchmark: time per sample of `QuadOsc` against `SinOsc` plus a `std::cos`,
+ * then 24 hours of an LFO at a 1 kHz control rate checked against `sin` and `cos` of the exact phase
+ * (every 997th sample). Returns 1 if it strays more than 2e-5
+ */
+int benchmarkQuadOsc(float freqHz) {
+    std::ostringstream label;
+    label << "QuadOsc " << freqHz << " Hz";
+    std::string name = label.str();
+    giml::QuadOsc<float> quad(SAMPLE_RATE);
+    giml::SinOsc<float> sine(SAMPLE_RATE);
+    quad.setFrequency(freqHz);
+    sine.setFrequency(freqHz);
+    volatile float sink = 0.f;
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float s = quad.processSample();
+        float c = quad.getCos();
+        BENCHMARK_END_AND_RECORD();
+        sink = s + c;
+    }
+    BENCHMARK_REPORT(name, "sin+cos");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float s = sine.processSample();
+        float c = (float)::cos(M_2PI * sine.getPhase());
+        BENCHMARK_END_AND_RECORD();
+        sink = s + c;
+    }
+    BENCHMARK_REPORT(name, "SinOsc+cos");
+    (void)sink;
+
+    const int controlRate = 1000;
+    const long long samples = 24LL * 3600 * controlRate;
+    giml::QuadOsc<float> lfo(controlRate);
+    lfo.setFrequency(freqHz);
+    double increment = (double)freqHz / controlRate, maxError = 0.0;
+    for (long long n = 1; n <= samples; n++) {
+        float s = lfo.processSample();
+        if (n % 997 != 0) { continue; }
+        double phase = M_2PI * ::fmod(n * increment, 1.0);
+        maxError = std::max(maxError, std::max(::fabs(s - ::sin(phase)), ::fabs(lfo.getCos() - ::cos(phase))));
+    }
+    std::cout << std::setw(15) << name << " " << std::setw(15) << "24 h error" << ": " << std::setw(8) << maxError << std::endl;
+    report.add(name, "24 h error", maxError, "ratio");
+    if (maxError > 2e-5) {
+        std::cout << std::setw(15) << name << ": drifted " << maxError << " from the exact phase in 24 h" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int benchmarkIntegerPhasor(float freqHz) {
+    std::ostringstream label;
+    label << "Phasor " << freqHz << " Hz";
+    std::string name = label.str();
+    giml::Phasor<float> floatPhase(SAMPLE_RATE);
+    giml::Phasor<float, uint32_t> integerPhase(SAMPLE_RATE);
+    floatPhase.setFrequency(freqHz);
+    integerPhase.setFrequency(freqHz);
+    volatile float sink = 0.f;
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float x = floatPhase.processSample();
+        BENCHMARK_END_AND_RECORD();
+        sink = x;
+    }
+    BENCHMARK_REPORT(name, "float phase");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float x = integerPhase.processSample();
+        BENCHMARK_END_AND_RECORD();
+        sink = x;
+    }
+    BENCHMARK_REPORT(name, "uint32 phase");
+    (void)sink;
+
+    // a uint32 phase gives the same samples however the output is split into blocks
+    int mismatches = 0;
+    giml::Phasor<float, uint32_t> perSample(SAMPLE_RATE), perBlock(SAMPLE_RATE);
+    perSample.setFrequency(-freqHz);
+    perBlock.setFrequency(-freqHz);
+    float block[SIMD_BLOCK_SIZE];
+    for (size_t numSamples : { 1, 3, 16, 37, 64, SIMD_BLOCK_SIZE }) {
+        perBlock.processBlock(block, numSamples);
+        for (size_t i = 0; i < numSamples; i++) {
+            if (perSample.processSample() != block[i]) { mismatches++; }
+        }
+    }
+
+    // 1 h at 48 kHz: the float phase drifts from the phase of its own increment, the uint32 phase stays exact
+    const long long samples = 3600LL * 48000;
+    giml::Phasor<float> floatLfo(48000);
+    giml::Phasor<float, uint32_t> integerLfo(48000);
+    floatLfo.setFrequency(freqHz);
+    integerLfo.setFrequency(freqHz);
+    double floatIncrement = (double)(freqHz / 48000.f);
+    uint32_t integerIncrement = (uint32_t)::llround((double)freqHz / 48000 * 4294967296.0);
+    long long wraps = 0;
+    float last = 0.f;
+    for (long long n = 1; n <= samples; n++) {
+        float x = floatLfo.processSample();
+        float y = integerLfo.processSample();
+        if (x < last) { wraps++; }
+        last = x;
+        if (n % 4801 != 0) { continue; }
+        if (y != (float)(((uint32_t)n * integerIncrement) >> 8) / 16777216.f) { mismatches++; }
+    }
+    double floatDrift = ::fabs(wraps + last - samples * floatIncrement); // in cycles, unwrapped
+    std::cout << std::setw(15) << name << " " << std::setw(15) << "1 h float drift" << ": " << std::setw(8) << floatDrift << " cycles" << std::endl;
+    report.add(name, "1 h float drift", floatDrift, "cycles");
+    if (mismatches > 0) {
+        std::cout << std::setw(15) << name << ": " << mismatches << " uint32 phase sample(s) off the exact phase" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+template <size_t N>
+int benchmarkOscillatorBank() {
+    using Bank = giml::OscillatorBank<float, N>;
+    std::string name = "OscBank " + std::to_string(N);
+    const typename Bank::Shape shapes[3] = { Bank::Shape::Sine, Bank::Shape::Triangle, Bank::Shape::Saw };
+    auto frequency = [](size_t k) { return 0.1f + 0.37f * k; };
+    auto startPhase = [](size_t k) { return k / (float)N; };
+    Bank bank(SAMPLE_RATE);
+    for (size_t k = 0; k < N; k++) {
+        bank.setShape(k, shapes[k % 3]);
+        bank.setFrequency(k, frequency(k));
+        bank.setPhase(k, startPhase(k));
+    }
+    Bank perSample(bank), perTick(bank);
+    std::vector<giml::SinOsc<float>> sines;
+    std::vector<giml::TriOsc<float>> triangles;
+    std::vector<giml::Phasor<float>> saws;
+    for (size_t k = 0; k < N; k++) {
+        float freqHz = frequency(k);
+        if (k % 3 == 0) { sines.emplace_back(SAMPLE_RATE); sines.back().setFrequency(freqHz); }
+        if (k % 3 == 1) { triangles.emplace_back(SAMPLE_RATE); triangles.back().setFrequency(freqHz); }
+        if (k % 3 == 2) { saws.emplace_back(SAMPLE_RATE); saws.back().setFrequency(freqHz); }
+    }
+    volatile float sink = 0.f;
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        const float* out = bank.processSample();
+        BENCHMARK_END_AND_RECORD();
+        sink = out[N - 1];
+    }
+    BENCHMARK_REPORT(name, "bank");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float sum = 0.f;
+        for (auto& o : sines) { sum += o.processSample(); }
+        for (auto& o : triangles) { sum += o.processSample(); }
+        for (auto& o : saws) { sum += o.processSample(); }
+        BENCHMARK_END_AND_RECORD();
+        sink = sum;
+    }
+    BENCHMARK_REPORT(name, "oscillators");
+    (void)sink;
+    std::vector<float> timedFrames(SIMD_BLOCK_SIZE * N);
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS / SIMD_BLOCK_SIZE; i++) {
+        BENCHMARK_START();
+        bank.processBlock(timedFrames.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE;
+    BENCHMARK_REPORT(name, "bank block");
+
+    // each output is bit-identical to its oscillator with a uint32 phase, sample by sample or a control tick at a time
+    int mismatches = 0;
+    std::vector<float> frames(SIMD_BLOCK_SIZE * N), reference(SIMD_BLOCK_SIZE);
+    perSample.processBlock(frames.data(), SIMD_BLOCK_SIZE);
+    for (size_t k = 0; k < N; k++) {
+        float freqHz = frequency(k);
+        if (k % 3 == 0) {
+            giml::SinOsc<float, uint32_t> osc(SAMPLE_RATE);
+            osc.setFrequency(freqHz);
+            osc.setPhase(startPhase(k));
+            osc.processBlock(reference.data(), SIMD_BLOCK_SIZE);
+        }
+        else if (k % 3 == 1) {
+            giml::TriOsc<float, uint32_t> osc(SAMPLE_RATE);
+            osc.setFrequency(freqHz);
+            osc.setPhase(startPhase(k));
+            osc.processBlock(reference.data(), SIMD_BLOCK_SIZE);
+        }
+        else {
+            giml::Phasor<float, uint32_t> osc(SAMPLE_RATE);
+            osc.setFrequency(freqHz);
+            osc.setPhase(startPhase(k));
+            osc.processBlock(reference.data(), SIMD_BLOCK_SIZE);
+        }
+        for (int i = 0; i < SIMD_BLOCK_SIZE; i++) {
+            if (frames[i * N + k] != reference[i]) { mismatches++; }
+        }
+    }
+    for (int i = giml::detail::lfoBlockSize; i <= SIMD_BLOCK_SIZE; i += giml::detail::lfoBlockSize) {
+        const float* out = perTick.processTick(giml::detail::lfoBlockSize);
+        for (size_t k = 0; k < N; k++) {
+            if (out[k] != frames[(i - 1) * N + k]) { mismatches++; }
+        }
+    }
+    if (mismatches > 0) {
+        std::cout << std::setw(15) << name << ": " << mismatches << " sample(s) differ from the single oscillators" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Tremolo, Chorus, Flanger and Phaser modulated by one OscillatorBank instead of their own LFOs, per sample
+void benchmarkBankModulation() {
+    giml::Tremolo<float> tremolo(SAMPLE_RATE);
+    giml::Chorus<float> chorus(SAMPLE_RATE);
+    giml::Flanger<float> flanger(SAMPLE_RATE);
+    giml::Phaser<float> phaser(SAMPLE_RATE);
+    tremolo.enable();
+    chorus.enable();
+    flanger.enable();
+    phaser.enable();
+    giml::OscillatorBank<float, 4> lfos(SAMPLE_RATE);
+    using Shape = giml::OscillatorBank<float, 4>::Shape;
+    lfos.setFrequency(0, 1000.f / 1000.f); // Tremolo's default speed, 1000 ms
+    lfos.setFrequency(1, 0.2f);
+    lfos.setFrequency(2, 0.2f);
+    lfos.setFrequency(3, 0.5f);
+    for (size_t k = 1; k < 4; k++) { lfos.setShape(k, Shape::Triangle); }
+
+    std::vector<float> block(SIMD_BLOCK_SIZE), frames(SIMD_BLOCK_SIZE * 4);
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS / SIMD_BLOCK_SIZE; i++) {
+        std::fill(block.begin(), block.end(), TEST_INPUT);
+        BENCHMARK_START();
+        tremolo.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        chorus.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        flanger.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        phaser.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE;
+    BENCHMARK_REPORT("Modulation", "own LFOs");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS / SIMD_BLOCK_SIZE; i++) {
+        std::fill(block.begin(), block.end(), TEST_INPUT);
+        BENCHMARK_START();
+        lfos.processBlock(frames.data(), SIMD_BLOCK_SIZE);
+        tremolo.processBlock(block.data(), SIMD_BLOCK_SIZE, frames.data() + 0, 4);
+        chorus.processBlock(block.data(), SIMD_BLOCK_SIZE, frames.data() + 1, 4);
+        flanger.processBlock(block.data(), SIMD_BLOCK_SIZE, frames.data() + 2, 4);
+        phaser.processBlock(block.data(), SIMD_BLOCK_SIZE, frames.data() + 3, 4);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE;
+    BENCHMARK_REPORT("Modulation", "OscillatorBank");
+}
+
+// Level of the strongest alias in `x` (the fold-back of harmonics 1 to 40 above Nyquist), in dB below the fundamental
+double aliasLevel(const std::vector<float>& x, double freqHz) {
+    auto magnitude = [&x](double f) { // Goertzel, Hann window
+        double coeff = 2 * ::cos(M_2PI * f / SAMPLE_RATE), s1 = 0.0, s2 = 0.0;
+        for (size_t i = 0; i < x.size(); i++) {
+            double w = 0.5 - 0.5 * ::cos(M_2PI * i / x.size());
+            double s0 = w * x[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        return ::sqrt(s1 * s1 + s2 * s2 - coeff * s1 * s2);
+    };
+    double fundamental = magnitude(freqHz), worst = 0.0;
+    for (int h = (int)(SAMPLE_RATE / 2 / freqHz) + 1, end = h + 40; h < end; h++) {
+        double alias = ::fabs(h * freqHz - ::round(h * freqHz / SAMPLE_RATE) * SAMPLE_RATE);
+        double nearestHarmonic = ::fabs(alias - ::round(alias / freqHz) * freqHz);
+        if (alias < 20.0 || nearestHarmonic < 20.0) { continue; } // on top of a harmonic or DC
+        worst = std::max(worst, magnitude(alias));
+    }
+    return 20 * ::log10(std::max(worst, 1e-12) / fundamental);
+}
+
+int benchmarkWavetableOsc(const std::string& shapeName, giml::WavetableOsc<float>::Shape shape, float freqHz) {
+    std::ostringstream label;
+    label << shapeName << " " << freqHz << " Hz";
+    std::string name = label.str();
+    giml::WavetableOsc<float> osc(SAMPLE_RATE, shape);
+    giml::Phasor<float> phasor(SAMPLE_RATE);
+    giml::TriOsc<float> triangle(SAMPLE_RATE);
+    osc.setFrequency(freqHz);
+    phasor.setFrequency(freqHz);
+    triangle.setFrequency(freqHz);
+    auto naive = [&]() { // the aliasing waveform, from the oscillators that exist without tables
+        if (shape == giml::WavetableOsc<float>::Shape::Triangle) { return triangle.processSample(); }
+        float ph = phasor.processSample();
+        return (shape == giml::WavetableOsc<float>::Shape::Saw) ? 2 * ph - 1 : (ph < 0.5f ? 1.f : -1.f);
+    };
+    volatile float sink = 0.f;
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float x = osc.processSample();
+        BENCHMARK_END_AND_RECORD();
+        sink = x;
+    }
+    BENCHMARK_REPORT(name, "processSample");
+    std::vector<float> block(SIMD_BLOCK_SIZE);
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS / SIMD_BLOCK_SIZE; i++) {
+        BENCHMARK_START();
+        osc.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE;
+    BENCHMARK_REPORT(name, "processBlock");
+    BENCHMARK_RESET();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        BENCHMARK_START();
+        float x = naive();
+        BENCHMARK_END_AND_RECORD();
+        sink = x;
+    }
+    BENCHMARK_REPORT(name, "naive");
+    (void)sink;
+
+    // one second of each, the aliases measured against the fundamental
+    std::vector<float> tables(SAMPLE_RATE), aliasing(SAMPLE_RATE);
+    osc.processBlock(tables.data(), tables.size());
+    for (float& x : aliasing) { x = naive(); }
+    double tablesdB = aliasLevel(tables, freqHz), naivedB = aliasLevel(aliasing, freqHz);
+    std::cout << std::setw(15) << name << " " << std::setw(15) << "aliases" << ": " << std::setw(8) << std::fixed << std::setprecision(1)
+              << tablesdB << " dB (naive " << naivedB << " dB)" << std::defaultfloat << std::endl;
+    report.add(name, "aliases", tablesdB, "dB");
+    if (tablesdB > -80.0) {
+        std::cout << std::setw(15) << name << ": aliases at " << tablesdB << " dB" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef GIML_LOAD_METER
+/**
+ * Load meter check: a Biquad -> Delay -> Reverb `EffectsLine` processed block by block,
+ * then its meters read back as a UI thread would. Returns the number of meters that never recorded a block
+ */
+int benchmarkLoadMeter() {
+    giml::Biquad<float> biquad(SAMPLE_RATE);
+    biquad.setType(giml::Biquad<float>::BiquadUseCase::LPF_2nd);
+    biquad.setParams(1000.f, 0.707f, 0.f);
+    giml::Delay<float> delay(SAMPLE_RATE);
+    delay.setParams(250.f, 0.5f, 0.5f, 0.5f);
+    giml::Reverb<float> reverb(SAMPLE_RATE);
+    reverb.setParams(0.03f, 0.8f, 0.5f, 0.5f, 10.f, 0.75f);
+    giml::EffectsLine<float> chain;
+    chain.pushBack(&biquad);
+    chain.pushBack(&delay);
+    chain.pushBack(&reverb);
+    chain.prepare(SAMPLE_RATE, SIMD_BLOCK_SIZE);
+    for (giml::Effect<float>* e : chain) { e->enable(); }
+
+    std::vector<float> block(SIMD_BLOCK_SIZE);
+    BENCHMARK_RESET();
+    for (int b = 0; b < SIMD_ITERATIONS / 10; b++) {
+        for (int i = 0; i < SIMD_BLOCK_SIZE; i++) { block[i] = ::sinf(0.013f * (b * SIMD_BLOCK_SIZE + i)); }
+        BENCHMARK_START();
+        chain.processBlock(block.data(), SIMD_BLOCK_SIZE);
+        BENCHMARK_END_AND_RECORD();
+    }
+    iterations *= SIMD_BLOCK_SIZE; // per sample
+    BENCHMARK_REPORT("EffectsLine", "processBlock");
+
+    int failures = 0;
+    auto check = [&](const std::string& name, const giml::LoadMeter& meter) {
+        std::cout << std::setw(15) << name << " " << std::setw(15) << "load" << ": " << std::setw(8) << std::fixed << std::setprecision(3)
+                  << meter.getAverageNanosPerSample() << " ns/sample avg, " << meter.getPeakNanosPerSample() << " peak ("
+                  << std::setprecision(2) << meter.getLoad(SAMPLE_RATE) * 100.f << "% of real time)" << std::defaultfloat << std::endl;
+        report.add(name, "load meter", meter.getAverageNanosPerSample(), "ns");
+        if (!(meter.getAverageNanosPerSample() > 0.f) || !(meter.getPeakNanosPerSample() > 0.f) || !(meter.getLastNanosPerSample() > 0.f)) {
+            std::cout << std::setw(15) << name << ": load meter never recorded a block" << std::endl;
+            failures++;
+        }
+    };
+    check("Biquad stage", chain.getStageMeter(0));
+    check("Delay stage", chain.getStageMeter(1));
+    check("Reverb stage", chain.getStageMeter(2));
+    check("EffectsLine", chain.getTotalMeter());
+    if (chain.getStageMeter(GIML_LOAD_METER_MAX_STAGES).getAverageNanosPerSample() != 0.f) {
+        std::cout << std::setw(15) << "EffectsLine" << ": an unmetered stage reads another stage's load" << std::endl;
+        failures++;
+    }
+    return failures;
+}
+#endif
+
+#ifdef GIML_TRACE
+static void skipJSONSpace(const std::string& s, size_t& i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\n' || s[i] == '\r' || s[i] == '\t')) { i++; }
+}
+
+/**
+ * Minimal JSON syntax check of the value starting at `s[i]` (objects, arrays, strings, numbers and literals),
+ * enough to tell whether a trace would load in chrome://tracing or Perfetto. Advances `i` past the value
+ */
+static bool parseJSONValue(const std::string& s, size_t& i) {
+    skipJSONSpace(s, i);
+    if (i >= s.size()) { return false; }
+    char c = s[i];
+    if (c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+        i++;
+        skipJSONSpace(s, i);
+        if (i < s.size() && s[i] == close) { i++; return true; }
+        for (;;) {
+            if (c == '{') { // key
+                skipJSONSpace(s, i);
+                if (i >= s.size() || s[i] != '"' || !parseJSONValue(s, i)) { return false; }
+                skipJSONSpace(s, i);
+                if (i >= s.size() || s[i++] != ':') { return false; }
+            }
+            if (!parseJSONValue(s, i)) { return false; }
+            skipJSONSpace(s, i);
+            if (i >= s.size()) { return false; }
+            if (s[i] == close) { i++; return true; }
+            if (s[i++] != ',') { return false; }
+        }
+    }
+    if (c == '"') {
+        for (i++; i < s.size(); i++) {
+            if (s[i] == '\\') { i++; }
+            else if (s[i] == '"') { i++; return true; }
+            else if ((unsigned char)s[i] < 0x20) { return false; }
+        }
+        return false;
+    }
+    for (const char* literal : { "true", "false", "null" }) {
+        size_t length = strlen(literal);
+        if (!s.compare(i, length, literal)) { i += length; return true; }
+    }
+    if (c != '-' && (c < '0' || c > '9')) { return false; }
+    const char* begin = s.c_str() + i;
+    char* end = nullptr;
+    strtod(begin, &end);
+    i += end - begin;
+    return true;
+}
+
+/**
+ * Trace check: clears the trace ring, sets up and runs a Biquad -> Delay -> Reverb `EffectsLine`,
+ * writes the ring with `giml::trace::writeChromeJSON()` and reads it back.
+ * Returns 1 if the file does not parse, holds a different number of events, or misses one of the expected scopes
+ */
+int benchmarkTrace(const char* tracePath) {
+    const int numBlocks = 16;
+    giml::trace::clear();
+    giml::Biquad<float> biquad(SAMPLE_RATE);
+    biquad.setType(giml::Biquad<float>::BiquadUseCase::LPF_2nd);
+    biquad.setParams(1000.f, 0.707f, 0.f);
+    giml::Delay<float> delay(SAMPLE_RATE);
+    delay.setParams(250.f, 0.5f, 0.5f, 0.5f);
+    giml::Reverb<float> reverb(SAMPLE_RATE);
+    reverb.setParams(0.03f, 0.8f, 0.5f, 0.5f, 10.f, 0.75f);
+    giml::EffectsLine<float> chain;
+    chain.pushBack(&biquad);
+    chain.pushBack(&delay);
+    chain.pushBack(&reverb);
+    chain.prepare(SAMPLE_RATE, SIMD_BLOCK_SIZE);
+    for (giml::Effect<float>* e : chain) { e->enable(); }
+    std::vector<float> block(SIMD_BLOCK_SIZE);
+    for (int b = 0; b < numBlocks; b++) {
+        for (int i = 0; i < SIMD_BLOCK_SIZE; i++) { block[i] = ::sinf(0.013f * (b * SIMD_BLOCK_SIZE + i)); }
+        chain.processBlock(block.data(), SIMD_BLOCK_SIZE);
+    }
+    uint64_t recorded = std::min<uint64_t>(giml::trace::eventCount.load(), GIML_TRACE_CAPACITY);
+
+    if (!giml::trace::writeChromeJSON(tracePath)) {
+        std::cout << std::setw(15) << "Trace" << ": could not write " << tracePath << std::endl;
+        return 1;
+    }
+    std::ifstream file(tracePath);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+    size_t end = 0;
+    bool parsed = parseJSONValue(json, end);
+    skipJSONSpace(json, end);
+    if (!parsed || end != json.size()) {
+        std::cout << std::setw(15) << "Trace" << ": " << tracePath << " is not valid JSON (at byte " << end << ")" << std::endl;
+        return 1;
+    }
+    auto count = [&](const std::string& needle) {
+        size_t n = 0;
+        for (size_t at = json.find(needle); at != std::string::npos; at = json.find(needle, at + 1)) { n++; }
+        return n;
+    };
+    size_t events = count("\"ph\": \"X\"");
+    std::cout << std::setw(15) << "Trace" << " " << std::setw(15) << "events" << ": " << std::setw(8) << events
+              << " written to " << tracePath << " (" << json.size() << " bytes)" << std::endl;
+    report.add("Trace", "events", (double)events, "count");
+    int failures = 0;
+    if (events != recorded) {
+        std::cout << std::setw(15) << "Trace" << ": " << events << " events written, " << recorded << " recorded" << std::endl;
+        failures++;
+    }
+    // name, and the number of events expected with it
+    const std::pair<const char*, size_t> expected[] = {
+        { "Biquad::setParams", 1 }, { "Delay::setParams", 1 }, { "Reverb::setParams", 1 }, { "Reverb::prepare", 1 },
+        { "EffectsLine::processBlock", numBlocks }, { "EffectsLine::stage", 3 * numBlocks }, { "Effect::processBlock", 3 * numBlocks }
+    };
+    for (const auto& e : expected) {
+        size_t n = count(std::string("\"name\": \"") + e.first + "\"");
+        if (n < e.second) {
+            std::cout << std::setw(15) << "Trace" << ": " << n << " " << e.first << " event(s), expected " << e.second << std::endl;
+            failures++;
+        }
+    }
+    if (count("\"args\": {\"index\": 2}") < (size_t)numBlocks) { // the Reverb stage
+        std::cout << std::setw(15) << "Trace" << ": EffectsLine::stage events lack their index" << std::endl;
+        failures++;
+    }
+    return failures > 0 ? 1 : 0;
 }
+#endif
+
+int main(int argc, char** argv) {
+    // Command line options for the machine-readable report
+    const char* reportPath = "micro_benchmark_report.jsonl";
+    const char* baselinePath = nullptr;
+    double timeTolerance = 0.25, memoryTolerance = 0.0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--report") && i + 1 < argc) { reportPath = argv[++i]; }
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc) { baselinePath = argv[++i]; }
+        else if (!strcmp(argv[i], "--time-tolerance") && i + 1 < argc) { timeTolerance = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--memory-tolerance") && i + 1 < argc) { memoryTolerance = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--perf")) { perfEnabled = true; }
+        else {
+            std::cout << "Usage: " << argv[0] << " [--report out.jsonl] [--baseline previous.jsonl]"
+                      << " [--time-tolerance 0.25] [--memory-tolerance 0.0] [--perf]" << std::endl;
+            return 1;
+        }
+    }
 
-int main() {
     std::cout << "GIMMEL EFFECTS MICRO-BENCHMARK" << std::endl;
     std::cout << "==============================" << std::endl;
     std::cout << "Sample Rate: " << SAMPLE_RATE << " Hz" << std::endl;
     std::cout << "Test Iterations: " << TEST_ITERATIONS << std::endl;
     std::cout << "Test Input: " << TEST_INPUT << std::endl;
+    if (perfEnabled) {
+        if (perf.open()) {
+            std::cout << "Hardware Counters:";
+            for (int c = 0; c < PerfCounters::NUM_COUNTERS; c++) {
+                if (perf.available(c)) { std::cout << " " << PerfCounters::name(c); }
+            }
+            std::cout << std::endl;
+        } else {
+            std::cout << "Hardware Counters: unavailable (check /proc/sys/kernel/perf_event_paranoid), skipping" << std::endl;
+            perfEnabled = false;
+        }
+    }
     
     // Test ALL effects in alphabetical order
     
@@ -190,6 +1269,40 @@ int main() {
         BENCHMARK_REPORT("Reverb", "setParams");
         benchmarkEffect("Reverb", effect, TEST_INPUT);
     }
+    for (int tankDecimation : { 2, 4 }) { // combs and after-APFs at half and quarter rate
+        std::string name = (tankDecimation == 2) ? "HalfRateReverb" : "QuarterRateReverb";
+        auto effect = std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2, tankDecimation);
+        effect->setParams(0.030f, 0.6f, 0.75f, 0.5f, 1000.f, 0.75f, giml::Reverb<float>::RoomType::CUBE);
+        benchmarkEffect(name, effect, TEST_INPUT);
+    }
+    { // one tank for both channels, per stereo frame
+        auto effect = std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2, 1, true);
+        effect->setParams(0.030f, 0.6f, 0.75f, 0.5f, 1000.f, 0.75f, giml::Reverb<float>::RoomType::CUBE);
+        effect->enable();
+        BENCHMARK_RESET();
+        for (int i = 0; i < TEST_ITERATIONS; i++) {
+            float left, right;
+            BENCHMARK_START();
+            effect->processSample(TEST_INPUT, -TEST_INPUT, left, right);
+            BENCHMARK_END_AND_RECORD();
+            volatile float output = left + right;
+            (void)output;
+        }
+        BENCHMARK_REPORT("StereoReverb", "processSample");
+    }
+
+    std::cout << "\n=== STATIC REVERB ===" << std::endl;
+    {
+        auto effect = std::make_unique<giml::StaticReverb<float, 4, 20, 4, 2>>(SAMPLE_RATE); // same topology as Reverb
+        BENCHMARK_RESET();
+        for (int i = 0; i < 1000; i++) {
+            BENCHMARK_START();
+            effect->setParams(0.030f, 0.6f, 0.75f, 0.5f, 1000.f, 0.75f, giml::StaticReverb<float>::RoomType::CUBE);
+            BENCHMARK_END_AND_RECORD();
+        }
+        BENCHMARK_REPORT("StaticReverb", "setParams");
+        benchmarkEffect("StaticReverb", effect, TEST_INPUT);
+    }
     
     std::cout << "\n=== SATURATION ===" << std::endl;
     {
@@ -211,10 +1324,155 @@ int main() {
         benchmarkEffect("Tremolo", effect, TEST_INPUT);
     }
     
+    std::cout << "\n=== LIFECYCLE ===" << std::endl;
+    benchmarkLifecycle<giml::Biquad<float>>("Biquad", [] {
+        auto biquad = std::make_unique<giml::Biquad<float>>(SAMPLE_RATE);
+        biquad->setType(giml::Biquad<float>::BiquadUseCase::LPF_2nd); // the default pass-through prints on every sample
+        biquad->setParams(1000.0f, 0.707f, 0.0f);
+        return biquad;
+    });
+    benchmarkLifecycle<giml::Chorus<float>>("Chorus", [] { return std::make_unique<giml::Chorus<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Compressor<float>>("Compressor", [] { return std::make_unique<giml::Compressor<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Delay<float>>("Delay", [] { return std::make_unique<giml::Delay<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Detune<float>>("Detune", [] { return std::make_unique<giml::Detune<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::EarlyReflections<float>>("EarlyReflections", [] { return std::make_unique<giml::EarlyReflections<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::EnvelopeFilter<float>>("EnvelopeFilter", [] { return std::make_unique<giml::EnvelopeFilter<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Expander<float>>("Expander", [] { return std::make_unique<giml::Expander<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Flanger<float>>("Flanger", [] { return std::make_unique<giml::Flanger<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Reverb<float>>("HalfRateReverb", [] { return std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2, 2); });
+    benchmarkLifecycle<giml::Phaser<float>>("Phaser", [] { return std::make_unique<giml::Phaser<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Reverb<float>>("QuarterRateReverb", [] { return std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2, 4); });
+    benchmarkLifecycle<giml::Reverb<float>>("Reverb", [] { return std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2); });
+    benchmarkLifecycle<giml::Saturation<float>>("Saturation", [] { return std::make_unique<giml::Saturation<float>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Delay<float, float, 144000>>("StaticDelay", [] { return std::make_unique<giml::Delay<float, float, 144000>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::StaticReverb<float, 4, 20, 4, 2>>("StaticReverb", [] { return std::make_unique<giml::StaticReverb<float, 4, 20, 4, 2>>(SAMPLE_RATE); });
+    benchmarkLifecycle<giml::Reverb<float>>("StereoReverb", [] { return std::make_unique<giml::Reverb<float>>(SAMPLE_RATE, 4, 20, 4, 2, 1, true); });
+    benchmarkLifecycle<giml::Tremolo<float>>("Tremolo", [] { return std::make_unique<giml::Tremolo<float>>(SAMPLE_RATE); });
+
+    std::cout << "\n=== SIMD KERNELS (" << SIMD_BLOCK_SIZE << " samples) ===" << std::endl;
+    int simdMismatches = benchmarkSimdKernels();
+
+    std::cout << "\n=== SIMD LANES (4 channels) ===" << std::endl;
+    simdMismatches += benchmarkLanes<giml::Biquad>("Biquad", [](auto& e) {
+        e.setType(std::remove_reference_t<decltype(e)>::BiquadUseCase::LPF_2nd);
+        e.setParams(1000.f, 0.7f, 0.f);
+    });
+    simdMismatches += benchmarkLanes<giml::Chorus>("Chorus", [](auto& e) { e.setParams(); });
+    simdMismatches += benchmarkLanes<giml::Compressor>("Compressor", [](auto& e) { e.setParams(-20.f, 4.f, 3.f, 6.f, 2.f, 80.f); });
+    simdMismatches += benchmarkLanes<giml::Delay>("Delay", [](auto& e) { e.setParams(123.4f, 0.5f, 0.5f, 0.4f); });
+    simdMismatches += benchmarkLanes<giml::Detune>("Detune", [](auto& e) { e.setParams(0.7f); });
+    simdMismatches += benchmarkLanes<giml::Expander>("Expander", [](auto& e) { e.setParams(-20.f, 4.f, 3.f, 2.f, 80.f); });
+    simdMismatches += benchmarkLanes<giml::Flanger>("Flanger", [](auto& e) { e.setParams(); });
+    simdMismatches += benchmarkLanes<giml::Tremolo>("Tremolo", [](auto& e) { e.setParams(); });
+
+    std::cout << "\n=== FIXED POINT (q31 / q15 vs float) ===" << std::endl;
+    int fixedMismatches = 0;
+    auto lpf = [](auto& e) {
+        e.setType(std::remove_reference_t<decltype(e)>::BiquadUseCase::LPF_2nd);
+        e.setParams(1000.f, 0.7f, 0.f);
+    };
+    auto compressor = [](auto& e) { e.setParams(-20.f, 4.f, 3.f, 6.f, 2.f, 80.f); };
+    auto delay = [](auto& e) { e.setParams(123.4f, 0.5f, 0.5f, 0.4f); };
+    auto tremolo = [](auto& e) { e.setParams(300.f, 0.3f); };
+    fixedMismatches += benchmarkFixed<giml::Biquad, giml::q31>("Biquad", "q31", FIXED_Q31_TOLERANCE, lpf);
+    fixedMismatches += benchmarkFixed<giml::Biquad, giml::q15>("Biquad", "q15", FIXED_Q15_TOLERANCE, lpf);
+    fixedMismatches += benchmarkFixed<giml::Compressor, giml::q31>("Compressor", "q31", FIXED_Q31_TOLERANCE, compressor);
+    fixedMismatches += benchmarkFixed<giml::Compressor, giml::q15>("Compressor", "q15", FIXED_Q15_TOLERANCE, compressor);
+    fixedMismatches += benchmarkFixed<giml::Delay, giml::q31>("Delay", "q31", FIXED_Q31_TOLERANCE, delay); // OnePole damping and DC block
+    fixedMismatches += benchmarkFixed<giml::Delay, giml::q15>("Delay", "q15", FIXED_Q15_TOLERANCE, delay);
+    auto onePoleLowpass = [](auto& e) { e.filter.setCutoff(200.f, (float)SAMPLE_RATE); };
+    auto onePoleDCBlock = [](auto& e) { e.filter.setCutoff(3.f, (float)SAMPLE_RATE); e.highpass = true; }; // Delay's DC blocker
+    fixedMismatches += benchmarkFixed<OnePoleEffect, giml::q31>("OnePole LPF", "q31", FIXED_Q31_TOLERANCE, onePoleLowpass);
+    fixedMismatches += benchmarkFixed<OnePoleEffect, giml::q15>("OnePole LPF", "q15", FIXED_Q15_TOLERANCE, onePoleLowpass);
+    fixedMismatches += benchmarkFixed<OnePoleEffect, giml::q31>("OnePole DC", "q31", FIXED_Q31_TOLERANCE, onePoleDCBlock);
+    fixedMismatches += benchmarkFixed<OnePoleEffect, giml::q15>("OnePole DC", "q15", FIXED_Q15_TOLERANCE, onePoleDCBlock);
+    fixedMismatches += benchmarkFixed<giml::Tremolo, giml::q31>("Tremolo", "q31", FIXED_Q31_TOLERANCE, tremolo);
+    fixedMismatches += benchmarkFixed<giml::Tremolo, giml::q15>("Tremolo", "q15", FIXED_Q15_TOLERANCE, tremolo);
+
+    std::cout << "\n=== DELAY-LINE STORAGE (vs float storage) ===" << std::endl;
+    int storageMismatches = 0;
+    auto reverb = [](auto& e) { e.setParams(0.03f, 0.8f, 0.5f, 0.5f, 10.f, 0.75f); };
+    storageMismatches += benchmarkStorage<giml::Delay, float>("Delay", "float", -200.0, delay, SAMPLE_RATE, 3000.f);
+    storageMismatches += benchmarkStorage<giml::Delay, int16_t>("Delay", "int16", -95.0, delay, SAMPLE_RATE, 3000.f);
+    storageMismatches += benchmarkStorage<giml::Delay, giml::half>("Delay", "half", -95.0, delay, SAMPLE_RATE, 3000.f);
+    storageMismatches += benchmarkStorage<giml::Delay, giml::bfloat16>("Delay", "bfloat16", -80.0, delay, SAMPLE_RATE, 3000.f);
+    storageMismatches += benchmarkStorage<giml::Reverb, float>("Reverb", "float", -200.0, reverb, SAMPLE_RATE);
+    storageMismatches += benchmarkStorage<giml::Reverb, int16_t>("Reverb", "int16", -95.0, reverb, SAMPLE_RATE);
+    storageMismatches += benchmarkStorage<giml::Reverb, giml::half>("Reverb", "half", -95.0, reverb, SAMPLE_RATE);
+    storageMismatches += benchmarkStorage<giml::Reverb, giml::bfloat16>("Reverb", "bfloat16", -80.0, reverb, SAMPLE_RATE);
+
+    std::cout << "\n=== EARLY REFLECTIONS (per sample, vs a Delay per tap) ===" << std::endl;
+    int earlyReflectionsMismatches = 0;
+    for (int numTaps : { 4, 8, 16, 32 }) { earlyReflectionsMismatches += benchmarkEarlyReflections(numTaps); }
+
+    std::cout << "\n=== QUADRATURE OSCILLATOR (24 h at 1 kHz) ===" << std::endl;
+    int quadMismatches = 0;
+    for (float freqHz : { 0.1f, 1.f, 7.f, 440.f }) { quadMismatches += benchmarkQuadOsc(freqHz); }
+
+    std::cout << "\n=== INTEGER PHASE ACCUMULATOR (1 h at 48 kHz) ===" << std::endl;
+    int phaseMismatches = 0;
+    for (float freqHz : { 1.f, 7.f, 440.f }) { phaseMismatches += benchmarkIntegerPhasor(freqHz); }
+
+    std::cout << "\n=== OSCILLATOR BANK (per frame of N LFOs, vs N oscillators) ===" << std::endl;
+    int bankMismatches = 0;
+    bankMismatches += benchmarkOscillatorBank<4>();
+    bankMismatches += benchmarkOscillatorBank<8>();
+    bankMismatches += benchmarkOscillatorBank<32>();
+    benchmarkBankModulation();
+
+    std::cout << "\n=== WAVETABLE OSCILLATOR (band-limited, vs naive) ===" << std::endl;
+    int wavetableMismatches = 0;
+    for (float freqHz : { 110.f, 1318.5f, 5274.f }) {
+        wavetableMismatches += benchmarkWavetableOsc("Saw", giml::WavetableOsc<float>::Shape::Saw, freqHz);
+        wavetableMismatches += benchmarkWavetableOsc("Square", giml::WavetableOsc<float>::Shape::Square, freqHz);
+        wavetableMismatches += benchmarkWavetableOsc("Triangle", giml::WavetableOsc<float>::Shape::Triangle, freqHz);
+    }
+
+#ifdef GIML_LOAD_METER
+    std::cout << "\n=== LOAD METER (EffectsLine, GIML_LOAD_METER) ===" << std::endl;
+    int loadMeterFailures = benchmarkLoadMeter();
+#endif
+
+#ifdef GIML_TRACE
+    std::cout << "\n=== TRACE (EffectsLine, GIML_TRACE) ===" << std::endl;
+    int traceFailures = benchmarkTrace("micro_benchmark_trace.json");
+#endif
+
     std::cout << "\n=== SUMMARY ===" << std::endl;
-    std::cout << "All " << 12 << " effects tested successfully!" << std::endl;
+    // Every check is tallied before the verdict, so that a failing run never reports success
+    int failures = 0;
+    auto tally = [&](int count, const char* what) {
+        if (count > 0) { std::cout << count << " " << what << std::endl; }
+        failures += count;
+    };
+    tally(simdMismatches, "SIMD kernel table(s) or lane effect(s) disagree with scalar");
+    tally(fixedMismatches, "fixed-point effect(s) outside their tolerance");
+    tally(storageMismatches, "delay-line storage format(s) above their noise limit");
+    tally(earlyReflectionsMismatches, "early reflections tap set(s) disagree between processBlock and processSample");
+    tally(quadMismatches, "quadrature oscillator(s) drifted");
+    tally(phaseMismatches, "integer phasor(s) off the exact phase");
+    tally(bankMismatches, "oscillator bank(s) disagree with single oscillators");
+    tally(wavetableMismatches, "wavetable oscillator(s) alias");
+#ifdef GIML_LOAD_METER
+    tally(loadMeterFailures, "load meter(s) read back wrong");
+#endif
+#ifdef GIML_TRACE
+    tally(traceFailures, "Chrome trace JSON file(s) invalid or incomplete");
+#endif
+    if (baselinePath) {
+        BenchmarkReport baseline;
+        if (!baseline.read(baselinePath)) { return 1; }
+        int regressions = report.compare(baseline, timeTolerance, memoryTolerance);
+        std::cout << regressions << " regression(s) against " << baselinePath << std::endl;
+        failures += regressions;
+    }
+
+    if (failures == 0) { std::cout << "All " << 13 << " effects tested successfully!" << std::endl; }
+    else { std::cout << failures << " check(s) failed" << std::endl; }
     std::cout << "Results show average time per operation in nanoseconds." << std::endl;
     std::cout << "Lower values indicate better performance." << std::endl;
-    
-    return 0;
+
+    if (!report.write(reportPath)) { return 1; }
+    std::cout << "Report written to " << reportPath << std::endl;
+    return (failures > 0) ? 1 : 0;
 }
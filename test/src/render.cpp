@@ -0,0 +1,338 @@
+// gimmel-render: offline batch renderer.
+// Renders a list of WAV files through a chain described on the command line (see chain.h),
+// spreading the files across a pool of worker threads.
+// With `--split`, each file is instead cut into chunks rendered in parallel by fresh chains,
+// each pre-rolled over a warm-up overlap derived from the chain's tail length
+
+#include "wav.h"
+#include "chain.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct RenderConfig {
+    ChainSpec chain;
+    std::vector<std::string> inputs;
+    std::string outDir; // empty = next to the input
+    std::string suffix = "_render";
+    unsigned int threads = 0; // 0 = hardware concurrency
+    size_t blockSize = 512;
+    WAVBlockWriter::Format format = WAVBlockWriter::Format::INT24;
+    bool dither = false;
+    double splitSeconds = 0.0; // > 0: render each file in chunks of this length, in parallel
+    double warmupScale = 1.0; // warm-up overlap as a multiple of the chain's tail
+    bool verify = false; // compare the chunked render against a serial one
+};
+
+// Totals across all workers
+struct RenderTotals {
+    std::atomic<unsigned long long> frames{0};
+    std::atomic<unsigned long long> audioNanos{0}; // duration of the rendered audio
+    std::atomic<unsigned long long> processNanos{0}; // time spent in processBlock, summed over workers
+    std::atomic<int> failures{0};
+};
+
+static std::mutex printMutex;
+
+static std::string outputPath(const RenderConfig& config, const std::string& input) {
+    size_t slash = input.find_last_of("/\\");
+    std::string dir = (slash == std::string::npos) ? "" : input.substr(0, slash + 1);
+    std::string name = (slash == std::string::npos) ? input : input.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos) { name = name.substr(0, dot); }
+    if (!config.outDir.empty()) { dir = config.outDir + "/"; }
+    return dir + name + config.suffix + ".wav";
+}
+
+/**
+ * Renders one file. Effects are mono, so each channel gets its own chain instance,
+ * built fresh for the file so no state carries over from the previous one
+ */
+static bool renderFile(const RenderConfig& config, const std::string& input, RenderTotals& totals) {
+    WAVStreamReader reader { input.c_str(), config.blockSize };
+    if (!reader.isOpen()) { return false; }
+    unsigned int channels = reader.getChannels();
+    int sampleRate = (int)reader.getSampleRate();
+
+    std::vector<std::unique_ptr<Chain>> chains;
+    for (unsigned int c = 0; c < channels; c++) {
+        std::string error;
+        chains.push_back(Chain::build(config.chain, sampleRate, error));
+        if (!chains.back()) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << input << ": " << error << std::endl;
+            return false;
+        }
+    }
+
+    std::string output = outputPath(config, input);
+    WAVBlockWriter writer { output.c_str(), sampleRate, channels, config.format, config.dither, config.blockSize * 8 };
+    if (!writer.isOpen()) { return false; }
+
+    std::vector<const float*> planar(channels);
+    unsigned long long frames = 0, processNanos = 0;
+    while (size_t n = reader.readChunk()) {
+        Clock::time_point begin = Clock::now();
+        for (unsigned int c = 0; c < channels; c++) {
+            chains[c]->processBlock(reader.getChannel(c), n);
+            planar[c] = reader.getChannel(c);
+        }
+        processNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+        writer.writePlanar(planar.data(), n);
+        frames += n;
+    }
+
+    unsigned long long audioNanos = frames * 1000000000ULL / sampleRate;
+    totals.frames += frames;
+    totals.audioNanos += audioNanos;
+    totals.processNanos += processNanos;
+
+    std::lock_guard<std::mutex> lock(printMutex);
+    std::cout << input << " -> " << output << ": " << frames << " frames x " << channels << " ch, "
+              << std::fixed << std::setprecision(1) << (processNanos ? (double)audioNanos / processNanos : 0.0)
+              << "x real-time" << std::defaultfloat << std::endl;
+    return true;
+}
+
+/**
+ * Renders frames `[start, start + length)` of `input` into `out` (one vector per channel)
+ * with fresh chains, pre-rolled over the `warmup` frames before `start`
+ */
+static bool renderChunk(const RenderConfig& config, const std::string& input, uint64_t start, uint64_t length,
+                        uint64_t warmup, std::vector<std::vector<float>>& out, unsigned long long& processNanos) {
+    WAVStreamReader reader { input.c_str(), config.blockSize };
+    if (!reader.isOpen()) { return false; }
+    unsigned int channels = reader.getChannels();
+
+    std::vector<std::unique_ptr<Chain>> chains;
+    for (unsigned int c = 0; c < channels; c++) {
+        std::string error;
+        chains.push_back(Chain::build(config.chain, (int)reader.getSampleRate(), error));
+        if (!chains.back()) { return false; }
+    }
+
+    uint64_t pos = (start > warmup) ? start - warmup : 0;
+    uint64_t end = start + length;
+    if (!reader.seek(pos)) { return false; }
+    out.resize(channels);
+    for (unsigned int c = 0; c < channels; c++) { out[c].assign(length, 0.f); }
+
+    while (pos < end) {
+        size_t n = reader.readChunk();
+        if (n == 0) { break; }
+        size_t used = (size_t)std::min<uint64_t>(n, end - pos);
+        Clock::time_point begin = Clock::now();
+        for (unsigned int c = 0; c < channels; c++) { chains[c]->processBlock(reader.getChannel(c), used); }
+        processNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+
+        // Keep the part that falls inside the chunk, the warm-up is discarded
+        uint64_t from = std::max(pos, start);
+        for (unsigned int c = 0; c < channels && from < pos + used; c++) {
+            const float* block = reader.getChannel(c);
+            std::copy(block + (from - pos), block + used, out[c].begin() + (from - start));
+        }
+        pos += n;
+    }
+    return true;
+}
+
+/**
+ * Renders one file in chunks of `config.splitSeconds`, `numThreads` chunks at a time,
+ * and writes them in order. Falls back to `renderFile()` when the chain's tail is unbounded
+ */
+static bool renderFileChunked(const RenderConfig& config, const std::string& input, RenderTotals& totals, unsigned int numThreads) {
+    WAVStreamReader info { input.c_str(), 1 };
+    if (!info.isOpen()) { return false; }
+    unsigned int channels = info.getChannels();
+    int sampleRate = (int)info.getSampleRate();
+    uint64_t totalFrames = info.getTotalFrames();
+
+    std::string error;
+    std::unique_ptr<Chain> probe = Chain::build(config.chain, sampleRate, error);
+    int tail = probe ? probe->getTailSamples() : -1;
+    if (tail < 0) {
+        std::cout << input << ": chain has an unbounded tail, rendering serially" << std::endl;
+        return renderFile(config, input, totals);
+    }
+    uint64_t warmup = (uint64_t)std::ceil(tail * config.warmupScale);
+    uint64_t chunkFrames = std::max<uint64_t>(1, (uint64_t)(config.splitSeconds * sampleRate));
+    uint64_t numChunks = (totalFrames + chunkFrames - 1) / chunkFrames;
+
+    std::string output = outputPath(config, input);
+    WAVBlockWriter writer { output.c_str(), sampleRate, channels, config.format, config.dither, config.blockSize * 8 };
+    if (!writer.isOpen()) { return false; }
+
+    std::vector<std::vector<std::vector<float>>> buffers(numThreads);
+    std::vector<unsigned long long> chunkNanos(numThreads);
+    std::vector<std::vector<float>> stitched(config.verify ? channels : 0);
+    std::vector<const float*> planar(channels);
+    unsigned long long processNanos = 0;
+
+    // One wave of `numThreads` chunks at a time keeps memory bounded and the output in order
+    for (uint64_t first = 0; first < numChunks; first += numThreads) {
+        std::vector<std::thread> workers;
+        std::atomic<bool> ok{true};
+        unsigned int wave = (unsigned int)std::min<uint64_t>(numThreads, numChunks - first);
+        for (unsigned int t = 0; t < wave; t++) {
+            workers.emplace_back([&, t]() {
+                uint64_t start = (first + t) * chunkFrames;
+                uint64_t length = std::min(chunkFrames, totalFrames - start);
+                chunkNanos[t] = 0;
+                if (!renderChunk(config, input, start, length, warmup, buffers[t], chunkNanos[t])) { ok = false; }
+            });
+        }
+        for (std::thread& w : workers) { w.join(); }
+        if (!ok) { return false; }
+
+        for (unsigned int t = 0; t < wave; t++) {
+            size_t length = buffers[t][0].size();
+            for (unsigned int c = 0; c < channels; c++) {
+                planar[c] = buffers[t][c].data();
+                if (config.verify) { stitched[c].insert(stitched[c].end(), buffers[t][c].begin(), buffers[t][c].end()); }
+            }
+            writer.writePlanar(planar.data(), length);
+            processNanos += chunkNanos[t];
+        }
+    }
+
+    unsigned long long audioNanos = totalFrames * 1000000000ULL / sampleRate;
+    totals.frames += totalFrames;
+    totals.audioNanos += audioNanos;
+    totals.processNanos += processNanos;
+
+    std::cout << input << " -> " << output << ": " << numChunks << " chunks of " << chunkFrames
+              << " frames, warm-up " << warmup << " frames (tail " << tail << ")" << std::endl;
+
+    if (config.verify) {
+        std::vector<std::vector<float>> serial;
+        unsigned long long serialNanos = 0;
+        if (!renderChunk(config, input, 0, totalFrames, 0, serial, serialNanos)) { return false; }
+        double maxError = 0.0;
+        for (unsigned int c = 0; c < channels; c++) {
+            for (uint64_t i = 0; i < totalFrames; i++) {
+                maxError = std::max(maxError, (double)std::fabs(stitched[c][i] - serial[c][i]));
+            }
+        }
+        // Past a warm-up of `warmupScale` tails, the state left over from before the chunk has decayed to the threshold that many times
+        double bound = std::pow(GIML_TAIL_THRESHOLD, config.warmupScale);
+        std::cout << "  verify: max error against serial render " << maxError << " ("
+                  << std::fixed << std::setprecision(1) << (maxError > 0.0 ? 20.0 * std::log10(maxError) : -INFINITY)
+                  << " dBFS), bound " << 20.0 * std::log10(bound) << " dBFS" << std::defaultfloat << std::endl;
+        if (maxError > bound) {
+            std::cout << input << ": chunked render exceeds the error bound" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " --chain <description|file> [options] file.wav...\n"
+              << "  --threads N        worker threads (default: number of cores)\n"
+              << "  --block N          samples per processBlock call (default: 512)\n"
+              << "  --out-dir DIR      output directory (default: next to each input)\n"
+              << "  --suffix S         appended to output file names (default: _render)\n"
+              << "  --format F         int16 | int24 | int32 | float (default: int24)\n"
+              << "  --dither           TPDF dither for integer formats\n"
+              << "  --split SECONDS    render each file in chunks of this length in parallel\n"
+              << "  --warmup-scale X   chunk warm-up as a multiple of the chain's tail (default: 1)\n"
+              << "  --verify           with --split, compare with a serial render and fail above the tail threshold\n"
+              << "Chain example: \"compressor thresh=-20 ratio=4 | delay time=300 | reverb time=0.03\"" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    RenderConfig config;
+    bool hasChain = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--chain") && i + 1 < argc) {
+            std::string error;
+            if (!config.chain.parse(argv[++i], error)) {
+                std::cout << "Invalid chain: " << error << std::endl;
+                return 1;
+            }
+            hasChain = true;
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) { config.threads = (unsigned int)atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--block") && i + 1 < argc) { config.blockSize = (size_t)atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--out-dir") && i + 1 < argc) { config.outDir = argv[++i]; }
+        else if (!strcmp(argv[i], "--suffix") && i + 1 < argc) { config.suffix = argv[++i]; }
+        else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+            std::string f = argv[++i];
+            if (f == "int16") { config.format = WAVBlockWriter::Format::INT16; }
+            else if (f == "int24") { config.format = WAVBlockWriter::Format::INT24; }
+            else if (f == "int32") { config.format = WAVBlockWriter::Format::INT32; }
+            else if (f == "float") { config.format = WAVBlockWriter::Format::FLOAT32; }
+            else { printUsage(argv[0]); return 1; }
+        }
+        else if (!strcmp(argv[i], "--dither")) { config.dither = true; }
+        else if (!strcmp(argv[i], "--split") && i + 1 < argc) { config.splitSeconds = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--warmup-scale") && i + 1 < argc) { config.warmupScale = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--verify")) { config.verify = true; }
+        else if (argv[i][0] == '-') { printUsage(argv[0]); return 1; }
+        else { config.inputs.push_back(argv[i]); }
+    }
+    if (!hasChain || config.inputs.empty() || config.blockSize == 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Validate the chain once up front rather than in every worker
+    {
+        std::string error;
+        if (!Chain::build(config.chain, 48000, error)) {
+            std::cout << "Invalid chain: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    unsigned int numThreads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    if (numThreads == 0) { numThreads = 1; }
+    if (config.splitSeconds <= 0.0 && numThreads > config.inputs.size()) { numThreads = (unsigned int)config.inputs.size(); }
+
+    std::cout << "Chain: " << config.chain.toString() << std::endl;
+    std::cout << "Files: " << config.inputs.size() << ", threads: " << numThreads << std::endl;
+
+    RenderTotals totals;
+    std::atomic<size_t> nextFile{0};
+    Clock::time_point begin = Clock::now();
+
+    std::vector<std::thread> workers;
+    if (config.splitSeconds > 0.0) {
+        // Files one after the other, chunks of each file in parallel
+        for (const std::string& input : config.inputs) {
+            if (!renderFileChunked(config, input, totals, numThreads)) { totals.failures++; }
+        }
+    }
+    else for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = nextFile.fetch_add(1)) < config.inputs.size()) {
+                if (!renderFile(config, config.inputs[index], totals)) { totals.failures++; }
+            }
+        });
+    }
+    for (std::thread& w : workers) { w.join(); }
+
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    double audioSeconds = totals.audioNanos * 1e-9;
+    std::cout << "\n=== SUMMARY ===" << std::endl;
+    std::cout << "Rendered: " << (config.inputs.size() - totals.failures) << "/" << config.inputs.size() << " files, "
+              << std::fixed << std::setprecision(2) << audioSeconds << " s of audio in " << wallSeconds << " s" << std::endl;
+    std::cout << "Throughput: " << (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0) << "x real-time (wall clock, incl. I/O)" << std::endl;
+    std::cout << "Processing: " << (totals.processNanos ? (double)totals.audioNanos / totals.processNanos : 0.0)
+              << "x real-time per thread (processBlock only)" << std::defaultfloat << std::endl;
+
+    return totals.failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,402 @@
+// gimmel-sweep: parameter-sweep renderer for dataset generation.
+// Renders one input clip through a base chain (see chain.h) under many parameter settings,
+// taken from a grid or drawn at random, and writes one WAV per setting plus a CSV manifest.
+// Each worker thread allocates its chains once and reuses them for every setting via
+// `Chain::configure()` and `Chain::reset()`
+
+#include "wav.h"
+#include "chain.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+/* One swept parameter, `stage.key=min:max:steps` or `stage.key=a,b,c`.
+   `stage` is an effect type (its first occurrence in the chain) or a 0-based position */
+struct SweepAxis {
+    std::string name; // as given, used as the manifest column
+    size_t stage = 0;
+    std::string key;
+    std::vector<std::string> values; // explicit values, empty for a range
+    double min = 0.0, max = 0.0;
+    int steps = 1;
+
+    /**
+     * @brief Parses an axis and resolves its stage against `chain`
+     * @param error set to a readable message on failure
+     */
+    bool parse(const std::string& text, const ChainSpec& chain, std::string& error) {
+        size_t eq = text.find('=');
+        size_t dot = text.find('.');
+        if (eq == std::string::npos || dot == std::string::npos || dot > eq || dot == 0 || dot + 1 == eq) {
+            error = "expected stage.key=values, got '" + text + "'";
+            return false;
+        }
+        this->name = text.substr(0, eq);
+        this->key = text.substr(dot + 1, eq - dot - 1);
+        std::string stageName = text.substr(0, dot);
+        std::string spec = text.substr(eq + 1);
+
+        char* end = nullptr;
+        long position = strtol(stageName.c_str(), &end, 10);
+        if (*end == '\0') {
+            if (position < 0 || (size_t)position >= chain.effects.size()) {
+                error = "no stage " + stageName + " in the chain";
+                return false;
+            }
+            this->stage = (size_t)position;
+        } else {
+            size_t i = 0;
+            while (i < chain.effects.size() && chain.effects[i].type != stageName) { i++; }
+            if (i == chain.effects.size()) {
+                error = "no " + stageName + " in the chain";
+                return false;
+            }
+            this->stage = i;
+        }
+
+        if (spec.find(',') != std::string::npos || spec.find(':') == std::string::npos) {
+            std::stringstream list(spec);
+            std::string value;
+            while (std::getline(list, value, ',')) {
+                if (!value.empty()) { this->values.push_back(value); }
+            }
+            if (this->values.empty()) {
+                error = "no values for " + this->name;
+                return false;
+            }
+            return true;
+        }
+
+        int parsed = sscanf(spec.c_str(), "%lf:%lf:%d", &this->min, &this->max, &this->steps);
+        if (parsed < 2 || (parsed == 3 && this->steps < 1)) {
+            error = "expected min:max[:steps] for " + this->name + ", got '" + spec + "'";
+            return false;
+        }
+        if (parsed == 2) { this->steps = 2; }
+        return true;
+    }
+
+    // Number of grid points
+    size_t size() const { return this->values.empty() ? (size_t)this->steps : this->values.size(); }
+
+    // Grid point `i`, ranges are sampled linearly including both ends
+    std::string at(size_t i) const {
+        if (!this->values.empty()) { return this->values[i]; }
+        double t = (this->steps > 1) ? (double)i / (this->steps - 1) : 0.0;
+        return format(this->min + (this->max - this->min) * t);
+    }
+
+    // Uniform draw: a value of the list, or anywhere in the range
+    std::string draw(std::mt19937_64& rng) const {
+        if (!this->values.empty()) {
+            return this->values[std::uniform_int_distribution<size_t>(0, this->values.size() - 1)(rng)];
+        }
+        return format(std::uniform_real_distribution<double>(this->min, this->max)(rng));
+    }
+
+    static std::string format(double value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.6g", value);
+        return text;
+    }
+};
+
+struct SweepConfig {
+    ChainSpec chain;
+    std::vector<SweepAxis> axes;
+    std::string input;
+    std::string outDir = ".";
+    std::string manifest; // empty = outDir/manifest.csv
+    size_t randomCount = 0; // > 0: draw this many settings instead of the full grid
+    unsigned long long seed = 1;
+    double tailSeconds = 0.0; // silence appended to the input to let tails ring out
+    unsigned int threads = 0; // 0 = hardware concurrency
+    size_t blockSize = 512;
+    WAVBlockWriter::Format format = WAVBlockWriter::Format::INT24;
+    bool dither = false;
+    bool fresh = false; // build new chains for every setting instead of reusing them
+};
+
+// Values of every axis for each setting, in axis order
+typedef std::vector<std::vector<std::string>> SweepSettings;
+
+static SweepSettings makeSettings(const SweepConfig& config) {
+    SweepSettings settings;
+    if (config.randomCount > 0) {
+        std::mt19937_64 rng(config.seed);
+        for (size_t s = 0; s < config.randomCount; s++) {
+            std::vector<std::string> values;
+            for (const SweepAxis& axis : config.axes) { values.push_back(axis.draw(rng)); }
+            settings.push_back(values);
+        }
+        return settings;
+    }
+    // Cartesian product, the last axis varies fastest
+    size_t total = 1;
+    for (const SweepAxis& axis : config.axes) { total *= axis.size(); }
+    for (size_t s = 0; s < total; s++) {
+        std::vector<std::string> values(config.axes.size());
+        size_t rest = s;
+        for (size_t a = config.axes.size(); a-- > 0;) {
+            values[a] = config.axes[a].at(rest % config.axes[a].size());
+            rest /= config.axes[a].size();
+        }
+        settings.push_back(values);
+    }
+    return settings;
+}
+
+// The base chain with the values of one setting applied
+static ChainSpec applySetting(const SweepConfig& config, const std::vector<std::string>& values) {
+    ChainSpec spec = config.chain;
+    for (size_t a = 0; a < config.axes.size(); a++) {
+        spec.effects[config.axes[a].stage].params[config.axes[a].key] = values[a];
+    }
+    return spec;
+}
+
+static std::string settingPath(const SweepConfig& config, size_t index) {
+    char name[32];
+    snprintf(name, sizeof(name), "%05zu.wav", index);
+    return config.outDir + "/" + name;
+}
+
+static bool loadInput(const std::string& path, size_t blockSize, std::vector<std::vector<float>>& channels, int& sampleRate) {
+    WAVStreamReader reader { path.c_str(), blockSize };
+    if (!reader.isOpen()) { return false; }
+    sampleRate = (int)reader.getSampleRate();
+    channels.assign(reader.getChannels(), std::vector<float>());
+    for (std::vector<float>& c : channels) { c.reserve((size_t)reader.getTotalFrames()); }
+    while (size_t n = reader.readChunk()) {
+        for (size_t c = 0; c < channels.size(); c++) {
+            const float* block = reader.getChannel((unsigned int)c);
+            channels[c].insert(channels[c].end(), block, block + n);
+        }
+    }
+    return true;
+}
+
+// Totals across all workers
+struct SweepTotals {
+    std::atomic<unsigned long long> setupNanos{0}; // building chains
+    std::atomic<unsigned long long> configureNanos{0}; // configure() + reset()
+    std::atomic<unsigned long long> processNanos{0}; // processBlock
+    std::atomic<int> failures{0};
+};
+
+static std::mutex printMutex;
+
+/**
+ * One worker: pulls setting indices from `next` and renders them,
+ * reusing the same chain instances (one per channel) for every setting
+ */
+static void sweepWorker(const SweepConfig& config, const SweepSettings& settings, const std::vector<std::vector<float>>& input,
+                        int sampleRate, std::atomic<size_t>& next, SweepTotals& totals) {
+    const unsigned int channels = (unsigned int)input.size();
+    const size_t frames = input[0].size() + (size_t)(config.tailSeconds * sampleRate);
+    std::vector<std::unique_ptr<Chain>> chains(channels);
+    std::vector<std::vector<float>> work(channels, std::vector<float>(frames));
+    std::vector<const float*> planar(channels);
+
+    size_t index;
+    while ((index = next.fetch_add(1)) < settings.size()) {
+        ChainSpec spec = applySetting(config, settings[index]);
+        std::string error;
+
+        Clock::time_point begin = Clock::now();
+        bool ok = true, built = false;
+        for (unsigned int c = 0; c < channels && ok; c++) {
+            if (config.fresh || !chains[c]) {
+                chains[c] = Chain::build(spec, sampleRate, error);
+                ok = chains[c] != nullptr;
+                built = true;
+            } else {
+                ok = chains[c]->configure(spec, error);
+                chains[c]->reset();
+            }
+        }
+        Clock::time_point configured = Clock::now();
+        unsigned long long setupNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(configured - begin).count();
+        (built ? totals.setupNanos : totals.configureNanos) += setupNanos;
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "Setting " << index << ": " << error << std::endl;
+            totals.failures++;
+            continue;
+        }
+
+        for (unsigned int c = 0; c < channels; c++) {
+            std::copy(input[c].begin(), input[c].end(), work[c].begin());
+            std::fill(work[c].begin() + input[c].size(), work[c].end(), 0.f);
+            for (size_t offset = 0; offset < frames; offset += config.blockSize) {
+                chains[c]->processBlock(work[c].data() + offset, std::min(config.blockSize, frames - offset));
+            }
+            planar[c] = work[c].data();
+        }
+        Clock::time_point processed = Clock::now();
+        totals.processNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(processed - configured).count();
+
+        WAVBlockWriter writer { settingPath(config, index).c_str(), sampleRate, channels, config.format, config.dither, config.blockSize * 8 };
+        if (!writer.isOpen()) {
+            totals.failures++;
+            continue;
+        }
+        writer.writePlanar(planar.data(), frames);
+    }
+}
+
+static bool writeManifest(const SweepConfig& config, const SweepSettings& settings, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "Could not write " << path << std::endl;
+        return false;
+    }
+    out << "index,file";
+    for (const SweepAxis& axis : config.axes) { out << "," << axis.name; }
+    out << ",chain\n";
+    for (size_t s = 0; s < settings.size(); s++) {
+        std::string file = settingPath(config, s);
+        out << s << "," << file.substr(file.find_last_of('/') + 1);
+        for (const std::string& value : settings[s]) { out << "," << value; }
+        out << ",\"" << applySetting(config, settings[s]).toString() << "\"\n";
+    }
+    return true;
+}
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " --chain <description|file> --input clip.wav [options]\n"
+              << "  --grid stage.key=min:max:steps   sweep a parameter linearly (repeat for a grid)\n"
+              << "  --grid stage.key=a,b,c           sweep a parameter over a list of values\n"
+              << "  --random N         draw N settings uniformly from the axes instead of the full grid\n"
+              << "  --seed S           random seed (default: 1)\n"
+              << "  --tail SECONDS     silence appended to the input (default: 0)\n"
+              << "  --out-dir DIR      output directory (default: .)\n"
+              << "  --manifest FILE    parameter manifest (default: DIR/manifest.csv)\n"
+              << "  --threads N        worker threads (default: number of cores)\n"
+              << "  --block N          samples per processBlock call (default: 512)\n"
+              << "  --format F         int16 | int24 | int32 | float (default: int24)\n"
+              << "  --dither           TPDF dither for integer formats\n"
+              << "  --fresh            build new chains for every setting instead of reusing them\n"
+              << "stage is an effect type (its first occurrence) or a 0-based position in the chain.\n"
+              << "Example: --chain \"delay | reverb\" --grid delay.feedback=0.1:0.7:4 --grid reverb.shape=cube,sphere" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    SweepConfig config;
+    std::vector<std::string> axisArgs;
+    bool hasChain = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--chain") && i + 1 < argc) {
+            std::string error;
+            if (!config.chain.parse(argv[++i], error)) {
+                std::cout << "Invalid chain: " << error << std::endl;
+                return 1;
+            }
+            hasChain = true;
+        }
+        else if (!strcmp(argv[i], "--input") && i + 1 < argc) { config.input = argv[++i]; }
+        else if (!strcmp(argv[i], "--grid") && i + 1 < argc) { axisArgs.push_back(argv[++i]); }
+        else if (!strcmp(argv[i], "--random") && i + 1 < argc) { config.randomCount = (size_t)atoll(argv[++i]); }
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) { config.seed = strtoull(argv[++i], nullptr, 10); }
+        else if (!strcmp(argv[i], "--tail") && i + 1 < argc) { config.tailSeconds = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--out-dir") && i + 1 < argc) { config.outDir = argv[++i]; }
+        else if (!strcmp(argv[i], "--manifest") && i + 1 < argc) { config.manifest = argv[++i]; }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) { config.threads = (unsigned int)atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--block") && i + 1 < argc) { config.blockSize = (size_t)atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+            std::string f = argv[++i];
+            if (f == "int16") { config.format = WAVBlockWriter::Format::INT16; }
+            else if (f == "int24") { config.format = WAVBlockWriter::Format::INT24; }
+            else if (f == "int32") { config.format = WAVBlockWriter::Format::INT32; }
+            else if (f == "float") { config.format = WAVBlockWriter::Format::FLOAT32; }
+            else { printUsage(argv[0]); return 1; }
+        }
+        else if (!strcmp(argv[i], "--dither")) { config.dither = true; }
+        else if (!strcmp(argv[i], "--fresh")) { config.fresh = true; }
+        else { printUsage(argv[0]); return 1; }
+    }
+    if (!hasChain || config.input.empty() || config.blockSize == 0 || config.tailSeconds < 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    for (const std::string& text : axisArgs) {
+        SweepAxis axis;
+        std::string error;
+        if (!axis.parse(text, config.chain, error)) {
+            std::cout << "Invalid sweep: " << error << std::endl;
+            return 1;
+        }
+        config.axes.push_back(axis);
+    }
+    if (config.manifest.empty()) { config.manifest = config.outDir + "/manifest.csv"; }
+
+    std::vector<std::vector<float>> input;
+    int sampleRate = 0;
+    if (!loadInput(config.input, config.blockSize, input, sampleRate) || input.empty() || input[0].empty()) {
+        std::cout << "Could not read " << config.input << std::endl;
+        return 1;
+    }
+
+    SweepSettings settings = makeSettings(config);
+    // Validate every setting up front rather than failing halfway through the sweep,
+    // configuring a single chain is cheap compared to building one per setting
+    {
+        std::string error;
+        std::unique_ptr<Chain> probe = Chain::build(config.chain, sampleRate, error);
+        for (size_t s = 0; probe && s < settings.size(); s++) {
+            if (!probe->configure(applySetting(config, settings[s]), error)) { probe.reset(); }
+        }
+        if (!probe) {
+            std::cout << "Invalid sweep: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    unsigned int numThreads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    if (numThreads == 0) { numThreads = 1; }
+    if (numThreads > settings.size()) { numThreads = (unsigned int)settings.size(); }
+    double clipSeconds = (double)input[0].size() / sampleRate + config.tailSeconds;
+
+    std::cout << "Chain: " << config.chain.toString() << std::endl;
+    std::cout << "Input: " << config.input << " (" << input.size() << " ch, " << clipSeconds << " s rendered)" << std::endl;
+    std::cout << "Settings: " << settings.size() << (config.randomCount ? " (random)" : " (grid)")
+              << ", threads: " << numThreads << ", chains: " << (config.fresh ? "fresh per setting" : "reused") << std::endl;
+
+    SweepTotals totals;
+    std::atomic<size_t> next{0};
+    Clock::time_point begin = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back(sweepWorker, std::cref(config), std::cref(settings), std::cref(input),
+                             sampleRate, std::ref(next), std::ref(totals));
+    }
+    for (std::thread& w : workers) { w.join(); }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    if (!writeManifest(config, settings, config.manifest)) { return 1; }
+
+    size_t rendered = settings.size() - totals.failures;
+    std::cout << "\n=== SUMMARY ===" << std::endl;
+    std::cout << "Rendered: " << rendered << "/" << settings.size() << " settings in "
+              << std::fixed << std::setprecision(2) << wallSeconds << " s ("
+              << (wallSeconds > 0.0 ? rendered / wallSeconds : 0.0) << " settings/s)" << std::endl;
+    std::cout << "Chain setup: " << totals.setupNanos * 1e-6 << " ms, configure + reset: " << totals.configureNanos * 1e-6
+              << " ms, processing: " << totals.processNanos * 1e-6 << " ms (summed over threads)" << std::endl;
+    std::cout << "Manifest: " << config.manifest << std::defaultfloat << std::endl;
+    return totals.failures > 0 ? 1 : 0;
+}
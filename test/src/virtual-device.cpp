@@ -0,0 +1,253 @@
+// Virtual audio device: drives an EffectsLine from a periodic "audio callback"
+// with a real deadline, so xrun behaviour can be tested without a sound card
+
+#include "report.h"
+
+// Include all gimmel effects
+#include "../include/gimmel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// Device configuration, see `--help`
+struct DeviceConfig {
+    int sampleRate = 48000;
+    int periodSize = 32; // samples per callback
+    int blockSize = 0; // samples per `processBlock()` call inside a callback, 0 = whole period
+    double seconds = 5.0;
+    int loadThreads = 0; // background threads streaming through memory
+    bool realtime = true; // try SCHED_FIFO
+    long long maxMisses = -1; // fail if exceeded, -1 = never fail
+    const char* reportPath = nullptr;
+};
+
+// Callback statistics. Completion is measured from the scheduled wake-up time,
+// so it includes the scheduler's wake-up latency, which is what an audio driver sees
+struct DeviceStats {
+    static constexpr int NUM_BINS = 11; // 10% of the period each, last bin is > 100% (deadline miss)
+    long long callbacks = 0;
+    long long misses = 0;
+    long long skippedPeriods = 0; // periods dropped to resync after a miss
+    long long worstProcessNanos = 0;
+    long long worstCompletionNanos = 0;
+    long long totalProcessNanos = 0;
+    long long histogram[NUM_BINS] = {};
+};
+
+// Background load: each thread repeatedly streams through a buffer larger than most LLCs
+static void backgroundLoad(std::atomic<bool>& running) {
+    const size_t numFloats = 16 * 1024 * 1024; // 64 MB
+    std::vector<float> buffer(numFloats, 1.0f);
+    float acc = 0.0f;
+    while (running.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < numFloats; i += 16) { // one access per cache line
+            buffer[i] += acc;
+            acc = buffer[i] * 0.5f;
+        }
+    }
+    volatile float sink = acc;
+    (void)sink;
+}
+
+static bool makeRealtime() {
+#ifdef __linux__
+    // Avoid page faults on the audio thread
+    mlockall(MCL_CURRENT | MCL_FUTURE);
+    sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    return false;
+#endif
+}
+
+static void sleepUntil(Clock::time_point t) {
+#ifdef __linux__
+    // steady_clock is CLOCK_MONOTONIC on Linux
+    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000LL);
+    ts.tv_nsec = (long)(ns % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {} // retry on EINTR only, other errors return
+#else
+    std::this_thread::sleep_until(t);
+#endif
+}
+
+/**
+ * The "audio thread": wakes up once per period, processes one period of input through `chain`
+ * and records the time taken against the period's deadline.
+ * Like a real driver, a late callback drops the periods it overran and resyncs
+ */
+static void runDevice(giml::EffectsLine<float>& chain, const DeviceConfig& config,
+                      const std::vector<float>& input, DeviceStats& stats, bool& isRealtime) {
+    isRealtime = config.realtime && makeRealtime();
+
+    const long long periodNanos = 1000000000LL * config.periodSize / config.sampleRate;
+    const long long numPeriods = (long long)(config.seconds * config.sampleRate / config.periodSize);
+    const int blockSize = (config.blockSize > 0 && config.blockSize < config.periodSize) ? config.blockSize : config.periodSize;
+    std::vector<float> period(config.periodSize);
+    size_t readIndex = 0;
+
+    Clock::time_point wake = Clock::now() + std::chrono::milliseconds(10);
+    for (long long p = 0; p < numPeriods; p++) {
+        sleepUntil(wake);
+        Clock::time_point start = Clock::now();
+
+        // "Driver" copies the input period in, the callback processes it in blocks
+        for (int i = 0; i < config.periodSize; i++) {
+            period[i] = input[readIndex];
+            readIndex = (readIndex + 1 < input.size()) ? readIndex + 1 : 0;
+        }
+        for (int offset = 0; offset < config.periodSize; offset += blockSize) {
+            int n = (config.periodSize - offset < blockSize) ? config.periodSize - offset : blockSize;
+            chain.processBlock(period.data() + offset, n);
+        }
+
+        Clock::time_point end = Clock::now();
+        long long processNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        long long completionNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(end - wake).count();
+
+        stats.callbacks++;
+        stats.totalProcessNanos += processNanos;
+        if (processNanos > stats.worstProcessNanos) { stats.worstProcessNanos = processNanos; }
+        if (completionNanos > stats.worstCompletionNanos) { stats.worstCompletionNanos = completionNanos; }
+        int bin = (int)(completionNanos * 10 / periodNanos);
+        stats.histogram[(bin < DeviceStats::NUM_BINS - 1) ? bin : DeviceStats::NUM_BINS - 1]++;
+
+        wake += std::chrono::nanoseconds(periodNanos);
+        if (completionNanos > periodNanos) {
+            stats.misses++;
+            // xrun: skip the periods we are already late for
+            while (wake < end) {
+                wake += std::chrono::nanoseconds(periodNanos);
+                stats.skippedPeriods++;
+                p++;
+            }
+        }
+    }
+}
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--rate 48000] [--period 32] [--block 0] [--seconds 5]"
+              << " [--load 0] [--no-rt] [--max-misses -1] [--report out.jsonl]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    DeviceConfig config;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc) { config.sampleRate = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--period") && i + 1 < argc) { config.periodSize = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--block") && i + 1 < argc) { config.blockSize = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) { config.seconds = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--load") && i + 1 < argc) { config.loadThreads = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--no-rt")) { config.realtime = false; }
+        else if (!strcmp(argv[i], "--max-misses") && i + 1 < argc) { config.maxMisses = atoll(argv[++i]); }
+        else if (!strcmp(argv[i], "--report") && i + 1 < argc) { config.reportPath = argv[++i]; }
+        else { printUsage(argv[0]); return 1; }
+    }
+    if (config.sampleRate <= 0 || config.periodSize <= 0 || config.seconds <= 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // A typical guitar chain, all allocations happen here, before the device starts
+    giml::Compressor<float> compressor(config.sampleRate);
+    compressor.setParams(-20.0f, 4.0f, 0.0f, 2.5f, 25.0f);
+    giml::Saturation<float> saturation(config.sampleRate);
+    giml::Chorus<float> chorus(config.sampleRate);
+    chorus.setParams(0.2f, 6.0f, 0.5f);
+    giml::Delay<float> delay(config.sampleRate);
+    delay.setParams(398.0f, 0.3f, 0.5f, 0.5f);
+    giml::Reverb<float> reverb(config.sampleRate, 4, 20, 4, 2);
+    reverb.setParams(0.030f, 0.6f, 0.75f, 0.5f, 1000.f, 0.75f, giml::Reverb<float>::RoomType::CUBE);
+
+    giml::EffectsLine<float> chain;
+    giml::Effect<float>* effects[] = { &compressor, &saturation, &chorus, &delay, &reverb };
+    for (giml::Effect<float>* e : effects) {
+        e->enable();
+        chain.pushBack(e);
+    }
+
+    // One second of a 220 Hz tone as the "input device"
+    std::vector<float> input(config.sampleRate);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = 0.5f * std::sin(2.0f * (float)M_PI * 220.0f * i / config.sampleRate);
+    }
+
+    const long long periodNanos = 1000000000LL * config.periodSize / config.sampleRate;
+    std::cout << "GIMMEL VIRTUAL AUDIO DEVICE" << std::endl;
+    std::cout << "===========================" << std::endl;
+    std::cout << "Sample Rate: " << config.sampleRate << " Hz" << std::endl;
+    std::cout << "Period: " << config.periodSize << " samples (" << periodNanos << " ns deadline)" << std::endl;
+    std::cout << "Block: " << ((config.blockSize > 0 && config.blockSize < config.periodSize) ? config.blockSize : config.periodSize) << " samples" << std::endl;
+    std::cout << "Duration: " << config.seconds << " s" << std::endl;
+    std::cout << "Background Load: " << config.loadThreads << " thread(s)" << std::endl;
+
+    std::atomic<bool> loadRunning{true};
+    std::vector<std::thread> loadThreads;
+    for (int i = 0; i < config.loadThreads; i++) {
+        loadThreads.emplace_back(backgroundLoad, std::ref(loadRunning));
+    }
+
+    DeviceStats stats;
+    bool isRealtime = false;
+    std::thread device(runDevice, std::ref(chain), std::cref(config), std::cref(input), std::ref(stats), std::ref(isRealtime));
+    device.join();
+
+    loadRunning = false;
+    for (std::thread& t : loadThreads) { t.join(); }
+
+    std::cout << "Scheduling: " << (isRealtime ? "SCHED_FIFO" : "normal (SCHED_FIFO not permitted)") << std::endl;
+    std::cout << "\n=== RESULTS ===" << std::endl;
+    std::cout << std::setw(24) << "Callbacks: " << stats.callbacks << std::endl;
+    std::cout << std::setw(24) << "Deadline misses: " << stats.misses
+              << " (" << stats.skippedPeriods << " periods dropped)" << std::endl;
+    std::cout << std::setw(24) << "Average process: " << (stats.callbacks ? stats.totalProcessNanos / stats.callbacks : 0) << " ns" << std::endl;
+    std::cout << std::setw(24) << "Worst process: " << stats.worstProcessNanos << " ns" << std::endl;
+    std::cout << std::setw(24) << "Worst completion: " << stats.worstCompletionNanos << " ns ("
+              << std::fixed << std::setprecision(1) << 100.0 * stats.worstCompletionNanos / periodNanos
+              << "% of period)" << std::defaultfloat << std::endl;
+
+    std::cout << "\nCompletion time histogram (% of period):" << std::endl;
+    for (int b = 0; b < DeviceStats::NUM_BINS; b++) {
+        if (b < DeviceStats::NUM_BINS - 1) {
+            std::cout << std::setw(5) << b * 10 << "-" << std::setw(3) << (b + 1) * 10 << "%: ";
+        } else {
+            std::cout << std::setw(12) << ">100%: ";
+        }
+        std::cout << std::setw(10) << stats.histogram[b] << std::endl;
+    }
+
+    if (config.reportPath) {
+        BenchmarkReport report;
+        report.add("VirtualDevice", "averageProcess", stats.callbacks ? (double)stats.totalProcessNanos / stats.callbacks : 0.0, "ns");
+        report.add("VirtualDevice", "worstProcess", (double)stats.worstProcessNanos, "ns");
+        report.add("VirtualDevice", "worstCompletion", (double)stats.worstCompletionNanos, "ns");
+        report.add("VirtualDevice", "deadlineMisses", (double)stats.misses, "events");
+        if (!report.write(config.reportPath)) { return 1; }
+    }
+
+    if (config.maxMisses >= 0 && stats.misses > config.maxMisses) {
+        std::cout << "FAILED: " << stats.misses << " deadline misses, at most " << config.maxMisses << " allowed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -7,6 +7,22 @@
 
 #include <iostream>
 #include <stdlib.h> //For malloc
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAV_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAV_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /* Opens WAV files in signed 32-bit format*/
 class WAVLoader {
@@ -41,7 +57,7 @@ private:
         if (!drwav_init_file(&wav, filename)) {
             // Error opening WAV file.
             std::cout << "Could not open WAV file for reading: " << filename << std::endl;
-            exit(0);
+            return; // readSample() will report end of file
         }
         this->sampleRate = wav.sampleRate;
         int32_t* pDecodedInterleavedSamples = (int32_t*)malloc(wav.totalPCMFrameCount * wav.channels * sizeof(int32_t));
@@ -60,18 +76,153 @@ private:
     }
 };
 
+/* Streams a WAV file of any length in fixed-size chunks.
+   Each chunk is decoded (PCM 16/24/32-bit int or 32-bit float, any channel count)
+   into a reusable planar float buffer, ready for block processing:
+
+       WAVStreamReader reader { "in.wav", 512 };
+       while (size_t frames = reader.readChunk()) {
+           for (unsigned int c = 0; c < reader.getChannels(); c++) {
+               effect.processBlock(reader.getChannel(c), frames);
+           }
+       }
+
+   On POSIX systems the file is `mmap`'d so decoding reads straight from the page cache,
+   otherwise it is read through stdio. Memory use only depends on the chunk size */
+class WAVStreamReader {
+public:
+    /**
+     * @param filename path of the WAV file
+     * @param chunkFrames number of frames decoded per `readChunk()`
+     * @param useMmap map the file into memory when the platform allows it
+     */
+    WAVStreamReader(const char* filename, size_t chunkFrames = 4096, bool useMmap = true) : chunkFrames(chunkFrames) {
+        if (chunkFrames == 0 || !this->open(filename, useMmap)) {
+            std::cout << "Could not open WAV file for reading: " << filename << std::endl;
+            this->close();
+            return;
+        }
+        this->interleaved = (float*)malloc(chunkFrames * wav.channels * sizeof(float));
+        this->planar = (float*)malloc(chunkFrames * wav.channels * sizeof(float));
+        if (!this->interleaved || !this->planar) {
+            std::cout << "Could not allocate WAV chunk buffers for: " << filename << std::endl;
+            this->close();
+        }
+    }
+    ~WAVStreamReader() { this->close(); }
+    WAVStreamReader(const WAVStreamReader&) = delete;
+    WAVStreamReader& operator=(const WAVStreamReader&) = delete;
+
+    // false if the file could not be opened, every other call is then a no-op
+    bool isOpen() const { return this->opened; }
+    bool isMapped() const { return this->mapped != nullptr; }
+
+    unsigned int getChannels() const { return this->opened ? wav.channels : 0; }
+    unsigned int getSampleRate() const { return this->opened ? wav.sampleRate : 0; }
+    uint64_t getTotalFrames() const { return this->opened ? wav.totalPCMFrameCount : 0; }
+    uint64_t getPosition() const { return this->position; }
+    size_t getChunkFrames() const { return this->chunkFrames; }
+
+    /**
+     * @brief Decodes the next chunk into the planar buffer
+     * @return number of frames decoded, 0 at the end of the file
+     */
+    size_t readChunk() {
+        if (!this->opened) { return 0; }
+        size_t frames = (size_t)drwav_read_pcm_frames_f32(&wav, this->chunkFrames, this->interleaved);
+        unsigned int channels = wav.channels;
+        if (channels == 1) {
+            for (size_t i = 0; i < frames; i++) { this->planar[i] = this->interleaved[i]; }
+        } else {
+            for (unsigned int c = 0; c < channels; c++) {
+                float* pOut = this->planar + c * this->chunkFrames;
+                const float* pIn = this->interleaved + c;
+                for (size_t i = 0; i < frames; i++) { pOut[i] = pIn[i * channels]; }
+            }
+        }
+        this->position += frames;
+        return frames;
+    }
+
+    /**
+     * @brief Samples of one channel from the last `readChunk()`. Writable, so effects can process in place
+     * @param channel channel index, `< getChannels()`
+     */
+    float* getChannel(unsigned int channel) { return this->planar + channel * this->chunkFrames; }
+    const float* getChannel(unsigned int channel) const { return this->planar + channel * this->chunkFrames; }
+
+    /**
+     * @brief Moves the read position
+     * @param frame frame index from the start of the file
+     * @return false if the position is out of range or the file is not open
+     */
+    bool seek(uint64_t frame) {
+        if (!this->opened || !drwav_seek_to_pcm_frame(&wav, frame)) { return false; }
+        this->position = frame;
+        return true;
+    }
+
+    bool rewind() { return this->seek(0); }
+
+private:
+    drwav wav;
+    bool opened = false;
+    size_t chunkFrames = 0;
+    uint64_t position = 0;
+    float* interleaved = nullptr; // decoder output
+    float* planar = nullptr; // `chunkFrames` samples per channel, channel after channel
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+
+    bool open(const char* filename, bool useMmap) {
+#ifdef WAV_HAS_MMAP
+        if (useMmap) {
+            int fd = ::open(filename, O_RDONLY);
+            if (fd >= 0) {
+                struct stat st;
+                if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p != MAP_FAILED) {
+                        madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+                        this->mapped = p;
+                        this->mappedSize = (size_t)st.st_size;
+                    }
+                }
+                ::close(fd); // the mapping stays valid
+            }
+            if (this->mapped) {
+                this->opened = drwav_init_memory(&wav, this->mapped, this->mappedSize);
+                if (this->opened) { return true; }
+                munmap(this->mapped, this->mappedSize);
+                this->mapped = nullptr;
+            }
+        }
+#else
+        (void)useMmap;
+#endif
+        this->opened = drwav_init_file(&wav, filename);
+        return this->opened;
+    }
+
+    void close() {
+        if (this->opened) { drwav_uninit(&wav); }
+        this->opened = false;
+#ifdef WAV_HAS_MMAP
+        if (this->mapped) { munmap(this->mapped, this->mappedSize); }
+#endif
+        this->mapped = nullptr;
+        free(this->interleaved);
+        free(this->planar);
+        this->interleaved = nullptr;
+        this->planar = nullptr;
+    }
+};
+
 class WAVWriter {
 private:
     drwav* pWAV = nullptr;
 public:
     WAVWriter(const char* filename, int sampleRate = 48000) {
-
-        //if (!drwav_init_file(pWAV, filename, NULL)) {
-        //    // Error opening WAV file.
-        //    std::cout << "Could not open WAV file for reading: " << filename << std::endl;
-        //    exit(0);
-        //}
-
         pWAV = (drwav*)malloc(sizeof(drwav));
         drwav_data_format wavFormat;
 
@@ -81,24 +232,239 @@ public:
         wavFormat.format = DR_WAVE_FORMAT_PCM;
         wavFormat.sampleRate = sampleRate;
 
-        drwav_init_file_write(pWAV, filename, &wavFormat);
-        if (!pWAV) {
+        if (!pWAV || !drwav_init_file_write(pWAV, filename, &wavFormat)) {
             //Could not open the file
             std::cout << "Could not open WAV file for writing: " << filename << std::endl;
-            exit(0);
+            free(pWAV);
+            pWAV = nullptr;
         }
     }
     ~WAVWriter() {
         if (pWAV) {
             drwav_uninit(pWAV);
+            free(pWAV);
         }
     }
+    bool isOpen() const { return pWAV != nullptr; }
     void writeSample(float f) {
-        int32_t* pConvertedOut = new int32_t;
-        *pConvertedOut = static_cast<int32_t>(f * 2147483647.f); //Convert the float to a int32 for WAV format
-        drwav_write_pcm_frames(pWAV, 1, pConvertedOut);
-        delete pConvertedOut;
+        if (!pWAV) { return; }
+        // Clip first, out-of-range floats would overflow the int32 cast
+        double clipped = (f > 1.f) ? 1.0 : (f < -1.f) ? -1.0 : f;
+        int32_t converted = static_cast<int32_t>(clipped * 2147483647.0); //Convert the float to a int32 for WAV format
+        drwav_write_pcm_frames(pWAV, 1, &converted);
     }
 
 };
-#endif
\ No newline at end of file
+
+/* Buffered block WAV writer.
+   Planar or interleaved float blocks are converted into a reusable PCM buffer
+   (16/24/32-bit int or 32-bit float, any channel count) and written in large chunks.
+   Integer formats are saturated (SSE2 when available, scalar otherwise)
+   with optional TPDF dither:
+
+       WAVBlockWriter writer { "out.wav", 48000, 2, WAVBlockWriter::Format::INT24, true };
+       writer.writePlanar(channels, numFrames);
+*/
+class WAVBlockWriter {
+public:
+    enum class Format { INT16, INT24, INT32, FLOAT32 };
+
+    /**
+     * @param filename output path
+     * @param sampleRate sample rate in Hz
+     * @param channels channel count
+     * @param format output sample format
+     * @param dither add TPDF dither (±1 LSB) before quantizing, ignored for `FLOAT32`
+     * @param chunkFrames number of frames buffered before each write to disk
+     */
+    WAVBlockWriter(const char* filename, int sampleRate = 48000, unsigned int channels = 1,
+                   Format format = Format::INT24, bool dither = false, size_t chunkFrames = 4096) :
+        channels(channels), format(format), dither(dither && format != Format::FLOAT32), chunkFrames(chunkFrames) {
+        drwav_data_format wavFormat;
+        wavFormat.container = drwav_container_riff;
+        wavFormat.format = (format == Format::FLOAT32) ? DR_WAVE_FORMAT_IEEE_FLOAT : DR_WAVE_FORMAT_PCM;
+        wavFormat.channels = channels;
+        wavFormat.sampleRate = sampleRate;
+        wavFormat.bitsPerSample = bytesPerSample(format) * 8;
+
+        this->samples = (float*)malloc(chunkFrames * channels * sizeof(float));
+        this->pcm = (unsigned char*)malloc(chunkFrames * channels * sizeof(int32_t));
+        if (channels == 0 || chunkFrames == 0 || !this->samples || !this->pcm ||
+            !drwav_init_file_write(&wav, filename, &wavFormat)) {
+            std::cout << "Could not open WAV file for writing: " << filename << std::endl;
+            free(this->samples);
+            free(this->pcm);
+            this->samples = nullptr;
+            this->pcm = nullptr;
+            return;
+        }
+        this->opened = true;
+    }
+    ~WAVBlockWriter() {
+        if (this->opened) {
+            this->flush();
+            drwav_uninit(&wav);
+        }
+        free(this->samples);
+        free(this->pcm);
+    }
+    WAVBlockWriter(const WAVBlockWriter&) = delete;
+    WAVBlockWriter& operator=(const WAVBlockWriter&) = delete;
+
+    // false if the file could not be opened, every write is then a no-op
+    bool isOpen() const { return this->opened; }
+
+    /**
+     * @brief Writes interleaved frames
+     * @param in `numFrames * channels` samples, frame after frame
+     * @param numFrames number of frames
+     */
+    void writeInterleaved(const float* in, size_t numFrames) {
+        if (!this->opened) { return; }
+        while (numFrames > 0) {
+            size_t n = this->reserve(numFrames);
+            float* pOut = this->samples + this->bufferedFrames * this->channels;
+            for (size_t i = 0; i < n * this->channels; i++) { pOut[i] = in[i]; }
+            this->bufferedFrames += n;
+            in += n * this->channels;
+            numFrames -= n;
+        }
+    }
+
+    /**
+     * @brief Writes planar frames
+     * @param in one pointer per channel, each to `numFrames` samples
+     * @param numFrames number of frames
+     */
+    void writePlanar(const float* const* in, size_t numFrames) {
+        if (!this->opened) { return; }
+        size_t offset = 0;
+        while (numFrames > 0) {
+            size_t n = this->reserve(numFrames);
+            float* pOut = this->samples + this->bufferedFrames * this->channels;
+            for (unsigned int c = 0; c < this->channels; c++) {
+                const float* pIn = in[c] + offset;
+                for (size_t i = 0; i < n; i++) { pOut[i * this->channels + c] = pIn[i]; }
+            }
+            this->bufferedFrames += n;
+            offset += n;
+            numFrames -= n;
+        }
+    }
+
+    /**
+     * @brief Writes a block of a mono file (or the same block to every channel)
+     */
+    void writeMono(const float* in, size_t numFrames) {
+        if (!this->opened) { return; }
+        while (numFrames > 0) {
+            size_t n = this->reserve(numFrames);
+            float* pOut = this->samples + this->bufferedFrames * this->channels;
+            for (size_t i = 0; i < n; i++) {
+                for (unsigned int c = 0; c < this->channels; c++) { pOut[i * this->channels + c] = in[i]; }
+            }
+            this->bufferedFrames += n;
+            in += n;
+            numFrames -= n;
+        }
+    }
+
+    /**
+     * @brief Converts and writes every buffered frame to disk
+     */
+    void flush() {
+        if (!this->opened || this->bufferedFrames == 0) { return; }
+        size_t count = this->bufferedFrames * this->channels;
+        switch (this->format) {
+            case Format::INT16: this->convert<int16_t>(count, 32767.f, -32768.f, 32767.f); break;
+            case Format::INT24: this->convert<int32_t>(count, 8388607.f, -8388608.f, 8388607.f); break;
+            case Format::INT32: this->convert<int32_t>(count, 2147483647.f, -2147483648.f, 2147483520.f); break; // largest float < 2^31
+            case Format::FLOAT32: memcpy(this->pcm, this->samples, count * sizeof(float)); break;
+        }
+        if (this->format == Format::INT24) { this->packInt24(count); }
+        drwav_write_pcm_frames(&wav, this->bufferedFrames, this->pcm);
+        this->bufferedFrames = 0;
+    }
+
+private:
+    drwav wav;
+    bool opened = false;
+    unsigned int channels = 1;
+    Format format = Format::INT24;
+    bool dither = false;
+    size_t chunkFrames = 0;
+    size_t bufferedFrames = 0;
+    float* samples = nullptr; // interleaved float staging buffer
+    unsigned char* pcm = nullptr; // converted output
+    uint32_t ditherState = 0x9E3779B9u;
+
+    static unsigned int bytesPerSample(Format f) {
+        switch (f) {
+            case Format::INT16: return 2;
+            case Format::INT24: return 3;
+            default: return 4;
+        }
+    }
+
+    // Flushes if needed, returns how many of `numFrames` fit in the staging buffer
+    size_t reserve(size_t numFrames) {
+        if (this->bufferedFrames == this->chunkFrames) { this->flush(); }
+        size_t space = this->chunkFrames - this->bufferedFrames;
+        return (numFrames < space) ? numFrames : space;
+    }
+
+    // Uniform in [-0.5, 0.5) LSB, two of them summed give triangular (TPDF) dither
+    float nextUniform() {
+        this->ditherState ^= this->ditherState << 13;
+        this->ditherState ^= this->ditherState >> 17;
+        this->ditherState ^= this->ditherState << 5;
+        return (this->ditherState >> 8) * (1.f / 16777216.f) - 0.5f;
+    }
+
+    /**
+     * Scales, dithers, saturates to [`lo`, `hi`] and rounds `count` samples into `pcm`.
+     * The dither is added in place to the staging buffer so that the SIMD pass stays branch-free
+     */
+    template <typename IntType>
+    void convert(size_t count, float scale, float lo, float hi) {
+        float* pIn = this->samples;
+        IntType* pOut = (IntType*)this->pcm;
+        if (this->dither) {
+            const float lsb = 1.f / scale;
+            for (size_t i = 0; i < count; i++) { pIn[i] += (this->nextUniform() + this->nextUniform()) * lsb; }
+        }
+        size_t i = 0;
+#ifdef WAV_HAS_SSE2
+        const __m128 vScale = _mm_set1_ps(scale), vLo = _mm_set1_ps(lo), vHi = _mm_set1_ps(hi);
+        for (; i + 8 <= count; i += 8) {
+            __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + i), vScale), vLo), vHi);
+            __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + i + 4), vScale), vLo), vHi);
+            __m128i ia = _mm_cvtps_epi32(a), ib = _mm_cvtps_epi32(b); // round to nearest
+            if (sizeof(IntType) == 2) {
+                _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(ia, ib));
+            } else {
+                _mm_storeu_si128((__m128i*)(pOut + i), ia);
+                _mm_storeu_si128((__m128i*)(pOut + i + 4), ib);
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            float x = pIn[i] * scale;
+            x = (x < lo) ? lo : (x > hi) ? hi : x;
+            pOut[i] = (IntType)lrintf(x);
+        }
+    }
+
+    // Packs the int32 samples in `pcm` to 3 little-endian bytes each, in place
+    void packInt24(size_t count) {
+        const int32_t* pIn = (const int32_t*)this->pcm;
+        unsigned char* pOut = this->pcm;
+        for (size_t i = 0; i < count; i++) {
+            int32_t v = pIn[i]; // read before the write below can overlap it
+            pOut[3 * i] = (unsigned char)v;
+            pOut[3 * i + 1] = (unsigned char)(v >> 8);
+            pOut[3 * i + 2] = (unsigned char)(v >> 16);
+        }
+    }
+};
+#endif